@@ -0,0 +1,70 @@
+#include <getopt.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "dsa/arch/model.h"
+
+using namespace std;
+using namespace dsa;
+
+// clang-format off
+static struct option long_options[] = {
+    {"bench", required_argument, nullptr, 'b',},
+    {0, 0, 0, 0,},
+};
+// clang-format on
+
+// Convert a hardware description among the formats: .sbmodel/.json/.adg.bin in, and
+// .json/.adg.bin out.
+int main(int argc, char* argv[]) {
+  int opt;
+  int bench = 0;
+
+  while ((opt = getopt_long(argc, argv, "b:", long_options, nullptr)) != -1) {
+    switch (opt) {
+      case 'b': bench = atoi(optarg); break;
+      default: exit(1);
+    }
+  }
+
+  argc -= optind;
+  argv += optind;
+
+  if (argc != 2 && !(argc == 1 && bench)) {
+    cerr << "Usage: ss_adg [--bench N] input.{sbmodel,json,adg.bin} [output.{json,adg.bin}]\n";
+    exit(1);
+  }
+
+  // Report the average time of loading the input, to compare the formats.
+  if (bench) {
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < bench; ++i) {
+      SSModel model(argv[0]);
+    }
+    auto elapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start);
+    cout << "Load " << argv[0] << ": " << elapsed.count() / bench << "ms\n";
+    if (argc == 1) return 0;
+  }
+
+  SSModel model(argv[0]);
+  CHECK(model.subModel()) << "Failed to load " << argv[0];
+  model.subModel()->compact();
+
+  auto ends_with = [](const string& s, const string& suffix) {
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+  };
+  string output(argv[1]);
+  if (ends_with(output, ".adg.bin")) {
+    model.subModel()->DumpHwInBinary(argv[1], model.fu_types);
+  } else if (ends_with(output, ".json")) {
+    model.subModel()->DumpHwInJson(argv[1]);
+  } else {
+    cerr << "Unknown output format: " << argv[1] << "\n";
+    exit(1);
+  }
+
+  return 0;
+}
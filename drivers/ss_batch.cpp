@@ -0,0 +1,340 @@
+#include <fcntl.h>
+#include <getopt.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dsa/arch/model.h"
+#include "dsa/dfg/ssdfg.h"
+#include "dsa/mapper/scheduler_sa.h"
+
+using namespace std;
+using namespace dsa;
+
+// clang-format off
+static struct option long_options[] = {
+    {"verbose",        no_argument,       nullptr, 'v',},
+    {"compact-json",   no_argument,       nullptr, 'j',},
+    {"jobs",           required_argument, nullptr, 'n',},
+    {"timeout",        required_argument, nullptr, 't',},
+    {"max-iters",      required_argument, nullptr, 'i',},
+    {"max-edge-delay", required_argument, nullptr, 'd',},
+    {"seed",           required_argument, nullptr, 'e',},
+    {"decomposer",     required_argument, nullptr, 'r',},
+    {"indir-mem",      required_argument, nullptr, 'c',},
+    {"artifacts",      required_argument, nullptr, 'A',},
+    {"summary",        required_argument, nullptr, 's',},
+    {"cache-dir",      required_argument, nullptr, 'C',},
+    {"cache-size",     required_argument, nullptr, 'Z',},
+    {0, 0, 0, 0,},
+};
+// clang-format on
+
+namespace {
+
+/*! \brief A line of the manifest, and the result of scheduling it. */
+struct Job {
+  std::string model, dfg;
+  float timeout;
+  /*! \brief The line in the manifest. */
+  int line;
+  /*! \brief Where the outputs of the job go. */
+  std::string out_dir;
+  /*! \brief The random numbers of the job, forked from the seed in the order of the manifest,
+   *         so that the results do not depend on the number of workers. */
+  dsa::Rng rng;
+
+  std::string status{"pending"};
+  double msec{0};
+  int lat{-1}, latmis{-1}, ovr{-1};
+};
+
+/*! \brief The options of ss_sched which apply to every job. */
+struct BatchOptions {
+  bool verbose{false};
+  bool compact_json{false};
+  int max_iters{20000};
+  int max_edge_delay{15};
+  int decomposer{8};
+  int indirect{0};
+  ArtifactPolicy artifacts{ArtifactPolicy::Final};
+  /*! \brief Shared by the workers, if not null. */
+  MappingCache* cache{nullptr};
+};
+
+/*!
+ * \brief Parse the manifest. Each line is a model, a DFG, and optionally the timeout of the
+ *        job in seconds. Empty lines and lines starting with # are skipped.
+ */
+std::vector<Job> ParseManifest(const std::string& filename, float timeout) {
+  std::ifstream ifs(filename);
+  CHECK(ifs.good()) << "Cannot open " << filename;
+  std::vector<Job> res;
+  std::string line;
+  for (int lineno = 1; std::getline(ifs, line); ++lineno) {
+    std::istringstream iss(line);
+    Job job;
+    job.timeout = timeout;
+    job.line = lineno;
+    if (!(iss >> job.model) || job.model[0] == '#') continue;
+    CHECK(iss >> job.dfg) << filename << ":" << lineno << ": Expect a model and a DFG";
+    iss >> job.timeout;
+    res.push_back(job);
+  }
+  return res;
+}
+
+/*!
+ * \brief Schedule a job on a copy of the loaded model, and write the config header, the
+ *        mapping, and the dumps in the output directory of the job. The model is copied,
+ *        because the routing keeps its states in the fabric, while the instruction
+ *        capabilities are shared.
+ */
+void RunJob(Job& job, const SSModel& prototype, const BatchOptions& opts) {
+  SSModel ssmodel(prototype);
+  ssmodel.memory_size = prototype.memory_size;
+  ssmodel.io_ports = prototype.io_ports;
+  if (opts.max_edge_delay != -1) {
+    ssmodel.setMaxEdgeDelay(opts.max_edge_delay);
+  }
+  if (opts.decomposer != -1) {
+    for (auto elem : ssmodel.subModel()->node_list()) {
+      elem->decomposer = opts.decomposer;
+    }
+  }
+  ssmodel.indirect(opts.indirect);
+
+  SSDfg ssdfg(job.dfg);
+  SchedulerSimulatedAnnealing sa(&ssmodel, job.timeout, opts.max_iters, opts.verbose);
+  sa.compact_json = opts.compact_json;
+  sa.rng = job.rng;
+  sa.artifacts = opts.artifacts;
+  sa.cache = opts.cache;
+  sa.suppress_timing_print = true;
+  // The clock of the scheduler is not started if the DFG is rejected by the feasibility check.
+  auto start = std::chrono::steady_clock::now();
+  Schedule* sched = sa.invoke(&ssmodel, &ssdfg, false, job.out_dir);
+  job.msec = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+                 .count();
+  if (!sched) {
+    job.status = job.msec >= job.timeout * 1000 ? "timeout" : "failed";
+    return;
+  }
+  job.status = "mapped";
+  sched->cheapCalcLatency(job.lat, job.latmis);
+  int agg_ovr = 0, max_util = 0;
+  sched->get_overprov(job.ovr, agg_ovr, max_util);
+  sched->DumpMappingInJson(job.out_dir + "/" + basename(job.dfg) + ".mapping.json",
+                           opts.compact_json);
+  delete sched;
+}
+
+int Wait(pid_t pid) {
+  int status = 0;
+  while (waitpid(pid, &status, 0) == -1 && errno == EINTR) {
+  }
+  return status;
+}
+
+/*!
+ * \brief If a model can be parsed. It is tried in a forked process, since a malformed model
+ *        aborts the parser.
+ */
+bool CanLoad(const std::string& filename) {
+  fflush(stdout);
+  pid_t pid = fork();
+  CHECK(pid != -1) << "Cannot fork";
+  if (pid == 0) {
+    SSModel model(filename.c_str());
+    fflush(stdout);
+    _exit(0);
+  }
+  int status = Wait(pid);
+  return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+/*!
+ * \brief Run a job in a forked process, since a DFG which fails to parse, or any failed
+ *        CHECK, aborts, which is reported as an error of the job instead of ending the batch.
+ */
+void RunIsolated(Job& job, const SSModel& prototype, const BatchOptions& opts) {
+  int fds[2];
+  CHECK(pipe(fds) == 0) << "Cannot create a pipe";
+  fflush(stdout);
+  auto start = std::chrono::steady_clock::now();
+  pid_t pid = fork();
+  CHECK(pid != -1) << "Cannot fork";
+  if (pid == 0) {
+    close(fds[0]);
+    RunJob(job, prototype, opts);
+    dprintf(fds[1], "%s %.3f %d %d %d\n", job.status.c_str(), job.msec, job.lat, job.latmis,
+            job.ovr);
+    fflush(stdout);
+    _exit(0);
+  }
+  close(fds[1]);
+  int status = Wait(pid);
+  // Read without blocking after the job exits, since the jobs forked by the other workers
+  // meanwhile may hold the write end too.
+  fcntl(fds[0], F_SETFL, O_NONBLOCK);
+  char buffer[256], job_status[16];
+  ssize_t n = read(fds[0], buffer, sizeof buffer - 1);
+  close(fds[0]);
+  buffer[std::max<ssize_t>(n, 0)] = '\0';
+  if (WIFEXITED(status) && WEXITSTATUS(status) == 0 &&
+      sscanf(buffer, "%15s %lf %d %d %d", job_status, &job.msec, &job.lat, &job.latmis,
+             &job.ovr) == 5) {
+    job.status = job_status;
+    return;
+  }
+  job.status = "error";
+  job.msec = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+                 .count();
+  fprintf(stderr, "%s on %s: %s\n", job.dfg.c_str(), job.model.c_str(),
+          WIFSIGNALED(status) ? strsignal(WTERMSIG(status)) : "exited with an error");
+}
+
+void PrintSummary(FILE* fout, const std::vector<Job>& jobs, const char* fmt) {
+  for (auto& job : jobs) {
+    fprintf(fout, fmt, job.model.c_str(), job.dfg.c_str(), job.status.c_str(), job.msec / 1000,
+            job.lat, job.latmis, job.ovr);
+  }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  int opt;
+  BatchOptions opts;
+  int num_threads = std::thread::hardware_concurrency();
+  int seed = time(0);
+  float timeout = 86400.0f;
+  std::string summary;
+  std::string cache_dir;
+  int cache_size = 256;
+
+  while ((opt = getopt_long(argc, argv, "vjn:t:i:d:e:r:c:A:s:C:Z:", long_options, nullptr)) != -1) {
+    switch (opt) {
+      case 'v': opts.verbose = true; break;
+      case 'j': opts.compact_json = true; break;
+      case 'n': num_threads = atoi(optarg); break;
+      case 't': timeout = atof(optarg); break;
+      case 'i': opts.max_iters = atoi(optarg); break;
+      case 'd': opts.max_edge_delay = atoi(optarg); break;
+      case 'e': seed = atoi(optarg); break;
+      case 'r': opts.decomposer = atoi(optarg); break;
+      case 'c': opts.indirect = atoi(optarg); break;
+      case 'A': opts.artifacts = ParseArtifactPolicy(optarg); break;
+      case 's': summary = optarg; break;
+      case 'C': cache_dir = optarg; break;
+      case 'Z': cache_size = atoi(optarg); break;
+      default: exit(1);
+    }
+  }
+
+  argc -= optind;
+  argv += optind;
+
+  if (argc != 1) {
+    cerr << "Usage: ss_batch [FLAGS] manifest\n"
+            "  Each line of the manifest is: config.sbmodel compute.dfg [timeout]\n"
+            "  The outputs of a job go in compute.config/ beside the DFG, where compute and\n"
+            "  config are the file names without the extensions, and a pair listed again\n"
+            "  has its line in the manifest appended, e.g. compute.config.7/.\n";
+    exit(1);
+  }
+
+  auto jobs = ParseManifest(argv[0], timeout);
+  dsa::Rng streams(seed);
+  for (auto& job : jobs) {
+    job.rng = streams.Fork();
+  }
+
+  // The outputs of a job go in a directory beside the DFG named after the model, so that a
+  // DFG mapped to several models keeps all of them, and the workers do not share a sched/.
+  // A pair listed again is told apart by its line in the manifest.
+  std::map<std::string, int> out_dirs;
+  for (auto& job : jobs) {
+    job.out_dir = job.dfg.substr(0, job.dfg.find_last_of(".")) + "." + basename(job.model);
+    if (out_dirs[job.out_dir]++) {
+      job.out_dir += "." + std::to_string(job.line);
+    }
+  }
+
+  // The key has the same options as ss_sched, so that the entries are shared.
+  std::unique_ptr<MappingCache> cache;
+  if (!cache_dir.empty()) {
+    std::ostringstream options;
+    options << "max-edge-delay=" << opts.max_edge_delay << " control-flow=" << -1
+            << " decomposer=" << opts.decomposer << " indir-mem=" << opts.indirect;
+    cache.reset(new MappingCache(cache_dir, (int64_t)cache_size << 20, options.str()));
+    opts.cache = cache.get();
+  }
+
+  // Each distinct model is parsed once, before the workers start, which only look it up.
+  // The jobs of a model which fails to parse are errors.
+  std::map<std::string, std::unique_ptr<SSModel>> loaded;
+  for (auto& job : jobs) {
+    if (loaded.count(job.model)) continue;
+    auto& model = loaded[job.model];
+    if (CanLoad(job.model)) {
+      model.reset(new SSModel(job.model.c_str()));
+    } else {
+      fprintf(stderr, "Cannot load the model %s\n", job.model.c_str());
+    }
+  }
+  const auto& models = loaded;
+
+  std::atomic<int> next{0};
+  std::vector<std::thread> workers;
+  num_threads = std::max(1, std::min(num_threads, (int)jobs.size()));
+  for (int i = 0; i < num_threads; ++i) {
+    workers.emplace_back([&]() {
+      for (int j; (j = next++) < (int)jobs.size();) {
+        auto& model = models.at(jobs[j].model);
+        if (model) {
+          RunIsolated(jobs[j], *model, opts);
+        } else {
+          jobs[j].status = "error";
+        }
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  int mapped = 0;
+  for (auto& job : jobs) {
+    mapped += job.status == "mapped";
+  }
+  printf("\n%-24s %-32s %-8s %10s %8s %9s %8s\n", "model", "dfg", "status", "time(s)",
+         "latency", "mismatch", "overprov");
+  PrintSummary(stdout, jobs, "%-24s %-32s %-8s %10.3f %8d %9d %8d\n");
+  printf("%d/%d mapped\n", mapped, (int)jobs.size());
+
+  if (!summary.empty()) {
+    FILE* fout = fopen(summary.c_str(), "w");
+    CHECK(fout) << "Cannot open " << summary;
+    fprintf(fout, "model\tdfg\tstatus\ttime\tlatency\tmismatch\toverprov\n");
+    PrintSummary(fout, jobs, "%s\t%s\t%s\t%.3f\t%d\t%d\t%d\n");
+    fclose(fout);
+  }
+
+  return mapped == (int)jobs.size() ? 0 : 1;
+}
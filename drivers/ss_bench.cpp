@@ -0,0 +1,374 @@
+#include <fcntl.h>
+#include <ftw.h>
+#include <getopt.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "dsa/arch/model.h"
+#include "dsa/dfg/ssdfg.h"
+#include "dsa/mapper/scheduler_sa.h"
+
+using namespace std;
+using namespace dsa;
+
+// clang-format off
+static struct option long_options[] = {
+    {"verbose",   no_argument,       nullptr, 'v',},
+    {"compare",   no_argument,       nullptr, 'c',},
+    {"seeds",     required_argument, nullptr, 'e',},
+    {"max-iters", required_argument, nullptr, 'i',},
+    {"timeout",   required_argument, nullptr, 't',},
+    {"output",    required_argument, nullptr, 'o',},
+    {"tolerance", required_argument, nullptr, 'l',},
+    {0, 0, 0, 0,},
+};
+// clang-format on
+
+namespace {
+
+/*! \brief The columns of a result file, in order. */
+const char* kColumns[] = {"model",      "dfg",          "seed",      "status",
+                          "mapped",     "wall_ms",      "sched_ms",  "routes",
+                          "kroutes_ps", "cand_tried",   "cand_succ", "latency",
+                          "mismatch",   "overprov",     "agg_overprov", "peak_rss_kb"};
+
+/*! \brief A row of a result file, by the column names. */
+using Row = std::map<std::string, std::string>;
+
+struct BenchOptions {
+  std::vector<int> seeds{1, 2, 3};
+  int max_iters{300};
+  float timeout{60};
+  bool verbose{false};
+};
+
+std::string RealPath(const std::string& filename) {
+  char* res = realpath(filename.c_str(), nullptr);
+  CHECK(res) << "Cannot find " << filename;
+  std::string s(res);
+  free(res);
+  return s;
+}
+
+std::string FileName(const std::string& path) {
+  return path.substr(path.find_last_of('/') + 1);
+}
+
+/*!
+ * \brief Schedule a DFG in a forked process, with the same model setup as ss_sched, and
+ *        write the statistics to the pipe. The artifacts the scheduler dumps go to the
+ *        working directory, which is a scratch directory here.
+ */
+void RunChild(const std::string& model_filename, const std::string& dfg_filename, int seed,
+              const BenchOptions& opts, int fd) {
+  // A hard limit on top of the timeout of the scheduler, in case it does not return.
+  alarm((unsigned) (opts.timeout * 2) + 10);
+  if (!opts.verbose) {
+    int null = open("/dev/null", O_WRONLY);
+    dup2(null, STDOUT_FILENO);
+    dup2(null, STDERR_FILENO);
+    close(null);
+  }
+  SSModel ssmodel(model_filename.c_str());
+  ssmodel.memory_size = 4096;
+  ssmodel.setMaxEdgeDelay(15);
+  for (auto elem : ssmodel.subModel()->node_list()) {
+    elem->decomposer = 8;
+  }
+  SSDfg ssdfg(dfg_filename);
+
+  SchedulerSimulatedAnnealing sa(&ssmodel, opts.timeout, opts.max_iters, false);
+  sa.suppress_timing_print = true;
+  sa.artifacts = ArtifactPolicy::None;
+  sa.rng.Seed(seed);
+  Schedule* sched = nullptr;
+  bool mapped = sa.schedule_timed(&ssdfg, sched);
+  double msec = sa.total_msec();
+
+  int lat = 0, latmis = 0, ovr = 0, agg_ovr = 0, max_util = 0;
+  if (sched) {
+    sched->cheapCalcLatency(lat, latmis);
+    sched->get_overprov(ovr, agg_ovr, max_util);
+  }
+  dprintf(fd, "%d %.3f %d %d %d %d %d %d %d\n", (int) mapped, msec, sa.routing_times,
+          sa.candidates_tried, sa.candidates_succ, lat, latmis, ovr, agg_ovr);
+  close(fd);
+  _exit(0);
+}
+
+/*! \brief Run a point of the matrix, and measure the wall time and the peak RSS of it. */
+Row Run(const std::string& model, const std::string& dfg, int seed, const BenchOptions& opts) {
+  Row row;
+  row["model"] = FileName(model);
+  row["dfg"] = FileName(dfg);
+  row["seed"] = std::to_string(seed);
+
+  int fds[2];
+  CHECK(pipe(fds) == 0) << "Cannot create a pipe";
+  auto start = std::chrono::steady_clock::now();
+  pid_t pid = fork();
+  CHECK(pid != -1) << "Cannot fork";
+  if (pid == 0) {
+    close(fds[0]);
+    RunChild(model, dfg, seed, opts, fds[1]);
+  }
+  close(fds[1]);
+  std::string out;
+  char buffer[256];
+  for (ssize_t n; (n = read(fds[0], buffer, sizeof buffer)) > 0;) {
+    out.append(buffer, n);
+  }
+  close(fds[0]);
+  int status;
+  struct rusage usage;
+  wait4(pid, &status, 0, &usage);
+  auto wall = std::chrono::steady_clock::now() - start;
+
+  char wall_ms[32];
+  snprintf(wall_ms, sizeof wall_ms, "%.3f",
+           std::chrono::duration_cast<std::chrono::microseconds>(wall).count() / 1000.0);
+  row["wall_ms"] = wall_ms;
+  row["peak_rss_kb"] = std::to_string(usage.ru_maxrss);
+
+  int mapped, routes, tried, succ, lat, latmis, ovr, agg_ovr;
+  double msec;
+  if (WIFSIGNALED(status) && WTERMSIG(status) == SIGALRM) {
+    row["status"] = "timeout";
+  } else if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 ||
+             sscanf(out.c_str(), "%d %lf %d %d %d %d %d %d %d", &mapped, &msec, &routes, &tried,
+                    &succ, &lat, &latmis, &ovr, &agg_ovr) != 9) {
+    row["status"] = "crash";
+  } else {
+    char buf[32];
+    row["status"] = "ok";
+    row["mapped"] = std::to_string(mapped);
+    snprintf(buf, sizeof buf, "%.3f", msec);
+    row["sched_ms"] = buf;
+    row["routes"] = std::to_string(routes);
+    snprintf(buf, sizeof buf, "%.3f", msec > 0 ? routes / msec : 0.0);
+    row["kroutes_ps"] = buf;
+    row["cand_tried"] = std::to_string(tried);
+    row["cand_succ"] = std::to_string(succ);
+    row["latency"] = std::to_string(lat);
+    row["mismatch"] = std::to_string(latmis);
+    row["overprov"] = std::to_string(ovr);
+    row["agg_overprov"] = std::to_string(agg_ovr);
+  }
+  return row;
+}
+
+void WriteRow(std::ostream& os, const Row& row) {
+  bool first = true;
+  for (auto* column : kColumns) {
+    auto iter = row.find(column);
+    os << (first ? "" : "\t") << (iter == row.end() || iter->second.empty() ? "-" : iter->second);
+    first = false;
+  }
+  os << "\n";
+}
+
+std::vector<Row> ReadRows(const std::string& filename) {
+  std::ifstream ifs(filename);
+  CHECK(ifs.good()) << "Cannot open " << filename;
+  std::vector<std::string> header;
+  std::vector<Row> res;
+  std::string line, field;
+  while (std::getline(ifs, line)) {
+    if (line.empty()) continue;
+    std::istringstream iss(line);
+    if (header.empty()) {
+      while (std::getline(iss, field, '\t')) header.push_back(field);
+      continue;
+    }
+    Row row;
+    for (int i = 0; std::getline(iss, field, '\t'); ++i) {
+      CHECK(i < (int) header.size()) << "Malformed row in " << filename << ": " << line;
+      row[header[i]] = field;
+    }
+    res.push_back(row);
+  }
+  return res;
+}
+
+double Field(const Row& row, const std::string& column) {
+  auto iter = row.find(column);
+  return iter == row.end() || iter->second == "-" ? 0 : atof(iter->second.c_str());
+}
+
+/*!
+ * \brief Compare two result files. The quality of results is compared per run, because a
+ *        seed makes the scheduling deterministic. The throughput is compared per workload,
+ *        aggregated over the seeds to reduce the noise.
+ * \return The number of regressions.
+ */
+int Compare(const std::string& old_file, const std::string& new_file, double tolerance) {
+  auto key = [](const Row& row, bool seed) {
+    return row.at("model") + " " + row.at("dfg") + (seed ? " seed=" + row.at("seed") : "");
+  };
+  std::map<std::string, Row> old_rows;
+  for (auto& row : ReadRows(old_file)) {
+    old_rows[key(row, true)] = row;
+  }
+  // The routes and the scheduling time of each workload, before and after.
+  std::map<std::string, std::vector<double>> throughput;
+  int regressions = 0, matched = 0;
+  for (auto& cur : ReadRows(new_file)) {
+    auto iter = old_rows.find(key(cur, true));
+    if (iter == old_rows.end()) {
+      std::cout << "NEW        " << key(cur, true) << std::endl;
+      continue;
+    }
+    auto& old = iter->second;
+    ++matched;
+    if (old.at("status") == "ok" && cur.at("status") != "ok") {
+      std::cout << "STATUS     " << key(cur, true) << ": " << cur.at("status") << std::endl;
+      ++regressions;
+    }
+    if (old.at("status") != "ok" || cur.at("status") != "ok") {
+      old_rows.erase(iter);
+      continue;
+    }
+    bool worse = Field(cur, "mapped") < Field(old, "mapped");
+    if (Field(cur, "mapped") && Field(old, "mapped")) {
+      for (auto* column : {"latency", "mismatch", "overprov"}) {
+        worse = worse || Field(cur, column) > Field(old, column);
+      }
+    }
+    if (worse) {
+      std::cout << "QOR        " << key(cur, true) << ":";
+      for (auto* column : {"mapped", "latency", "mismatch", "overprov"}) {
+        std::cout << " " << column << " " << old.at(column) << "->" << cur.at(column);
+      }
+      std::cout << std::endl;
+      ++regressions;
+    }
+    auto& elem = throughput[key(cur, false)];
+    elem.resize(4, 0);
+    elem[0] += Field(old, "routes");
+    elem[1] += Field(old, "sched_ms");
+    elem[2] += Field(cur, "routes");
+    elem[3] += Field(cur, "sched_ms");
+    old_rows.erase(iter);
+  }
+  for (auto& elem : old_rows) {
+    std::cout << "MISSING    " << elem.first << std::endl;
+  }
+
+  double log_sum = 0;
+  int n = 0;
+  for (auto& elem : throughput) {
+    auto& v = elem.second;
+    if (v[0] == 0 || v[1] == 0 || v[2] == 0 || v[3] == 0) continue;
+    double before = v[0] / v[1], after = v[2] / v[3];
+    log_sum += std::log(after / before);
+    ++n;
+    if (after < before * (1 - tolerance)) {
+      printf("THROUGHPUT %s: %.1f->%.1f kRPS (%+.1f%%)\n", elem.first.c_str(), before, after,
+             (after / before - 1) * 100);
+      ++regressions;
+    }
+  }
+  printf("%d runs compared, throughput geomean: %.3fx, %d regressions\n", matched,
+         n ? std::exp(log_sum / n) : 1.0, regressions);
+  return regressions;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  int opt;
+  BenchOptions opts;
+  bool compare = false;
+  double tolerance = 0.1;
+  std::string output = "bench.tsv";
+
+  while ((opt = getopt_long(argc, argv, "vce:i:t:o:l:", long_options, nullptr)) != -1) {
+    switch (opt) {
+      case 'v': opts.verbose = true; break;
+      case 'c': compare = true; break;
+      case 'e': {
+        opts.seeds.clear();
+        std::istringstream iss(optarg);
+        for (std::string seed; std::getline(iss, seed, ',');) {
+          opts.seeds.push_back(atoi(seed.c_str()));
+        }
+        break;
+      }
+      case 'i': opts.max_iters = atoi(optarg); break;
+      case 't': opts.timeout = atof(optarg); break;
+      case 'o': output = optarg; break;
+      case 'l': tolerance = atof(optarg); break;
+      default: exit(1);
+    }
+  }
+
+  argc -= optind;
+  argv += optind;
+
+  if (compare) {
+    if (argc != 2) {
+      cerr << "Usage: ss_bench --compare [--tolerance 0.1] old.tsv new.tsv\n";
+      exit(1);
+    }
+    return Compare(argv[0], argv[1], tolerance) ? 1 : 0;
+  }
+
+  std::vector<std::string> models, dfgs;
+  for (int i = 0; i < argc; ++i) {
+    std::string filename = RealPath(argv[i]);
+    bool is_dfg = filename.size() > 4 && filename.substr(filename.size() - 4) == ".dfg";
+    (is_dfg ? dfgs : models).push_back(filename);
+  }
+  if (models.empty() || dfgs.empty() || opts.seeds.empty()) {
+    cerr << "Usage: ss_bench [--seeds 1,2,3] [--max-iters N] [--timeout S] [--output F] "
+            "config.sbmodel... compute.dfg...\n";
+    exit(1);
+  }
+
+  std::ofstream ofs(output);
+  CHECK(ofs.good()) << "Cannot open " << output;
+  for (int i = 0, n = sizeof kColumns / sizeof kColumns[0]; i < n; ++i) {
+    ofs << (i ? "\t" : "") << kColumns[i];
+  }
+  ofs << std::endl;
+
+  // The scheduler may still dump a failure to viz/ under the working directory.
+  char scratch[] = "/tmp/ss_bench.XXXXXX";
+  CHECK(mkdtemp(scratch)) << "Cannot create a scratch directory";
+  std::string cwd = RealPath(".");
+  CHECK(chdir(scratch) == 0);
+  mkdir("viz", 0755);
+  mkdir("viz/iter", 0755);
+
+  int total = models.size() * dfgs.size() * opts.seeds.size(), done = 0;
+  for (auto& model : models) {
+    for (auto& dfg : dfgs) {
+      for (int seed : opts.seeds) {
+        auto row = Run(model, dfg, seed, opts);
+        WriteRow(ofs, row);
+        ofs.flush();
+        cerr << "[" << ++done << "/" << total << "] ";
+        WriteRow(cerr, row);
+      }
+    }
+  }
+
+  CHECK(chdir(cwd.c_str()) == 0);
+  nftw(scratch, [](const char* path, const struct stat*, int, struct FTW*) { return remove(path); },
+       16, FTW_DEPTH | FTW_PHYS);
+  return 0;
+}
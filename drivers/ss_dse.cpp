@@ -2,18 +2,23 @@
 #include <getopt.h>
 #include <signal.h>
 
+#include <atomic>
 #include <chrono>
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
 #include <iomanip>
+#include <memory>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "dsa/arch/model.h"
 #include "dsa/mapper/scheduler.h"
 #include "dsa/mapper/scheduler_sa.h"
 #include "dsa/dfg/ssdfg.h"
 #include "dsa/dfg/visitor.h"
+#include "dsa/profile.h"
 
 using namespace std;
 using sec = chrono::seconds;
@@ -37,6 +42,9 @@ static struct option long_options[] = {
     {"decomposer",     required_argument, nullptr, 'r',},
     {"control-flow",   required_argument, nullptr, 'l',},
     {"memory-size",    required_argument, nullptr, 'm',},
+    {"predictor",      no_argument,       nullptr, 'p',},
+    {"profile",        no_argument,       nullptr, 'P',},
+    {"telemetry",      required_argument, nullptr, 'T',},
     {0, 0, 0, 0,},
 };
 // clang-format on
@@ -57,8 +65,10 @@ int main(int argc, char* argv[]) {
   int decomposer = 8;
   int contrl_flow = -1;
   int memory_size = 4096;
+  bool predictor = false;
+  std::unique_ptr<telemetry::Sink> sink;
 
-  while ((opt = getopt_long(argc, argv, "vst:fc:d:e:l:r:m:", long_options, nullptr)) != -1) {
+  while ((opt = getopt_long(argc, argv, "vst:fc:d:e:l:r:m:pPT:", long_options, nullptr)) != -1) {
     switch (opt) {
       case 's': from_scratch = true; break;
       case 'v': verbose = true; break;
@@ -70,6 +80,9 @@ int main(int argc, char* argv[]) {
       case 'l': contrl_flow = atoi(optarg); break;
       case 'r': decomposer = atoi(optarg); break;
       case 'm': memory_size = atoi(optarg); break;
+      case 'p': predictor = true; break;
+      case 'P': profile::Enable(); break;
+      case 'T': sink.reset(new telemetry::Sink(optarg)); break;
       default: exit(1);
     }
   }
@@ -82,7 +95,8 @@ int main(int argc, char* argv[]) {
     exit(1);
   }
 
-  srand(seed);
+  // The modifications and the mapper draw from the streams of their own.
+  dsa::Rng rng(seed);
 
   std::string model_filename = argv[0];
   std::string pdg_filename = argv[1];
@@ -102,16 +116,22 @@ int main(int argc, char* argv[]) {
   }
 
   scheduler = new SchedulerSimulatedAnnealing(&ssmodel, timeout, max_iters, verbose);
+  scheduler->rng = rng.Fork();
 
   clock_t StartTime = clock();
   scheduler->set_start_time();
 
-  CodesignInstance* cur_ci = new CodesignInstance(&ssmodel);
+  CodesignInstance* cur_ci = new CodesignInstance(&ssmodel, &rng);
+  if (predictor) {
+    cur_ci->estimation_model = dsa::adg::estimation::Model::Predictor;
+  }
   CodesignInstance* best_ci = cur_ci;
   cur_ci->verify();
   std::vector<WorkloadSchedules*> _incr_sched;
 
   {
+    // The DFGs of the manifest, and the workload each belongs to.
+    std::vector<std::pair<int, std::string>> dfg_files;
     std::string curline;
     ifstream dfg_names(pdg_filename);
     while (std::getline(dfg_names, curline)) {
@@ -122,10 +142,29 @@ int main(int argc, char* argv[]) {
         std::istringstream ssin(curline.substr(8, curline.size()));
         ssin >> cur_ci->weight.back();
       } else {
-        cur_ci->workload_array.back().sched_array.emplace_back(cur_ci->ss_model(),
-                                                               new SSDfg(curline));
+        dfg_files.emplace_back(cur_ci->workload_array.size() - 1, curline);
       }
     }
+    // The parsers are reentrant, so the DFGs are loaded in parallel.
+    std::vector<SSDfg*> dfgs(dfg_files.size());
+    std::atomic<int> next(0);
+    std::vector<std::thread> loaders;
+    int num_loaders =
+        std::min<int>(dfg_files.size(), std::max(1u, std::thread::hardware_concurrency()));
+    for (int i = 0; i < num_loaders; ++i) {
+      loaders.emplace_back([&]() {
+        for (int j; (j = next++) < (int)dfg_files.size();) {
+          dfgs[j] = new SSDfg(dfg_files[j].second);
+        }
+      });
+    }
+    for (auto& loader : loaders) {
+      loader.join();
+    }
+    for (size_t i = 0; i < dfg_files.size(); ++i) {
+      cur_ci->workload_array[dfg_files[i].first].sched_array.emplace_back(cur_ci->ss_model(),
+                                                                          dfgs[i]);
+    }
   }
 
   int improv_iter = 0;
@@ -136,7 +175,7 @@ int main(int argc, char* argv[]) {
     std::cout << "Dumping " << sched->ssdfg()->filename << " viz/" << filename << "/ "
               << performance << std::endl;
     std::string path = "viz/" + filename;
-    ENFORCED_SYSTEM(("mkdir -p " + path).c_str());
+    make_directories(path);
     sched->printGraphviz((path + "/graph.gv").c_str());
     std::ofstream ofs(path + "/" + filename + ".dfg.h");
     sched->printConfigHeader(ofs, filename);
@@ -146,6 +185,32 @@ int main(int argc, char* argv[]) {
   int i = 0;
   int last_improve = 0;
 
+  // Emit a DSE iteration with the area/power breakdown of the candidate to the telemetry.
+  auto emit_record = [&](CodesignInstance* ci, const char* modification, double obj,
+                         double best_obj, const char* decision) {
+    if (!sink) return;
+    using namespace dsa::adg::estimation;
+    const char* breakdowns[] = {"fu", "network", "sync", "memory"};
+    auto estimated = EstimatePowerAera(ci->ss_model(), ci->estimation_model);
+    telemetry::Record record("dse");
+    record.Field("iter", i)
+        .Field("time", static_cast<double>(clock() - StartTime) / CLOCKS_PER_SEC)
+        .Field("obj", obj)
+        .Field("best_obj", best_obj)
+        .Field("temperature", temperature)
+        .Field("modification", modification)
+        .Field("decision", decision);
+    for (int j = 0; j < (int) Breakdown::Total; ++j) {
+      record.Field(("area_" + std::string(breakdowns[j])).c_str(),
+                   estimated(Metric::Area, Breakdown(j)));
+      record.Field(("power_" + std::string(breakdowns[j])).c_str(),
+                   estimated(Metric::Power, Breakdown(j)));
+    }
+    record.Field("area", estimated.Total<Metric::Area>())
+        .Field("power", estimated.Total<Metric::Power>());
+    sink->Emit(record);
+  };
+
   {
     double best_indir = -1;
     double best_obj = -1;
@@ -214,6 +279,7 @@ int main(int argc, char* argv[]) {
     // dump the new hw json
     stringstream hw_ss;
     hw_ss << "viz/dse-sched-" << i << ".json";
+    cur_ci->compact();
     cur_ci->ss_model()->subModel()->DumpHwInJson(hw_ss.str().c_str());
   }
 
@@ -227,7 +293,7 @@ int main(int argc, char* argv[]) {
     cand_ci = new CodesignInstance(*cur_ci, from_scratch);
     cur_ci->verify();
     cand_ci->verify();
-    cand_ci->make_random_modification(temperature);
+    const char* modification = cand_ci->make_random_modification(temperature);
     cand_ci->verify();
     std::cout << "dse modification: "
               << static_cast<double>(clock() - StartChange) / CLOCKS_PER_SEC << "s" << std::endl;
@@ -250,16 +316,19 @@ int main(int argc, char* argv[]) {
               << std::setprecision(7);
 
     if (obj_func < (1.0 + 1e-3)) {
+      emit_record(cand_ci, modification, obj_func, best_obj, "invalid");
       continue;
     }
 
     cand_ci->dump_breakdown(verbose);
 
     if (cand_ci->weight_obj() > best_ci->weight_obj()) {
+      emit_record(cand_ci, modification, obj_func, best_obj, "improve");
       improv_iter = i;
       delete cur_ci;
       best_ci = cur_ci = cand_ci;
       std::cout << "----------------- IMPROVED OBJ! --------------------\n";
+      best_ci->compact();
       std::cout << "Execution Time: " << std::setprecision(6)
                 << static_cast<double>(clock() - StartTime) / CLOCKS_PER_SEC
                 << ", " << static_cast<double>(ScheduleCollapse) / CLOCKS_PER_SEC
@@ -276,23 +345,30 @@ int main(int argc, char* argv[]) {
       stringstream hw_ss;
       hw_ss << "viz/dse-sched-" << i << ".json";
       best_ci->ss_model()->subModel()->DumpHwInJson(hw_ss.str().c_str());
+      // the binary one is for reloading the checkpoint fast
+      best_ci->ss_model()->subModel()->DumpHwInBinary(
+          ("viz/dse-sched-" + std::to_string(i) + ".adg.bin").c_str(),
+          best_ci->ss_model()->fu_types);
       temperature *= 0.98;
       last_improve = i;
 
     } else {
       if (i - last_improve >= 50) {
+        emit_record(cand_ci, modification, obj_func, best_obj, "reset");
         temperature *= 0.99;
         cur_ci = best_ci;
       } else {
-        double p = (double) rand() / RAND_MAX;
+        double p = rng.Uniform();
         double target = exp(-(best_ci->weight_obj() - cand_ci->weight_obj()) / temperature);
         if (p < target) {
+          emit_record(cand_ci, modification, obj_func, best_obj, "accept");
           std::cout << p << " < " << target << ", accept a worse point!" << std::endl;
           if (cur_ci != best_ci) {
             delete cur_ci;
           }
           cur_ci = cand_ci;
         } else {
+          emit_record(cand_ci, modification, obj_func, best_obj, "reject");
           delete cand_ci;
         }
       }
@@ -317,6 +393,7 @@ int main(int argc, char* argv[]) {
             << std::setprecision(7);
 
   cur_ci->dump_breakdown(verbose);
+  cur_ci->compact();
 
   for (int x = 0, ew = cur_ci->workload_array.size(); x < ew; ++x) {
     ostringstream oss;
@@ -326,6 +403,7 @@ int main(int argc, char* argv[]) {
   }
 
   cur_ci->prune_all_unused();
+  cur_ci->compact();
   cur_ci->ss_model()->subModel()->DumpHwInJson("viz/pruned.json");
   std::cout << "Pruned DSE OBJ: " << cur_ci->weight_obj() << "\n";
   cur_ci->dump_breakdown(verbose);
@@ -333,5 +411,7 @@ int main(int argc, char* argv[]) {
   std::cout << "Total Time: " << static_cast<double>(clock() - StartTime) / CLOCKS_PER_SEC
             << std::endl;
 
+  profile::Report(std::cout);
+
   return 0;
 }
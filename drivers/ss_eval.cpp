@@ -0,0 +1,305 @@
+#include <getopt.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "dsa/arch/ssinst.h"
+#include "dsa/dfg/ssdfg.h"
+#include "dsa/dfg/utils.h"
+#include "dsa/simulation/evaluator.h"
+
+using namespace std;
+using namespace dsa;
+
+// clang-format off
+static struct option long_options[] = {
+    {"vectors", required_argument, nullptr, 'n',},
+    {"batch",   required_argument, nullptr, 'b',},
+    {"seed",    required_argument, nullptr, 'e',},
+    {"check",   no_argument,       nullptr, 'c',},
+    {"kernels", no_argument,       nullptr, 'k',},
+    {"round-trip", no_argument,    nullptr, 'r',},
+    {0, 0, 0, 0,},
+};
+// clang-format on
+
+namespace {
+
+/*!
+ * \brief Feed the vectors of a pass to the interpreter, and compare its outputs with the
+ *        evaluator. Return the number of mismatched operands.
+ */
+int CheckPass(SSDfg& dfg, simulation::Evaluator& eval, int n) {
+  auto& inputs = eval.inputs();
+  auto& outputs = eval.outputs();
+  int pushed = 0, popped = 0, mismatches = 0;
+  std::vector<uint64_t> data;
+  std::vector<bool> valid;
+  // The interpreter should drain a vector in a bounded number of cycles.
+  for (int64_t cycle = 0; popped < n; ++cycle) {
+    CHECK(cycle < (int64_t) n * 1000) << "The interpreter is stuck at vector " << popped;
+    bool ready = pushed < n;
+    for (auto* port : inputs) {
+      ready = ready && port->can_push();
+    }
+    if (ready) {
+      for (int i = 0, m = inputs.size(); i < m; ++i) {
+        for (int j = 0, v = inputs[i]->values.size(); j < v; ++j) {
+          inputs[i]->values[j].push(eval.Input(i, j)[pushed], eval.InputMask(i, j)[pushed], 0);
+        }
+      }
+      ++pushed;
+    }
+    dfg.forward(true);
+    bool drained = true;
+    for (auto* port : outputs) {
+      drained = drained && port->can_pop();
+    }
+    if (!drained) continue;
+    for (int i = 0, m = outputs.size(); i < m; ++i) {
+      data.clear();
+      valid.clear();
+      outputs[i]->pop(data, valid);
+      for (int j = 0, o = data.size(); j < o; ++j) {
+        bool eval_valid = eval.OutputMask(i, j)[popped];
+        uint64_t eval_data = eval.Output(i, j)[popped];
+        if (eval_valid != valid[j] || (valid[j] && eval_data != data[j])) {
+          if (mismatches++ < 10) {
+            cerr << "Vector " << popped << ", " << outputs[i]->name() << "[" << j
+                 << "]: interpreter " << data[j] << (valid[j] ? "" : " (invalid)")
+                 << ", evaluator " << eval_data << (eval_valid ? "" : " (invalid)") << endl;
+          }
+        }
+      }
+    }
+    ++popped;
+  }
+  return mismatches;
+}
+
+/*!
+ * \brief Compare execute64_batch with execute64 word by word, for each instruction with a
+ *        SIMD kernel. Each 16-bit lane of an operand is random, or one of the values the
+ *        kernels treat specially. Return the number of mismatched words.
+ */
+int CheckKernels(mt19937_64& rng, int n) {
+  // The signed boundaries of the fixed-point lanes, and the high halves of the float NaNs
+  // and infinities.
+  static const uint16_t kLanes[] = {0, 1, 0x7fff, 0x8000, 0x8001, 0xffff, 0x7f80, 0x7fc0, 0xff80};
+  int checked = 0, mismatches = 0;
+  for (int op = SS_ERR + 1; op < SS_NUM_TYPES; ++op) {
+    auto inst = (OpCode) op;
+    if (!has_batch_kernel(inst) || bitwidth[op] != 64) continue;
+    int arity = num_ops[op];
+    CHECK(arity <= 4);
+    std::vector<std::vector<uint64_t>> columns(arity, std::vector<uint64_t>(n));
+    const uint64_t* ops[4];
+    for (int i = 0; i < arity; ++i) {
+      for (int k = 0; k < n; ++k) {
+        uint64_t word = rng();
+        for (int lane = 0; lane < 4; ++lane) {
+          if (rng() % 2) {
+            word &= ~(0xffffull << lane * 16);
+            word |= (uint64_t) kLanes[rng() % (sizeof kLanes / sizeof kLanes[0])] << lane * 16;
+          }
+        }
+        columns[i][k] = word;
+      }
+      ops[i] = columns[i].data();
+    }
+    std::vector<uint64_t> res(n);
+    uint64_t reg[8] = {0};
+    execute64_batch(inst, ops, arity, res.data(), n, reg);
+    for (int k = 0; k < n; ++k) {
+      uint64_t operands[4], outs[4], scalar_reg[8] = {0};
+      bool back_array[4] = {false, false, false, false};
+      bool discard = false;
+      for (int i = 0; i < arity; ++i) {
+        operands[i] = columns[i][k];
+      }
+      uint64_t expect = execute64(inst, operands, arity, outs, scalar_reg, discard, back_array);
+      if (expect != res[k] && mismatches++ < 10) {
+        cerr << name_of_inst(inst) << ", word " << k << ": batch " << hex << res[k]
+             << ", scalar " << expect << dec << endl;
+      }
+    }
+    ++checked;
+  }
+  cout << "Kernels: " << checked << " checked on " << n << " words\n";
+  return mismatches;
+}
+
+std::string ReadFile(const std::string& filename) {
+  std::ifstream ifs(filename);
+  CHECK(ifs.good()) << "Cannot open " << filename;
+  std::ostringstream oss;
+  oss << ifs.rdbuf();
+  return oss.str();
+}
+
+/*!
+ * \brief Dump a DFG to the binary format, load it back, and compare its json dump with the
+ *        one of the DFG parsed. Unlike a json, the binary keeps everything the json dumps,
+ *        e.g. the names of the instructions, so the two are expected to be the same.
+ *        A byte is written to the given pipe once the DFG is parsed.
+ *        Return if they are.
+ */
+bool CheckRoundTrip(const std::string& filename, int fd) {
+  SSDfg dfg(filename);
+  CHECK(write(fd, "p", 1) == 1);
+
+  char scratch[] = "/tmp/ss_eval.XXXXXX";
+  CHECK(mkdtemp(scratch)) << "Cannot create a scratch directory";
+  std::string dir = scratch;
+  std::string json = dir + "/a.dfg.json", binary = dir + "/a.dfg.bin";
+  std::string from_binary = dir + "/binary.dfg.json";
+
+  dsa::dfg::Export(&dfg, json);
+  dsa::dfg::ExportBinary(&dfg, binary);
+  std::unique_ptr<SSDfg> loaded(dsa::dfg::Import(binary));
+  dsa::dfg::Export(loaded.get(), from_binary);
+
+  bool res = ReadFile(json) == ReadFile(from_binary);
+  cout << filename << ": " << (res ? "matched" : "the binary differs, kept in " + dir) << "\n";
+  if (res) {
+    for (auto& elem : {json, binary, from_binary}) {
+      unlink(elem.c_str());
+    }
+    rmdir(scratch);
+  }
+  return res;
+}
+
+/*!
+ * \brief Check the round trip of each DFG in a forked process, since a DFG which fails to
+ *        parse aborts. Such DFGs are skipped. Return the number of the others which fail.
+ */
+int CheckRoundTrips(char** filenames, int n) {
+  int failed = 0;
+  for (int i = 0; i < n; ++i) {
+    int fds[2];
+    CHECK(pipe(fds) == 0) << "Cannot create a pipe";
+    cout.flush();
+    pid_t pid = fork();
+    CHECK(pid != -1) << "Cannot fork";
+    if (pid == 0) {
+      close(fds[0]);
+      bool res = CheckRoundTrip(filenames[i], fds[1]);
+      cout.flush();
+      _exit(!res);
+    }
+    close(fds[1]);
+    char parsed;
+    bool is_parsed = read(fds[0], &parsed, 1) == 1;
+    close(fds[0]);
+    int status;
+    waitpid(pid, &status, 0);
+    if (!is_parsed) {
+      cout << filenames[i] << ": cannot be parsed, skipped\n";
+    } else if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      if (!WIFEXITED(status)) {
+        cout << filenames[i] << ": crashed\n";
+      }
+      ++failed;
+    }
+  }
+  return failed;
+}
+
+}  // namespace
+
+// Evaluate the non-temporal sub-DFGs of a DFG on random vectors, and report the
+// throughput. With --check, the results are compared against the cycle-by-cycle
+// interpreter, SSDfg::forward. With --kernels, no DFG is given, and the SIMD kernels of
+// the instructions are compared against their scalar bodies instead. With --round-trip,
+// the DFGs given are dumped to the binary format and loaded back instead.
+int main(int argc, char* argv[]) {
+  int opt;
+  int64_t vectors = 1 << 20;
+  int batch = 1024;
+  int seed = 0;
+  bool check = false;
+  bool kernels = false;
+  bool round_trip = false;
+
+  while ((opt = getopt_long(argc, argv, "n:b:e:ckr", long_options, nullptr)) != -1) {
+    switch (opt) {
+      case 'n': vectors = atoll(optarg); break;
+      case 'b': batch = atoi(optarg); break;
+      case 'e': seed = atoi(optarg); break;
+      case 'c': check = true; break;
+      case 'k': kernels = true; break;
+      case 'r': round_trip = true; break;
+      default: exit(1);
+    }
+  }
+
+  argc -= optind;
+  argv += optind;
+
+  if (kernels ? argc != 0 : round_trip ? argc == 0 : argc != 1) {
+    cerr << "Usage: ss_eval [--vectors N] [--batch N] [--seed N] [--check] file.dfg\n"
+            "       ss_eval [--vectors N] [--seed N] --kernels\n"
+            "       ss_eval --round-trip file.dfg...\n";
+    exit(1);
+  }
+
+  if (round_trip) {
+    int failed = CheckRoundTrips(argv, argc);
+    cout << (failed ? "Mismatches: " + to_string(failed) : string("Matched")) << "\n";
+    return failed != 0;
+  }
+
+  mt19937_64 rng(seed);
+  int mismatches = 0;
+
+  if (kernels) {
+    mismatches = CheckKernels(rng, vectors);
+    cout << (mismatches ? "Mismatches: " + to_string(mismatches) : string("Matched")) << "\n";
+    return mismatches != 0;
+  }
+
+  SSDfg dfg(argv[0]);
+
+  for (int group = 0; group < dfg.num_groups(); ++group) {
+    if (dfg.group_prop(group).is_temporal) {
+      cout << "Sub-DFG " << group << ": temporal, skipped\n";
+      continue;
+    }
+    simulation::Evaluator eval(&dfg, group, batch);
+    double elapsed = 0;
+    for (int64_t done = 0; done < vectors; done += batch) {
+      int n = min<int64_t>(batch, vectors - done);
+      for (int i = 0, m = eval.inputs().size(); i < m; ++i) {
+        for (int j = 0, v = eval.inputs()[i]->values.size(); j < v; ++j) {
+          uint64_t* lanes = eval.Input(i, j);
+          for (int k = 0; k < n; ++k) {
+            lanes[k] = rng();
+          }
+        }
+      }
+      auto start = chrono::steady_clock::now();
+      eval.Run(n);
+      elapsed += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+      if (check) {
+        mismatches += CheckPass(dfg, eval, n);
+      }
+    }
+    cout << "Sub-DFG " << group << ": " << eval.tape_size() << " steps, " << vectors
+         << " vectors, " << (elapsed > 0 ? vectors / elapsed : 0) << " vectors/s\n";
+  }
+
+  if (check) {
+    cout << (mismatches ? "Mismatches: " + to_string(mismatches) : string("Matched")) << "\n";
+  }
+  return mismatches != 0;
+}
@@ -6,6 +6,8 @@
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <sstream>
 #include <string>
 
 #include "dsa/arch/model.h"
@@ -14,6 +16,8 @@
 #include "dsa/mapper/scheduler_sa.h"
 #include "dsa/dfg/ssdfg.h"
 #include "dsa/dfg/utils.h"
+#include "dsa/profile.h"
+#include "dsa/simulation/simulator.h"
 
 using namespace std;
 using sec = chrono::seconds;
@@ -30,6 +34,9 @@ static struct option long_options[] = {
     {"indir-mem",      no_argument,       nullptr, 'c',},
     {"print-bit",      no_argument,       nullptr, 'b',},
     {"dump-mapping-if-improved",   no_argument, nullptr, 'u',},
+    {"compact-json",   no_argument,       nullptr, 'j',},
+    {"profile",        no_argument,       nullptr, 'P',},
+    {"simulate",       required_argument, nullptr, 'k',},
     {"timeout",        required_argument, nullptr, 't',},
     {"max-iters",      required_argument, nullptr, 'i',},
     {"max-edge-delay", required_argument, nullptr, 'd',},
@@ -40,6 +47,11 @@ static struct option long_options[] = {
     {"hardware-json",  required_argument, nullptr, 'h',},
     {"software-json",  required_argument, nullptr, 's',},
     {"mapping-json",   required_argument, nullptr, 'a',},
+    {"telemetry",      required_argument, nullptr, 'T',},
+    {"artifacts",      required_argument, nullptr, 'A',},
+    {"cache-dir",      required_argument, nullptr, 'C',},
+    {"cache-size",     required_argument, nullptr, 'Z',},
+    {"warm-start",     required_argument, nullptr, 'w',},
     {0, 0, 0, 0,},
 };
 // clang-format on
@@ -68,8 +80,15 @@ int main(int argc, char* argv[]) {
   std::string sw_json_filename = "";
   std::string mapping_json_filename = "";
   bool dump_mapping_if_improved = false;
-
-  while ((opt = getopt_long(argc, argv, "m:vt:c:bd:e:l:r:h:s:a:u", long_options, nullptr)) != -1) {
+  bool compact_json = false;
+  int simulate = 0;
+  std::unique_ptr<telemetry::Sink> sink;
+  ArtifactPolicy artifacts = ArtifactPolicy::All;
+  std::string cache_dir;
+  int cache_size = 256;
+  std::string warm_start;
+
+  while ((opt = getopt_long(argc, argv, "m:vt:c:bd:e:l:r:h:s:a:ujk:PT:A:C:Z:w:", long_options, nullptr)) != -1) {
     switch (opt) {
       case 'v': verbose = true; break;
       case 'c': indirect = atoi(optarg); break;
@@ -85,6 +104,14 @@ int main(int argc, char* argv[]) {
       case 's': sw_json_filename = optarg; break;
       case 'a': mapping_json_filename = optarg; break;
       case 'u': dump_mapping_if_improved = true; break;
+      case 'j': compact_json = true; break;
+      case 'k': simulate = atoi(optarg); break;
+      case 'P': profile::Enable(); break;
+      case 'T': sink.reset(new telemetry::Sink(optarg)); break;
+      case 'A': artifacts = ParseArtifactPolicy(optarg); break;
+      case 'C': cache_dir = optarg; break;
+      case 'Z': cache_size = atoi(optarg); break;
+      case 'w': warm_start = optarg; break;
       default: exit(1);
     }
   }
@@ -104,8 +131,6 @@ int main(int argc, char* argv[]) {
     exit(1);
   }
 
-  srand(seed);
-
 
 
   std::string model_filename = argv[0];
@@ -130,14 +155,30 @@ int main(int argc, char* argv[]) {
   if (argc == 2) {
     std::string pdg_filename = argv[1];
 
-    scheduler = new SchedulerSimulatedAnnealing(&ssmodel, timeout, max_iters, verbose, mapping_json_filename, dump_mapping_if_improved);
+    auto sa = new SchedulerSimulatedAnnealing(&ssmodel, timeout, max_iters, verbose, mapping_json_filename, dump_mapping_if_improved);
+    sa->compact_json = compact_json;
+    sa->telemetry = sink.get();
+    sa->artifacts = artifacts;
+    sa->warm_start = warm_start;
+    sa->rng.Seed(seed);
+    scheduler = sa;
+
+    // The options which change what a valid mapping is are a part of the key.
+    std::unique_ptr<MappingCache> cache;
+    if (!cache_dir.empty()) {
+      std::ostringstream options;
+      options << "max-edge-delay=" << max_edge_delay << " control-flow=" << contrl_flow
+              << " decomposer=" << decomposer << " indir-mem=" << indirect;
+      cache.reset(new MappingCache(cache_dir, (int64_t) cache_size << 20, options.str()));
+      sa->cache = cache.get();
+    }
 
     SSDfg ssdfg(pdg_filename);
 
     Schedule* sched = scheduler->invoke(&ssmodel, &ssdfg, print_bits);
     // Dump hardware
     if(hw_json_filename != "") {
-      ssmodel.subModel()->DumpHwInJson(hw_json_filename.c_str());
+      ssmodel.subModel()->DumpHwInJson(hw_json_filename.c_str(), compact_json);
     }
 
     // Dump software
@@ -145,12 +186,31 @@ int main(int argc, char* argv[]) {
       for (auto &edge : ssdfg.edges) {
         edge.delay = sched->edge_delay(&edge);
       }
-      dfg::Export(&ssdfg, sw_json_filename);
+      dfg::Export(&ssdfg, sw_json_filename, compact_json);
     }
 
     // Dump Final Mapping
     if(mapping_json_filename != ""){
-      sched->DumpMappingInJson(mapping_json_filename);
+      sched->DumpMappingInJson(mapping_json_filename, compact_json);
+    }
+
+    // Feed the given number of vectors to each input port, and measure the throughput.
+    if (simulate && sched) {
+      simulation::Simulator sim(sched);
+      for (auto &port : ssdfg.type_filter<SSDfgVecInput>()) {
+        for (int i = 0; i < simulate; ++i) {
+          sim.Push(&port, std::vector<uint64_t>(port.values.size(), i + 1));
+        }
+      }
+      // A run much longer than the vectors fed is stuck, e.g. on an operand which is
+      // never consumed, so the cycles are bounded by the number of vectors.
+      const uint64_t kCyclesPerVector = 1024;
+      sim.Run((simulate + 1) * kCyclesPerVector);
+      if (!sim.quiescent()) {
+        std::cout << "Simulation stopped at the cycle limit: " << sim.cur_cycle() << std::endl;
+      }
+      sim.stats().Dump(std::cout);
+      std::cout << "Estimated Performance: " << sched->estimated_performance() << std::endl;
     }
   }
 
@@ -159,5 +219,7 @@ int main(int argc, char* argv[]) {
   auto res = dsa::adg::estimation::EstimatePowerAera(&ssmodel);
   res.Dump(std::cout);
 
+  profile::Report(std::cout);
+
   return 0;
 }
@@ -0,0 +1,713 @@
+// A scheduling daemon, which keeps the models loaded across the requests.
+//
+// The requests and the replies are lines of "key value" on a Unix domain socket.
+// A schedule request is ended by "run":
+//
+//   id <token>                   optional, for the cancellation
+//   model <config.sbmodel>
+//   dfg <compute.dfg>            or, "dfg-inline <name> <bytes>" followed by the text
+//   timeout <seconds>            the time limit of the search
+//   deadline <seconds>           the time limit since the request is received
+//   max-iters <n>
+//   max-edge-delay <n>
+//   decomposer <n>
+//   indir-mem <n>
+//   seed <n>                     the seed of the search, 0 by default
+//   run
+//
+// It is replied with the lines below, where the artifacts are followed by their text:
+//
+//   status mapped|failed|timeout|cancelled|error
+//   message <text>               on an error
+//   time <seconds>
+//   latency <n>
+//   mismatch <n>
+//   header <bytes>               the config header
+//   mapping <bytes>              the mapping in json
+//   dfg-json <bytes>             the DFG the header refers to, as sched/<name>.dfg.json
+//   dfg-bin <bytes>              the same in the binary format, as sched/<name>.dfg.bin
+//   end
+//
+// The header is the cheat form, which names the DFG instead of encoding the config, so a
+// client simulating the mapping saves the two DFG dumps under sched/ of where it runs, with
+// <name> the DFG file name without the extension.
+//
+// "cancel <token>" stops a queued or running request, and is replied with "ok" or "unknown".
+// A request stopped by a cancellation or its deadline still replies the best complete
+// mapping found so far, if any, as "mapped". A connection may send requests one after another.
+//
+// A job runs in a scratch directory of its own, so the files beside the DFG are left as they
+// are, and concurrent jobs of the same DFG do not overwrite each other's dumps. It is
+// scheduled in a forked process, since a DFG or a model which fails to parse, or any failed
+// CHECK, aborts, and that is replied as an error instead of killing the daemon. A model is
+// also loaded in a forked process first, before it is loaded to be kept.
+//
+// On SIGTERM or SIGINT, the daemon stops accepting, cancels the requests in flight, which are
+// replied as usual, and removes its socket and its scratch directory.
+
+#include <ftw.h>
+#include <getopt.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dsa/arch/model.h"
+#include "dsa/dfg/ssdfg.h"
+#include "dsa/mapper/scheduler_sa.h"
+#include "mapper/pass/shortest_path.h"
+
+using namespace std;
+using namespace dsa;
+
+using get_time = std::chrono::steady_clock;
+
+// clang-format off
+static struct option long_options[] = {
+    {"verbose",        no_argument,       nullptr, 'v',},
+    {"compact-json",   no_argument,       nullptr, 'j',},
+    {"jobs",           required_argument, nullptr, 'n',},
+    {"models",         required_argument, nullptr, 'm',},
+    {0, 0, 0, 0,},
+};
+// clang-format on
+
+namespace {
+
+/*! \brief A schedule request, and its reply. */
+struct Job {
+  std::string id;
+  std::string model, dfg;
+  /*! \brief The name and the text of an inline DFG. */
+  std::string dfg_name, dfg_text;
+  float timeout{86400};
+  float deadline{-1};
+  int max_iters{20000};
+  int max_edge_delay{15};
+  int decomposer{8};
+  int indirect{0};
+  uint64_t seed{0};
+
+  get_time::time_point received;
+
+  std::string status, message, header, mapping, dfg_json, dfg_bin;
+  double msec{0};
+  int lat{-1}, latmis{-1};
+
+  /*! \brief The states below are guarded by the lock of the server. */
+  bool done{false}, cancelled{false};
+  /*! \brief The process working on it, to stop. */
+  pid_t pid{0};
+};
+
+/*! \brief A loaded model, and the analyses shared by the schedules on it. */
+struct ModelEntry {
+  std::string key;
+  std::unique_ptr<SSModel> model;
+};
+
+/*! \brief The 64-bit FNV-1a hash of a file. */
+std::string HashOf(const std::string& filename) {
+  std::ifstream ifs(filename);
+  std::ostringstream oss;
+  oss << ifs.rdbuf();
+  uint64_t h = 0xcbf29ce484222325ull;
+  for (unsigned char c : oss.str()) {
+    h = (h ^ c) * 0x100000001b3ull;
+  }
+  return std::to_string(h);
+}
+
+std::string ReadFile(const std::string& filename) {
+  std::ifstream ifs(filename);
+  std::ostringstream oss;
+  oss << ifs.rdbuf();
+  return oss.str();
+}
+
+void RemoveTree(const std::string& dir) {
+  nftw(dir.c_str(),
+       [](const char* path, const struct stat*, int, struct FTW*) { return remove(path); }, 16,
+       FTW_DEPTH | FTW_PHYS);
+}
+
+/*! \brief The scheduler of a forked job, which SIGUSR1 and SIGTERM stop. */
+std::atomic<Scheduler*> child_scheduler{nullptr};
+
+/*! \brief Wait for a child process, and return its status. */
+int Wait(pid_t pid) {
+  int status = 0;
+  while (waitpid(pid, &status, 0) == -1 && errno == EINTR) {
+  }
+  return status;
+}
+
+/*!
+ * \brief Schedule a job in a forked process, and write if it is mapped, the latency, and the
+ *        mismatch to the result file of its scratch directory, where the header and the
+ *        other artifacts are dumped.
+ */
+[[noreturn]] void RunChild(const Job& job, const SSModel& model, const std::string& dfg_filename,
+                           const std::string& dir, float timeout, bool compact_json) {
+  SSModel ssmodel(model);
+  ssmodel.memory_size = model.memory_size;
+  ssmodel.io_ports = model.io_ports;
+  if (job.max_edge_delay != -1) {
+    ssmodel.setMaxEdgeDelay(job.max_edge_delay);
+  }
+  if (job.decomposer != -1) {
+    for (auto elem : ssmodel.subModel()->node_list()) {
+      elem->decomposer = job.decomposer;
+    }
+  }
+  ssmodel.indirect(job.indirect);
+
+  SSDfg ssdfg(dfg_filename);
+  SchedulerSimulatedAnnealing sa(&ssmodel, timeout, job.max_iters, false);
+  sa.compact_json = compact_json;
+  sa.artifacts = ArtifactPolicy::None;
+  sa.suppress_timing_print = true;
+  sa.rng.Seed(job.seed);
+
+  // A cancellation is SIGUSR1. SIGTERM, e.g. sent to the group of the daemon when it is
+  // stopped, is taken as one too, instead of the handler of the daemon. The workers block
+  // both, so a signal sent before this is kept pending until the handler is ready.
+  child_scheduler = &sa;
+  signal(SIGUSR1, [](int) { child_scheduler.load()->stop(); });
+  signal(SIGTERM, [](int) { child_scheduler.load()->stop(); });
+  sigset_t mask;
+  sigemptyset(&mask);
+  sigaddset(&mask, SIGUSR1);
+  sigaddset(&mask, SIGTERM);
+  pthread_sigmask(SIG_UNBLOCK, &mask, nullptr);
+
+  Schedule* sched = sa.invoke(&ssmodel, &ssdfg, false, dir);
+  int lat = -1, latmis = -1;
+  if (sched) {
+    sched->cheapCalcLatency(lat, latmis);
+    CHECK(sched->DumpMappingInJson(dir + "/mapping.json", compact_json));
+  }
+  {
+    std::ofstream ofs(dir + "/result");
+    ofs << (sched != nullptr) << " " << lat << " " << latmis << "\n";
+  }
+  std::cout.flush();
+  _exit(0);
+}
+
+/*! \brief Reads the lines and the raw bytes of a connection. */
+class Connection {
+ public:
+  explicit Connection(int fd_) : fd(fd_) {}
+  ~Connection() { close(fd); }
+
+  bool ReadLine(std::string& line) {
+    line.clear();
+    while (true) {
+      auto newline = buffer.find('\n');
+      if (newline != std::string::npos) {
+        line = buffer.substr(0, newline);
+        buffer.erase(0, newline + 1);
+        return true;
+      }
+      if (!Fill()) return false;
+    }
+  }
+
+  bool ReadBytes(size_t n, std::string& bytes) {
+    while (buffer.size() < n) {
+      if (!Fill()) return false;
+    }
+    bytes = buffer.substr(0, n);
+    buffer.erase(0, n);
+    return true;
+  }
+
+  bool Write(const std::string& s) {
+    for (size_t i = 0; i < s.size();) {
+      ssize_t n = write(fd, s.data() + i, s.size() - i);
+      if (n <= 0) return false;
+      i += n;
+    }
+    return true;
+  }
+
+ private:
+  bool Fill() {
+    char buf[4096];
+    ssize_t n = read(fd, buf, sizeof buf);
+    if (n <= 0) return false;
+    buffer.append(buf, n);
+    return true;
+  }
+
+  int fd;
+  std::string buffer;
+};
+
+class Server {
+ public:
+  Server(const std::string& scratch_, int num_workers, int max_models_, bool verbose_,
+         bool compact_json_)
+      : max_models(max_models_), verbose(verbose_), compact_json(compact_json_),
+        scratch(scratch_) {
+    for (int i = 0; i < num_workers; ++i) {
+      workers.emplace_back(&Server::Worker, this);
+    }
+  }
+
+  /*!
+   * \brief Cancel the jobs in flight, and wait for them to be replied, and for the connections
+   *        to be closed.
+   */
+  ~Server() {
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      closing = true;
+      for (auto& job : active) {
+        Stop(*job);
+      }
+    }
+    queue_cv.notify_all();
+    for (auto& worker : workers) {
+      worker.join();
+    }
+    // The replies are written by now, or are being written, which shutting down the reads
+    // does not cut.
+    std::unique_lock<std::mutex> guard(lock);
+    for (int fd : connections) {
+      shutdown(fd, SHUT_RD);
+    }
+    connections_cv.wait(guard, [this]() { return connections.empty(); });
+  }
+
+  /*! \brief Serve a connection in a thread of its own. */
+  void Accept(int fd) {
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      connections.insert(fd);
+    }
+    std::thread(&Server::Serve, this, fd).detach();
+  }
+
+ private:
+  /*! \brief Serve the requests of a connection until it is closed. */
+  void Serve(int fd) {
+    Connection conn(fd);
+    // Declared after the connection, so that it is dropped before the fd is closed and reused.
+    struct Registration {
+      Server* server;
+      int fd;
+      ~Registration() {
+        std::lock_guard<std::mutex> guard(server->lock);
+        server->connections.erase(fd);
+        server->connections_cv.notify_all();
+      }
+    } registration{this, fd};
+    std::string line;
+    auto job = std::make_shared<Job>();
+    while (conn.ReadLine(line)) {
+      std::istringstream iss(line);
+      std::string key;
+      if (!(iss >> key)) continue;
+      if (key == "cancel") {
+        std::string id;
+        iss >> id;
+        if (!conn.Write(Cancel(id) ? "ok\n" : "unknown\n")) return;
+      } else if (key == "run") {
+        Submit(job);
+        if (!conn.Write(Reply(*job))) return;
+        job = std::make_shared<Job>();
+      } else if (key == "dfg-inline") {
+        size_t n = 0;
+        iss >> job->dfg_name >> n;
+        if (!conn.ReadBytes(n, job->dfg_text)) return;
+      } else if (!Parse(*job, key, iss)) {
+        conn.Write("status error\nmessage Unknown key " + key + "\nend\n");
+      }
+    }
+  }
+
+  static bool Parse(Job& job, const std::string& key, std::istringstream& iss) {
+    if (key == "id") iss >> job.id;
+    else if (key == "model") iss >> job.model;
+    else if (key == "dfg") iss >> job.dfg;
+    else if (key == "timeout") iss >> job.timeout;
+    else if (key == "deadline") iss >> job.deadline;
+    else if (key == "max-iters") iss >> job.max_iters;
+    else if (key == "max-edge-delay") iss >> job.max_edge_delay;
+    else if (key == "decomposer") iss >> job.decomposer;
+    else if (key == "indir-mem") iss >> job.indirect;
+    else if (key == "seed") iss >> job.seed;
+    else return false;
+    return true;
+  }
+
+  static std::string Reply(const Job& job) {
+    std::ostringstream oss;
+    oss << "status " << job.status << "\n";
+    if (!job.message.empty()) oss << "message " << job.message << "\n";
+    oss << "time " << job.msec / 1000 << "\n";
+    oss << "latency " << job.lat << "\n";
+    oss << "mismatch " << job.latmis << "\n";
+    oss << "header " << job.header.size() << "\n" << job.header;
+    oss << "mapping " << job.mapping.size() << "\n" << job.mapping;
+    oss << "dfg-json " << job.dfg_json.size() << "\n" << job.dfg_json;
+    oss << "dfg-bin " << job.dfg_bin.size() << "\n" << job.dfg_bin;
+    oss << "end\n";
+    return oss.str();
+  }
+
+  /*! \brief Queue the job, and wait for it to be done. */
+  void Submit(std::shared_ptr<Job> job) {
+    job->received = get_time::now();
+    std::unique_lock<std::mutex> guard(lock);
+    if (closing) {
+      job->status = "error";
+      job->message = "The daemon is shutting down";
+      return;
+    }
+    if (!job->id.empty()) {
+      if (jobs.count(job->id)) {
+        job->status = "error";
+        job->message = "Duplicated id " + job->id;
+        return;
+      }
+      jobs[job->id] = job;
+    }
+    queue.push_back(job);
+    active.insert(job);
+    queue_cv.notify_one();
+    done_cv.wait(guard, [&job]() { return job->done; });
+    active.erase(job);
+    if (!job->id.empty()) {
+      jobs.erase(job->id);
+    }
+  }
+
+  /*! \brief Cancel a job. The lock should be held. */
+  void Stop(Job& job) {
+    job.cancelled = true;
+    if (job.pid) {
+      kill(job.pid, SIGUSR1);
+    }
+  }
+
+  bool Cancel(const std::string& id) {
+    std::lock_guard<std::mutex> guard(lock);
+    auto iter = jobs.find(id);
+    if (iter == jobs.end()) return false;
+    Stop(*iter->second);
+    return true;
+  }
+
+  void Worker() {
+    // Inherited by the forked jobs, see RunChild.
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGUSR1);
+    sigaddset(&mask, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &mask, nullptr);
+    while (true) {
+      std::shared_ptr<Job> job;
+      {
+        std::unique_lock<std::mutex> guard(lock);
+        queue_cv.wait(guard, [this]() { return closing || !queue.empty(); });
+        if (queue.empty()) return;
+        job = queue.front();
+        queue.pop_front();
+      }
+      Run(*job);
+      {
+        std::lock_guard<std::mutex> guard(lock);
+        job->done = true;
+      }
+      done_cv.notify_all();
+    }
+  }
+
+  /*!
+   * \brief The model loaded from the file. The least recently used model is dropped when
+   *        there are too many. The jobs working on it keep it alive. Return null if it
+   *        cannot be loaded.
+   */
+  std::shared_ptr<ModelEntry> GetModel(const std::string& filename) {
+    std::string key = HashOf(filename);
+    std::lock_guard<std::mutex> guard(models_lock);
+    for (auto iter = models.begin(); iter != models.end(); ++iter) {
+      if ((*iter)->key == key) {
+        models.splice(models.begin(), models, iter);
+        return models.front();
+      }
+    }
+    // A malformed model aborts the parser, so it is tried in a forked process first.
+    std::cout.flush();
+    pid_t pid = fork();
+    CHECK(pid != -1) << "Cannot fork";
+    if (pid == 0) {
+      SSModel model(filename.c_str());
+      std::cout.flush();
+      _exit(0);
+    }
+    int status = Wait(pid);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      return nullptr;
+    }
+    auto entry = std::make_shared<ModelEntry>();
+    entry->key = key;
+    entry->model.reset(new SSModel(filename.c_str()));
+    entry->model->distances = std::make_shared<std::vector<std::vector<int>>>(
+        dsa::arch::pass::ShortestPaths(entry->model->subModel()));
+    models.push_front(entry);
+    if ((int)models.size() > max_models) {
+      models.pop_back();
+    }
+    if (verbose) {
+      std::cout << "Loaded " << filename << std::endl;
+    }
+    return entry;
+  }
+
+  void Run(Job& job) {
+    auto start = get_time::now();
+    float timeout = job.timeout;
+    if (job.deadline >= 0) {
+      double left = job.deadline - std::chrono::duration<double>(start - job.received).count();
+      timeout = std::min<double>(timeout, left);
+    }
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      if (job.cancelled || timeout <= 0) {
+        job.status = job.cancelled ? "cancelled" : "timeout";
+        return;
+      }
+    }
+    if (job.model.empty() || access(job.model.c_str(), R_OK) != 0) {
+      job.status = "error";
+      job.message = "Cannot read the model " + job.model;
+      return;
+    }
+
+    if (job.dfg_text.empty() && (job.dfg.empty() || access(job.dfg.c_str(), R_OK) != 0)) {
+      job.status = "error";
+      job.message = "Cannot read the DFG " + job.dfg;
+      return;
+    }
+
+    if (!job.dfg_text.empty() &&
+        (job.dfg_name.find('/') != std::string::npos || job.dfg_name == "..")) {
+      job.status = "error";
+      job.message = "Invalid DFG name " + job.dfg_name;
+      return;
+    }
+
+    auto entry = GetModel(job.model);
+    if (!entry) {
+      job.status = "error";
+      job.message = "Cannot load the model " + job.model;
+      return;
+    }
+
+    // Each job works in its own directory, where the DFG is copied, and where the header
+    // and the artifacts are dumped, so that neither the client's directory nor the other
+    // jobs see them.
+    std::string dir = scratch + "/XXXXXX";
+    CHECK(mkdtemp(&dir[0])) << "Cannot create a scratch directory";
+    std::string dfg_filename;
+    if (!job.dfg_text.empty()) {
+      dfg_filename = dir + "/" + (job.dfg_name.empty() ? "inline" : job.dfg_name) + ".dfg";
+      std::ofstream(dfg_filename) << job.dfg_text;
+    } else {
+      dfg_filename = dir + "/" + job.dfg.substr(job.dfg.find_last_of('/') + 1);
+      std::ofstream(dfg_filename) << ReadFile(job.dfg);
+    }
+
+    pid_t pid = 0;
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      if (!job.cancelled) {
+        std::cout.flush();
+        pid = fork();
+        CHECK(pid != -1) << "Cannot fork";
+        if (pid == 0) {
+          RunChild(job, *entry->model, dfg_filename, dir, timeout, compact_json);
+        }
+        job.pid = pid;
+      }
+    }
+    int status = 0;
+    if (pid) {
+      // Waited without reaping first, so that a cancellation never signals a reused pid.
+      siginfo_t info;
+      while (waitid(P_PID, pid, &info, WEXITED | WNOWAIT) == -1 && errno == EINTR) {
+      }
+      {
+        std::lock_guard<std::mutex> guard(lock);
+        job.pid = 0;
+      }
+      status = Wait(pid);
+    }
+    job.msec = std::chrono::duration<double, std::milli>(get_time::now() - start).count();
+
+    int mapped = 0;
+    std::ifstream result(dir + "/result");
+    if (!pid) {
+      job.status = "cancelled";
+    } else if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 ||
+               !(result >> mapped >> job.lat >> job.latmis)) {
+      job.status = "error";
+      job.message = WIFSIGNALED(status)
+                        ? std::string("The job crashed: ") + strsignal(WTERMSIG(status))
+                        : "The job exited with " + std::to_string(WEXITSTATUS(status));
+      job.lat = job.latmis = -1;
+    } else if (mapped) {
+      std::string name = basename(dfg_filename);
+      job.status = "mapped";
+      job.header = ReadFile(dir + "/" + name + ".dfg.h");
+      job.mapping = ReadFile(dir + "/mapping.json");
+      job.dfg_json = ReadFile(dir + "/sched/" + name + ".dfg.json");
+      job.dfg_bin = ReadFile(dir + "/sched/" + name + ".dfg.bin");
+    } else if (job.cancelled) {
+      job.status = "cancelled";
+    } else {
+      job.status = job.msec >= timeout * 1000 ? "timeout" : "failed";
+    }
+    if (verbose) {
+      std::cout << (job.id.empty() ? basename(dfg_filename) : job.id) << ": " << job.status << " in "
+                << job.msec / 1000 << "s" << std::endl;
+    }
+    RemoveTree(dir);
+  }
+
+  int max_models;
+  bool verbose, compact_json;
+  std::string scratch;
+
+  std::mutex lock;
+  std::condition_variable queue_cv, done_cv;
+  std::deque<std::shared_ptr<Job>> queue;
+  /*! \brief The jobs with an id, to cancel. */
+  std::map<std::string, std::shared_ptr<Job>> jobs;
+  /*! \brief The jobs submitted and not replied yet, to cancel when closing. */
+  std::set<std::shared_ptr<Job>> active;
+  bool closing{false};
+  std::vector<std::thread> workers;
+  /*! \brief The connections being served, to close when closing. */
+  std::set<int> connections;
+  std::condition_variable connections_cv;
+
+  std::mutex models_lock;
+  std::list<std::shared_ptr<ModelEntry>> models;
+};
+
+/*! \brief Written by the handler of SIGTERM and SIGINT, to stop accepting. */
+int stop_pipe[2];
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  int opt;
+  bool verbose = false;
+  bool compact_json = false;
+  int num_workers = std::thread::hardware_concurrency();
+  int max_models = 8;
+
+  while ((opt = getopt_long(argc, argv, "vjn:m:", long_options, nullptr)) != -1) {
+    switch (opt) {
+      case 'v': verbose = true; break;
+      case 'j': compact_json = true; break;
+      case 'n': num_workers = atoi(optarg); break;
+      case 'm': max_models = atoi(optarg); break;
+      default: exit(1);
+    }
+  }
+
+  argc -= optind;
+  argv += optind;
+
+  if (argc != 1) {
+    cerr << "Usage: ss_schedd [FLAGS] socket\n";
+    exit(1);
+  }
+
+  std::string socket_path = argv[0];
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  CHECK(fd != -1) << "Cannot create a socket: " << strerror(errno);
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof addr);
+  addr.sun_family = AF_UNIX;
+  CHECK(socket_path.size() < sizeof addr.sun_path) << "The socket path is too long";
+  strcpy(addr.sun_path, socket_path.c_str());
+  unlink(socket_path.c_str());
+  CHECK(bind(fd, (struct sockaddr*)&addr, sizeof addr) == 0)
+      << "Cannot bind " << socket_path << ": " << strerror(errno);
+  CHECK(listen(fd, 64) == 0) << "Cannot listen: " << strerror(errno);
+
+  // A client closing the connection early should not kill the daemon.
+  signal(SIGPIPE, SIG_IGN);
+  // Only a byte is written in the handler, and the daemon is stopped by the loop below, since
+  // the connections and the workers are still running.
+  CHECK(pipe(stop_pipe) == 0) << "Cannot create a pipe";
+  struct sigaction stop_action;
+  memset(&stop_action, 0, sizeof stop_action);
+  stop_action.sa_handler = [](int) {
+    char c = 0;
+    (void) !write(stop_pipe[1], &c, 1);
+  };
+  sigemptyset(&stop_action.sa_mask);
+  stop_action.sa_flags = SA_RESTART;
+  sigaction(SIGTERM, &stop_action, nullptr);
+  sigaction(SIGINT, &stop_action, nullptr);
+  char scratch_template[] = "/tmp/ss_schedd.XXXXXX";
+  CHECK(mkdtemp(scratch_template)) << "Cannot create a scratch directory";
+  std::string scratch = scratch_template;
+
+  {
+    Server server(scratch, std::max(num_workers, 1), std::max(max_models, 1), verbose,
+                  compact_json);
+    std::cout << "Listening on " << socket_path << std::endl;
+    while (true) {
+      struct pollfd fds[2] = {{fd, POLLIN, 0}, {stop_pipe[0], POLLIN, 0}};
+      if (poll(fds, 2, -1) == -1) {
+        CHECK(errno == EINTR) << "Cannot poll: " << strerror(errno);
+        continue;
+      }
+      if (fds[1].revents) break;
+      int conn = accept(fd, nullptr, nullptr);
+      if (conn == -1) {
+        if (errno == EINTR || errno == ECONNABORTED) continue;
+        CHECK(false) << "Cannot accept: " << strerror(errno);
+      }
+      server.Accept(conn);
+    }
+    close(fd);
+    unlink(socket_path.c_str());
+  }
+  RemoveTree(scratch);
+
+  return 0;
+}
@@ -9,6 +9,11 @@ namespace estimation {
 
 enum class Metric { Power = 0, Area = 1, Total = 2 };
 enum class Breakdown { FU = 0, Network = 1, Sync = 2, Memory = 3, Total = 4 };
+/*!
+ * \brief The model used to estimate switches and FUs: the analytical radix/FIFO model, or the
+ *        neural network predictors in predict.h, evaluated in one batch over the fabric.
+ */
+enum class Model { Analytical = 0, Predictor = 1 };
 
 /*! \brief The result of power/area estimation */
 struct Result {
@@ -31,7 +36,7 @@ struct Result {
 };
 
 /*! \brief Estimating the power/area breakdown of the given hardware */
-Result EstimatePowerAera(SSModel *);
+Result EstimatePowerAera(SSModel *, Model model = Model::Analytical);
 
 
 }
@@ -1,12 +1,14 @@
 #pragma once
 
+#include <deque>
 #include <iostream>
 
 #include "dsa/arch/sub_model.h"
+#include "dsa/rng.h"
 
 namespace dsa {
 
-class SpatialFabric {
+class SpatialFabric : public FabricIndex {
  public:
   // Port type of the substrate nodes
   // opensp -- dyser opensplyser N + N -1 ips
@@ -24,71 +26,21 @@ class SpatialFabric {
 
   void PrintGraphviz(std::ostream& os);
 
-  void DumpHwInJson(const char* name) {
-    ofstream os(name);
-    std::cout << "Hardware JSON file: " << name << std::endl;
-    if (!os.good()) {
-      return;
-    }
-
-    os << "{\n";  // Start of the JSON file
-    // Instruction Set
-    int start_enc = 3;
-    std::set<OpCode> ss_inst_set;
-    os << "\"Instruction Set\" : {\n";
-    for (ssnode* node : node_list()) {
-      ssfu* fu_node = dynamic_cast<ssfu*>(node);
-      if (fu_node != nullptr) {
-        for (auto &elem: fu_node->fu_type_.capability) {
-          ss_inst_set.insert(elem.op);
-        }
-      }
-    }
-    int num_total_inst = ss_inst_set.size();
-    int idx_inst = 0;
-    for (OpCode inst : ss_inst_set) {
-      os << "\"" << dsa::name_of_inst(inst) << "\" : " << start_enc + (idx_inst++);
-      if (idx_inst < num_total_inst) {
-        os << ",";
-      }
-      os << "\n";
-    }
-    os << "},\n";
-
-    // Links
-    os << "\"links\" : [\n";  // The Start of Links
-    int idx_link = 0;
-    int size_links = link_list().size();
-    for (auto link : link_list()) {
-      os << "{\n";
-      os << "\"source\":";
-      link->orig()->dumpIdentifier(os);
-      os << ",\n";
-      os << "\"sink\":";
-      link->dest()->dumpIdentifier(os);
-      os << "}";
-      if (idx_link < size_links - 1) {
-        idx_link++;
-        os << ",\n";  // Seperate the links
-      }
-    }
-    os << "],\n";  // The End of Links
-
-    // Nodes
-    os << "\"nodes\" : [\n";  // The Start of Nodes
-    int idx_node = 0;
-    int size_nodes = node_list().size();
-    for (auto node : node_list()) {
-      node->dumpFeatures(os);
-      if (idx_node < size_nodes - 1) {
-        idx_node++;
-        os << ",\n";
-      }
-    }
-    os << "]\n";  // The End of Nodes
-
-    os << "}\n";  // End of the JSON file
-  }
+  /*!
+   * \brief Dump the fabric in JSON, which can be loaded by parse_json. The ids are dumped
+   *        as they are, so a fabric with tombstones should be compacted first.
+   * \param name The name of the file to dump.
+   * \param compact If links are dumped as [source, sink] tuples instead of objects.
+   */
+  void DumpHwInJson(const char* name, bool compact = false);
+
+  /*!
+   * \brief Dump the fabric in the binary ADG format, which can be loaded by parse_binary
+   *        without any parsing. Like the JSON dump, the fabric should be compacted first.
+   * \param name The name of the file to dump.
+   * \param fu_types The FU types of the model, which are required to add new FUs in DSE.
+   */
+  void DumpHwInBinary(const char* name, const std::vector<Capability*>& fu_types = {});
 
   int sizex() { return _sizex; }
 
@@ -98,9 +50,9 @@ class SpatialFabric {
   inline std::vector<T> nodes();
 
   template <typename T>
-  T* random(std::function<bool(T*)> condition) {
+  T* random(dsa::Rng& rng, std::function<bool(T*)> condition) {
     if (nodes<T*>().empty()) return nullptr;
-    T* res = nodes<T*>()[rand() % nodes<T*>().size()];
+    T* res = nodes<T*>()[rng.Below(nodes<T*>().size())];
     return f(res) ? res : nullptr;
   }
 
@@ -127,10 +79,6 @@ class SpatialFabric {
 
   void clear_all_runtime_vals();
 
-  const std::vector<sslink*>& link_list() { return _link_list; }
-
-  const std::vector<ssnode*>& node_list() { return _node_list; }
-
   std::vector<ssvport*> vport_list() { return node_filter<ssvport*>(); }
 
   std::vector<ssvport*> vlist_impl(bool is_input) {
@@ -148,7 +96,8 @@ class SpatialFabric {
   void add_output(int i, ssnode* n) { _io_map[false][i] = n; }
 
   ssfu* add_fu() {
-    auto* fu = new ssfu();
+    _fu_arena.emplace_back();
+    auto* fu = &_fu_arena.back();
     add_node(fu);  // id and stuff
     return fu;
   }
@@ -160,7 +109,8 @@ class SpatialFabric {
   }
 
   ssswitch* add_switch() {
-    auto* sw = new ssswitch();
+    _switch_arena.emplace_back();
+    auto* sw = &_switch_arena.back();
     add_node(sw);  // id and stuff
     return sw;
   }
@@ -172,7 +122,8 @@ class SpatialFabric {
   }
 
   ssvport* add_vport(bool is_input) {
-    auto vport = new ssvport();
+    _vport_arena.emplace_back();
+    auto* vport = &_vport_arena.back();
     add_node(vport);
     return vport;
   }
@@ -188,80 +139,53 @@ class SpatialFabric {
   }
 
   // Creates a copy of the datastructre which gaurantees ordering
-  // within the *_list datastructures (so they can be used for matching)
+  // within the *_list datastructures (so they can be used for matching).
+  // Nodes and links refer to each other by id, so the arenas are copied as they are,
+  // and only the id tables are rebuilt to point into the new arenas.
   SpatialFabric* copy() {
     SpatialFabric* copy_sub = new SpatialFabric();
 
     copy_sub->_sizex = _sizex;
     copy_sub->_sizey = _sizey;
-    copy_sub->_ssio_interf = _ssio_interf;
-
-    copy_sub->_node_list.resize(_node_list.size());
-    copy_sub->_link_list.resize(_link_list.size());
-
-    for (int i = 0, n = _node_list.size(); i < n; ++i) {
-      auto node = _node_list[i];
-      copy_sub->_node_list[i] = node->copy();
-    }
 
-    for (unsigned i = 0; i < _link_list.size(); ++i) {
-      auto* link = _link_list[i];
-      auto* copy_link = new sslink();
-      *copy_link = *link;
-      copy_sub->_link_list[i] = copy_link;
-
-      // make the links point to the new nodes
-      copy_link->_orig = copy_sub->_node_list[link->orig()->id()];
-      copy_link->_dest = copy_sub->_node_list[link->dest()->id()];
-    }
-
-    // make the nodes point to the new links
-    for (unsigned I = 0; I < _node_list.size(); ++I) {
-      auto* node = _node_list[I];
-      auto* copy_node = copy_sub->_node_list[I];
-      for (int j = 0; j < 2; ++j) {
-        for (unsigned i = 0; i < node->links[j].size(); ++i) {
-          sslink* link = node->links[j][i];
-          copy_node->links[j][i] = copy_sub->_link_list[link->id()];
+    copy_live(_fu_arena, copy_sub->_fu_arena);
+    copy_live(_switch_arena, copy_sub->_switch_arena);
+    copy_live(_vport_arena, copy_sub->_vport_arena);
+    copy_live(_link_arena, copy_sub->_link_arena);
+    copy_sub->_node_free = _node_free;
+    copy_sub->_link_free = _link_free;
+    copy_sub->reindex(_node_list.size(), _link_list.size());
+
+    for (int i = 0; i < 2; ++i) {
+      for (auto& elem : _ssio_interf.vports_map[i]) {
+        if (elem.second->id() != -1) {
+          copy_sub->_ssio_interf.vports_map[i][elem.first] =
+              static_cast<ssvport*>(copy_sub->_node_list[elem.second->id()]);
         }
       }
     }
+    copy_sub->_ssio_interf.fill_vec();
 
     return copy_sub;
   }
 
-  // Efficient bulk delete from vector based on indices (O(n))
-  template <typename T>
-  void bulk_vec_delete(std::vector<T>& vec, std::vector<int>& indices) {
-    indices.push_back(INT_MAX);
-    std::sort(indices.begin(), indices.end(), [](int x, int y) { return x < y; });
+  /*!
+   * \brief Delete nodes by id. The ids of the remaining nodes are untouched, and the
+   *        slots of the deleted ones are tombstoned. The deleted nodes stay in the arenas
+   *        with id -1, so that pointers to them are still safe to compare.
+   *        Links of the deleted nodes should be deleted before.
+   */
+  void delete_nodes(const std::vector<int>& v);
 
-    int ind = 0;
-    unsigned nindex = indices[ind];
-    int diff = 0;
+  /*! \brief Delete links by id, and unlink them from the connected nodes. */
+  void delete_links(const std::vector<int>& v);
 
-    for (unsigned i = 0; i < vec.size(); ++i) {
-      if (diff > 0) {
-        vec[i - diff] = vec[i];
-      }
-      if (i > nindex) {
-        nindex = indices[++ind];
-        diff++;
-      }
-    }
-
-    vec.resize(vec.size() - diff);
-  }
-
-  // These we can use the faster bulk vec delete
-  void delete_nodes(std::vector<int> v) {
-    vec_delete_by_id(_node_list, v);
-    fix_id(_node_list);
-  }
-  void delete_links(std::vector<int> v) {
-    vec_delete_by_id(_link_list, v);
-    fix_id(_link_list);
-  }
+  /*!
+   * \brief Squeeze the tombstones out by renumbering all the live nodes and links in
+   *        order of their ids.
+   * \return The old-to-new id tables of nodes and links, where -1 is a tombstone.
+   */
+  std::pair<std::vector<int>, std::vector<int>> compact();
 
   // External add link -- used by arch. search
   sslink* add_link(ssnode* src, ssnode* dst) {
@@ -272,41 +196,92 @@ class SpatialFabric {
       CHECK(!in->in_links().empty());
     }
 
-    sslink* link = src->add_link(dst);
-    link->set_id(_link_list.size());
-    _link_list.push_back(link);
+    return src->add_link(dst);
+  }
 
+  /*! \brief Allocate a link from src to dst in the link arena, and register it. */
+  sslink* new_link(ssnode* src, ssnode* dst) {
+    _link_arena.emplace_back(this, src->id(), dst->id());
+    auto* link = &_link_arena.back();
+    link->set_id(alloc_id(_link_list, _link_free));
+    _link_list[link->id()] = link;
     return link;
   }
 
+  virtual ~SpatialFabric() {}
+
+  void parse_json(std::string filename);
+
+  /*!
+   * \brief Construct the fabric from a binary ADG file, by mapping it into the memory.
+   * \param filename The file dumped by DumpHwInBinary.
+   * \param fu_types If not null, the FU types of the model dumped along are restored here.
+   */
+  void parse_binary(const std::string& filename, std::vector<Capability*>* fu_types = nullptr);
+  void post_process();
+
+ private:
   // add node
   void add_node(ssnode* n) {
-    n->set_id(_node_list.size());
+    n->set_id(alloc_id(_node_list, _node_free));
     n->parent = this;
-    _node_list.push_back(n);
+    _node_list[n->id()] = n;
   }
 
-  virtual ~SpatialFabric() {
-    for (sslink* l : _link_list) {
-      delete l;
+  /*! \brief Take a tombstoned id from the free list, or grow the table for a new one. */
+  template <typename T>
+  static int alloc_id(std::vector<T*>& table, std::vector<int>& free) {
+    if (free.empty()) {
+      table.push_back(nullptr);
+      return table.size() - 1;
     }
-    for (ssnode* n : _node_list) {
-      delete n;
+    int res = free.back();
+    free.pop_back();
+    return res;
+  }
+
+  /*! \brief Copy only the elements still alive, so that the tombstones do not pile up. */
+  template <typename T>
+  static void copy_live(const std::deque<T>& from, std::deque<T>& to) {
+    for (auto& elem : from) {
+      if (elem.id() != -1) {
+        to.push_back(elem);
+      }
     }
   }
-  void parse_json(std::string filename);
-  void post_process();
 
- private:
+  /*!
+   * \brief Rebuild the id tables from the arenas, and make the nodes and links in the
+   *        arenas point to this fabric. Elements with id -1 are deleted ones.
+   * \param num_nodes The number of node slots, including the tombstones.
+   * \param num_links The number of link slots, including the tombstones.
+   */
+  void reindex(int num_nodes, int num_links);
+
+  /*!
+   * \brief Renumber the nodes by an old-to-new id table, where -1 deletes the node.
+   *        The node ids held by the links are rewritten accordingly.
+   *        The resulting tables are dense.
+   */
+  void remap_nodes(const std::vector<int>& remap);
+
+  /*!
+   * \brief Renumber the links by an old-to-new id table, where -1 deletes the link.
+   *        The link ids held by the nodes are rewritten accordingly.
+   */
+  void remap_links(const std::vector<int>& remap);
+
   void build_substrate(int x, int y);
 
   void connect_substrate(int x, int y, PortType pt, int ips, int ops,
                          int temp_x, int temp_y, int temp_width, int temp_height);
 
-  // These are only valid after regroup_vecs()
-  std::vector<ssnode*> _node_list;
-  std::vector<ssfu*> _fu_list;
-  std::vector<sslink*> _link_list;
+  // The typed arenas owning all the nodes and links. Deques keep the addresses stable
+  // while the fabric grows, and the id tables in FabricIndex point into them.
+  std::deque<ssfu> _fu_arena;
+  std::deque<ssswitch> _switch_arena;
+  std::deque<ssvport> _vport_arena;
+  std::deque<sslink> _link_arena;
 
   // Temporary Datastructures, only for constructing the mapping
   int _sizex, _sizey;  // size of SS cgra
@@ -2,6 +2,7 @@
 
 #include <iostream>
 #include <map>
+#include <memory>
 #include <ostream>
 #include <set>
 #include <string>
@@ -42,13 +43,14 @@ class SSModel {
     return ind_memory;
   }
 
-  SSModel(const SSModel& m) {
+  SSModel(const SSModel& m) : filename(m.filename) {
     fu_types = m.fu_types;
     _subModel = m._subModel->copy();
     _dispatch_inorder = m._dispatch_inorder;
     _dispatch_width = m._dispatch_width;
     _maxEdgeDelay = m._maxEdgeDelay;
     ind_memory = m.ind_memory;
+    distances = m.distances;
   }
   const std::string filename;
 
@@ -67,6 +69,13 @@ class SSModel {
   int _maxEdgeDelay{15};
   int ind_memory{1};
 
+  /*!
+   * \brief If not null, the distances among the nodes of the fabric, computed once and
+   *        shared by the copies, instead of by each schedule. Whoever sets it should reset
+   *        it on changing the topology.
+   */
+  std::shared_ptr<const std::vector<std::vector<int>>> distances;
+
   void parse_exec(std::istream& istream);
 
 };
@@ -16,4 +16,19 @@ double pred_dedi_router_power(const double x1[5]);
 double pred_vport_area(const double x1[3]);
 double pred_vport_power(const double x1[3]);
 
+// Batched Function Declarations
+//  x1 holds n feature vectors back to back (n x 12 for pe_*, n x 9 for router_*, n x 5 for
+//  pred_dedi_router_*, n x 3 for pred_vport_*), and the n predictions are written to out.
+//  The results match the scalar functions above within PREDICT_BATCH_TOLERANCE (relative).
+#define PREDICT_BATCH_TOLERANCE 1e-9
+
+void pe_area_predict_batch(const double *x1, int n, double *out);
+void pe_power_predict_batch(const double *x1, int n, double *out);
+void router_area_predict_batch(const double *x1, int n, double *out);
+void router_power_predict_batch(const double *x1, int n, double *out);
+void pred_dedi_router_area_batch(const double *x1, int n, double *out);
+void pred_dedi_router_power_batch(const double *x1, int n, double *out);
+void pred_vport_area_batch(const double *x1, int n, double *out);
+void pred_vport_power_batch(const double *x1, int n, double *out);
+
 #endif
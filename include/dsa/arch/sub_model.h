@@ -13,6 +13,7 @@
 #include <functional>
 
 #include "dsa/debug.h"
+#include "dsa/json_writer.h"
 #include "fu_model.h"
 #include "predict.h"
 #include "json/visitor.h"
@@ -37,6 +38,7 @@ using std::to_string;
 const int MAX_SUBNETS = 8;
 
 class ssnode;
+class sslink;
 class ssvport;
 
 template <typename T>
@@ -48,23 +50,75 @@ T get_prop_attr(plain::Object& prop, const std::string& name, T dft) {
     return dft;
 }
 
-template <typename T>
-void fix_id(std::vector<T>& vec) {
-  for (int i = 0, n = vec.size(); i < n; ++i) {
-    vec[i]->set_id(i);
-  }
-}
+/*!
+ * \brief The id-indexed tables of a fabric. Nodes and links never point to each other
+ *        directly; they hold ids, and resolve them through the tables of their owner.
+ *        Ids are stable: a deleted element leaves a nullptr tombstone in its slot, and
+ *        the slot is recycled by the next element added.
+ */
+class FabricIndex {
+ public:
+  /*! \brief The links indexed by id. Deleted slots are nullptr. */
+  const std::vector<sslink*>& link_list() const { return _link_list; }
 
-template <typename T>
-void vec_delete_by_id(std::vector<T>& vec, std::vector<int>& indices) {
-  auto new_end = std::remove_if(vec.begin(), vec.end(), [&](T fu) {
-    for (int index : indices) {
-      if (fu->id() == index) return true;
+  /*! \brief The nodes indexed by id. Deleted slots are nullptr. */
+  const std::vector<ssnode*>& node_list() const { return _node_list; }
+
+  /*! \brief The number of live nodes. */
+  int num_nodes() const { return _node_list.size() - _node_free.size(); }
+
+  /*! \brief The number of live links. */
+  int num_links() const { return _link_list.size() - _link_free.size(); }
+
+  /*! \brief If there is no tombstone, so that the ids are dense. */
+  bool is_compact() const { return _node_free.empty() && _link_free.empty(); }
+
+ protected:
+  /*! \brief The nodes indexed by id, pointing into the arenas of the fabric. */
+  std::vector<ssnode*> _node_list;
+  /*! \brief The links indexed by id, pointing into the arena of the fabric. */
+  std::vector<sslink*> _link_list;
+  /*! \brief The tombstoned node ids to be recycled. */
+  std::vector<int> _node_free;
+  /*! \brief The tombstoned link ids to be recycled. */
+  std::vector<int> _link_free;
+};
+
+/*! \brief A read-only view of a list of link ids, which yields the links themselves. */
+class LinkView {
+ public:
+  class iterator {
+   public:
+    iterator(const int* ptr, const FabricIndex* index) : ptr(ptr), index(index) {}
+    sslink* const& operator*() const { return index->link_list()[*ptr]; }
+    iterator& operator++() {
+      ++ptr;
+      return *this;
     }
-    return false;
-  });
-  vec.erase(new_end, vec.end());
-}
+    bool operator==(const iterator& other) const { return ptr == other.ptr; }
+    bool operator!=(const iterator& other) const { return ptr != other.ptr; }
+
+   private:
+    const int* ptr;
+    const FabricIndex* index;
+  };
+
+  LinkView(const std::vector<int>& ids, const FabricIndex* index) : _ids(ids), _index(index) {}
+
+  iterator begin() const { return iterator(_ids.data(), _index); }
+  iterator end() const { return iterator(_ids.data() + _ids.size(), _index); }
+  size_t size() const { return _ids.size(); }
+  bool empty() const { return _ids.empty(); }
+  sslink* operator[](int i) const { return _index->link_list()[_ids[i]]; }
+  sslink* front() const { return (*this)[0]; }
+  sslink* back() const { return (*this)[_ids.size() - 1]; }
+  /*! \brief The ids of the links viewed. */
+  const std::vector<int>& ids() const { return _ids; }
+
+ private:
+  const std::vector<int>& _ids;
+  const FabricIndex* _index;
+};
 
 // TODO: Should we delete this class?
 class ssio_interface {
@@ -90,18 +144,12 @@ class sslink {
  public:
   sslink() {}
 
-  ~sslink();
+  ssnode* orig() const { return parent->node_list()[_orig]; }
 
-  ssnode* orig() const { return _orig; }
-
-  ssnode* dest() const { return _dest; }
+  ssnode* dest() const { return parent->node_list()[_dest]; }
 
   // Constructor
-  sslink(ssnode* orig, ssnode* dest) {
-    _orig = orig;
-    _dest = dest;
-    _ID = -1;
-  }
+  sslink(FabricIndex* parent, int orig, int dest) : parent(parent), _orig(orig), _dest(dest) {}
 
   std::string name() const;
 
@@ -174,8 +222,10 @@ class sslink {
   int _bitwidth = 64;         // bitwidth of link
   int _decomp_bitwidth = 8;   // minimum bitwidth the link may be decomposed into
 
-  ssnode* _orig;
-  ssnode* _dest;
+  // The owner fabric, and the ids of the connected nodes
+  FabricIndex* parent{nullptr};
+  int _orig{-1};
+  int _dest{-1};
 
  private:
   friend class SpatialFabric;
@@ -187,9 +237,6 @@ class ssnode {
 
   ssnode() {}
 
-  // TODO(@were): Deprecate this in the visitor pattern.
-  virtual ssnode* copy() = 0;
-
   virtual void Accept(adg::Visitor *visitor) = 0;
 
   sslink* add_link(ssnode* node);
@@ -208,15 +255,15 @@ class ssnode {
 
   int y() const { return _y; }
 
-  const std::vector<sslink*>& in_links() { return links[1]; }
+  LinkView in_links() const { return LinkView(links[1], parent); }
 
-  const std::vector<sslink*>& out_links() { return links[0]; }
+  LinkView out_links() const { return LinkView(links[0], parent); }
 
   virtual bool is_hanger() { return false; }
 
   std::string nodeType() { return node_type; }
 
-  int id() { return _ID; }
+  int id() const { return _ID; }
 
   void set_ssnode_prop(plain::Object &prop) {
     node_type = *prop["nodeType"] -> As<std::string>();
@@ -231,8 +278,9 @@ class ssnode {
   }
 
   void set_id(int id) { _ID = id; }
-  virtual void dumpIdentifier(ostream& os) = 0;
-  virtual void dumpFeatures(ostream& os) = 0;
+  /*! \brief Dump [id, type], by which the node is referred in the hardware JSON. */
+  virtual void dumpIdentifier(JSONWriter& w) = 0;
+  virtual void dumpFeatures(JSONWriter& w) = 0;
   virtual uint64_t get_config_bits() = 0;
 
   int node_dist(int slot) { return _node_dist[slot]; }
@@ -278,8 +326,28 @@ class ssnode {
   int data_width{64};
 
  protected:
+  /*! \brief Dump the features shared by all kinds of nodes, as fields of an object. */
+  void dumpCommonFeatures(JSONWriter& w) {
+    w.Field("data_width", data_width);
+    w.Field("granularity", granularity);
+    w.Field("num_input", (int)in_links().size());
+    w.Field("num_output", (int)out_links().size());
+    w.Field("flow_control", flow_control());
+    w.Field("max_util", max_util());
+    w.Key("input_nodes").BeginArray();
+    for (auto in_link : in_links()) {
+      in_link->orig()->dumpIdentifier(w);
+    }
+    w.EndArray();
+    w.Key("output_nodes").BeginArray();
+    for (auto out_link : out_links()) {
+      out_link->dest()->dumpIdentifier(w);
+    }
+    w.EndArray();
+  }
+
   std::string node_type = "empty";
-  SpatialFabric *parent{nullptr};
+  FabricIndex *parent{nullptr};
   int num_node();
   int _ID = -1;
   int _x = -1, _y = -1;  // just for visualization
@@ -288,7 +356,7 @@ class ssnode {
   bool _flow_control = true;  // convert from "flow_control"
   int _bitwidth = 64;         // maximum bitwidth of PE, convert from "bit_width"
 
-  std::vector<sslink*> links[2];  // {output, input}
+  std::vector<int> links[2];  // ids of {output, input}
 
   // Variables used for scheduling -- these should be moved out at some point (TODO)
   int _node_dist[8];
@@ -309,12 +377,6 @@ class ssswitch : public ssnode {
 
   void Accept(adg::Visitor *visitor) override;
 
-  ssnode* copy() override {
-    auto res = new ssswitch();
-    *res = *this;
-    return res;
-  }
-
   int delay_fifo_depth() override { return max_fifo_depth; }
 
   virtual std::string name() const override {
@@ -327,55 +389,15 @@ class ssswitch : public ssnode {
     }
     return ss.str();
   }
-  void dumpIdentifier(ostream& os) override {
-    os << "[" + to_string(_ID) + ",\"switch\"" + "]";
-  }
-  void dumpFeatures(ostream& os) override {
-    os << "{\n";
-    // ID
-    os << "\"id\" : " << id() << ",\n";
-    // NodeType
-    os << "\"nodeType\" : "
-       << "\"switch\""
-       << ",\n";
-    // data width
-    os << "\"data_width\" : " << data_width << ",\n";
-    // granularity
-    os << "\"granularity\" : " << granularity << ",\n";
-    // number of input
-    int num_input = in_links().size();
-    os << "\"num_input\" : " << num_input << ",\n";
-    // number of output
-    int num_output = out_links().size();
-    os << "\"num_output\" : " << num_output << ",\n";
-    // flow control
-    os << "\"flow_control\" : " << (flow_control() ? "true" : "false") << ",\n";
-    // max util
-    os << "\"max_util\" : " << max_util() << ",\n";
-    // input nodes
-    os << "\"input_nodes\" : [";
-    int idx_link = 0;
-    for (auto in_link : in_links()) {
-      in_link->orig()->dumpIdentifier(os);
-      if (idx_link < num_input - 1) {
-        idx_link++;
-        os << ", ";
-      }
-    }
-    os << "],\n";
-    // output nodes
-    os << "\"output_nodes\" : [";
-    idx_link = 0;
-    for (auto out_link : out_links()) {
-      out_link->dest()->dumpIdentifier(os);
-      if (idx_link < num_output - 1) {
-        idx_link++;
-        os << ", ";
-      }
-    }
-    os << "]";
-
-    os << "}\n";
+  void dumpIdentifier(JSONWriter& w) override {
+    w.BeginArray().Value(_ID).Value("switch").EndArray();
+  }
+  void dumpFeatures(JSONWriter& w) override {
+    w.BeginObject();
+    w.Field("id", id());
+    w.Field("nodeType", "switch");
+    dumpCommonFeatures(w);
+    w.EndObject();
   }
 
   void set_prop(plain::Object & prop) {
@@ -384,7 +406,7 @@ class ssswitch : public ssnode {
     max_fifo_depth = get_prop_attr(prop, "max_delay_fifo_depth", static_cast<int64_t>(max_fifo_depth));
   }
 
-  void collect_features() {
+  double* collect_features() {
     if (decomposer == 0) decomposer = mf_decomposer;
     features[0] = _max_util > 1 ? 0.0 : 1.0;
     features[1] = _max_util > 1 ? 1.0 : 0.0;
@@ -404,6 +426,8 @@ class ssswitch : public ssnode {
     features[6] = links[1].size();
     features[7] = links[0].size();
     features[8] = _max_util;
+
+    return features;
   }
 
   virtual ~ssswitch(){};
@@ -484,18 +508,14 @@ class ssswitch : public ssnode {
   //       output1 receive input4
   //       output3 receive input1
   // for those output port not mapped, they are connect to ground
+ private:
+  friend class SpatialFabric;
 };
 
 class ssfu : public ssnode {
  public:
   ssfu() : ssnode() {}
 
-  ssnode* copy() override {
-    auto res = new ssfu();
-    *res = *this;
-    return res;
-  }
-
   void Accept(adg::Visitor *visitor);
   void set_prop(plain::Object & prop) {
 
@@ -510,71 +530,23 @@ class ssfu : public ssnode {
     register_file_size = get_prop_attr(prop, "register_file_size", static_cast<int64_t>(register_file_size));
   }
 
-  void dumpIdentifier(ostream& os) override {
-    os << "[" + to_string(_ID) + ",\"function unit\"" + "]";
-  }
-
-  void dumpFeatures(ostream& os) override {
-    os << "{\n";
-    // ID
-    os << "\"id\" : " << id() << ",\n";
-    // NodeType
-    os << "\"nodeType\" : "
-       << "\"function unit\""
-       << ",\n";
-    // data width
-    os << "\"data_width\" : " << data_width << ",\n";
-    // granularity
-    os << "\"granularity\" : " << granularity << ",\n";
-    // number of input
-    int num_input = in_links().size();
-    os << "\"num_input\" : " << num_input << ",\n";
-    // number of output
-    int num_output = out_links().size();
-    os << "\"num_output\" : " << num_output << ",\n";
-    // flow control
-    os << "\"flow_control\" : " << (flow_control() ? "true" : "false") << ",\n";
-    // max util
-    os << "\"max_util\" : " << max_util() << ",\n";
-    // max delay fifo depth
-    os << "\"max_delay_fifo_depth\" : " << _delay_fifo_depth << ",\n";
-    // number of register
-    os << "\"num_register\" : " << register_file_size << ",\n";
-    // Instructions
-    os << "\"instructions\" : [";
-    int idx_inst = 0;
-    int num_inst = fu_type_.capability.size();
+  void dumpIdentifier(JSONWriter& w) override {
+    w.BeginArray().Value(_ID).Value("function unit").EndArray();
+  }
+
+  void dumpFeatures(JSONWriter& w) override {
+    w.BeginObject();
+    w.Field("id", id());
+    w.Field("nodeType", "function unit");
+    w.Field("max_delay_fifo_depth", _delay_fifo_depth);
+    w.Field("num_register", register_file_size);
+    w.Key("instructions").BeginArray();
     for (auto &elem : fu_type_.capability) {
-      os << "\"" << dsa::name_of_inst(elem.op) << "\"";
-      if (idx_inst < num_inst - 1) {
-        os << ", ";
-        idx_inst++;
-      }
+      w.Value(dsa::name_of_inst(elem.op));
     }
-    os << "],\n";
-    // input nodes
-    os << "\"input_nodes\" : [";
-    int idx_link = 0;
-    for (auto in_link : in_links()) {
-      in_link->orig()->dumpIdentifier(os);
-      if (idx_link < num_input - 1) {
-        idx_link++;
-        os << ", ";
-      }
-    }
-    os << "],\n";
-    // output nodes
-    os << "\"output_nodes\" : [";
-    idx_link = 0;
-    for (auto out_link : out_links()) {
-      out_link->dest()->dumpIdentifier(os);
-      if (idx_link < num_output - 1) {
-        idx_link++;
-        os << ", ";
-      }
-    }
-    os << "]";
-    os << "}\n";
+    w.EndArray();
+    dumpCommonFeatures(w);
+    w.EndObject();
   }
 
   std::string name() const override {
@@ -599,6 +571,9 @@ class ssfu : public ssnode {
     features[3] = _flow_control ? 1.0 : 0.0;
     assert((features[2] || features[3]) &&
            "Either Data(Static) or DataValidReady(Dynamic)");
+    // Output mode is not modeled yet, so always individual.
+    features[4] = 1.0;
+    features[5] = 0.0;
     features[6] = decomposer;
     if (decomposer == 0 && (decomposer & (decomposer - 1))) {
       std::cout << "Problem: Decomposer for node " << name() << " is: " << decomposer
@@ -732,12 +707,6 @@ class ssfu : public ssnode {
 // This should be improved later
 class ssvport : public ssnode {
  public:
-  ssnode* copy() override {
-    auto res = new ssvport();
-    *res = *this;
-    return res;
-  }
-
   void Accept(adg::Visitor *vistor);
 
   std::vector<int>& port_vec() { return _port_vec; }
@@ -757,65 +726,23 @@ class ssvport : public ssnode {
     return ss.str();
   }
 
-  void dumpIdentifier(ostream& os) override {
-    os << "[" + std::to_string(_ID) + ",\"vector port\"" + "]";
-  }
-  void dumpFeatures(ostream& os) override {
-    os << "{\n";
-    // ID
-    os << "\"id\" : " << id() << ",\n";
-    // # Port
-    os << "\"port\" : " << port() << ",\n";
-    // NodeType
-    os << "\"nodeType\" : "
-       << "\"vector port\""
-       << ",\n";
-    // data width
-    os << "\"data_width\" : " << data_width << ",\n";
-    // granularity
-    os << "\"granularity\" : " << granularity << ",\n";
-    // number of input
-    int num_input = in_links().size();
-    os << "\"num_input\" : " << num_input << ",\n";
-    // number of output
-    int num_output = out_links().size();
-    os << "\"num_output\" : " << num_output << ",\n";
-    // flow control
-    os << "\"flow_control\" : " << (flow_control() ? "true" : "false") << ",\n";
-    // max util
-    os << "\"max_util\" : " << max_util() << ",\n";
-    // input nodes
-    os << "\"input_nodes\" : [";
-    int idx_link = 0;
-    for (auto in_link : in_links()) {
-      in_link->orig()->dumpIdentifier(os);
-      if (idx_link < num_input - 1) {
-        idx_link++;
-        os << ", ";
-      }
-    }
-    os << "],\n";
-    // output nodes
-    os << "\"output_nodes\" : [";
-    idx_link = 0;
-    for (auto out_link : out_links()) {
-      out_link->dest()->dumpIdentifier(os);
-      if (idx_link < num_output - 1) {
-        idx_link++;
-        os << ", ";
-      }
-    }
-    os << "]";
-    os << "}\n";
+  void dumpIdentifier(JSONWriter& w) override {
+    w.BeginArray().Value(_ID).Value("vector port").EndArray();
+  }
+  void dumpFeatures(JSONWriter& w) override {
+    w.BeginObject();
+    w.Field("id", id());
+    w.Field("port", port());
+    w.Field("nodeType", "vector port");
+    dumpCommonFeatures(w);
+    w.EndObject();
   }
 
   int bitwidth_capability() {
     int res = 0;
     CHECK((int) links[0].empty() + (int) links[1].empty() == 1);
-    for (auto &elem : links) {
-      for (auto link : elem) {
-        res += link->bitwidth();
-      }
+    for (auto link : links[0].empty() ? in_links() : out_links()) {
+      res += link->bitwidth();
     }
     return res;
   }
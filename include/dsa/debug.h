@@ -1,11 +1,234 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <mutex>
 #include <string>
 #include <utility>
+#include <vector>
+
+/*!
+ * \brief The categories of LOG and TRACE, and their levels: 1 for a message per run or per
+ *        pass, 2 per node or edge of a pass, and 3 inside the loops of the search and the
+ *        simulation.
+ */
+#define DSA_LOG_CATEGORIES(X) \
+  X(CACHE, 1)                 \
+  X(CAND, 1)                  \
+  X(COUNT, 1)                 \
+  X(ESTIMATION, 1)            \
+  X(EVAL, 1)                  \
+  X(MAPPING, 1)               \
+  X(PA, 1)                    \
+  X(PA_MODEL, 1)              \
+  X(PARSE, 1)                 \
+  X(ROUTING, 1)               \
+  X(COLLECT, 2)               \
+  X(COMP, 2)                  \
+  X(CREEP, 2)                 \
+  X(EDGES, 2)                 \
+  X(PASSTHRU, 2)              \
+  X(SLICE, 2)                 \
+  X(STR, 2)                   \
+  X(SUBNET, 2)                \
+  X(FORWARD, 3)               \
+  X(LAT, 3)                   \
+  X(LAT_PASS, 3)              \
+  X(MAP, 3)                   \
+  X(PRED, 3)                  \
+  X(ROUTE, 3)                 \
+  X(SIM, 3)                   \
+  X(SLOTS, 3)
+
+/*!
+ * \brief The categories above this level are compiled out. Unless the build defines it,
+ *        debug builds keep all of them, and the others none.
+ */
+#ifndef DSA_LOG_LEVEL
+#ifdef DEBUG_MODE
+#define DSA_LOG_LEVEL 3
+#else
+#define DSA_LOG_LEVEL 0
+#endif
+#endif
+
+/*!
+ * \brief If TRACE is compiled in. It does not follow the log level, since a disabled
+ *        TRACE costs a load and a branch, and the rings are wanted the most in the
+ *        release builds, where the logs are compiled out.
+ */
+#ifndef DSA_TRACE_ENABLED
+#define DSA_TRACE_ENABLED 1
+#endif
+
+namespace dsa {
+namespace logging {
+
+enum class Category : int {
+#define DSA_LOG_ENUM(S, LEVEL) S,
+  DSA_LOG_CATEGORIES(DSA_LOG_ENUM)
+#undef DSA_LOG_ENUM
+  NumCategories
+};
+static_assert((int)Category::NumCategories <= 64, "The categories should fit a bitmask");
+
+constexpr int kLevels[] = {
+#define DSA_LOG_LEVEL_OF(S, LEVEL) LEVEL,
+    DSA_LOG_CATEGORIES(DSA_LOG_LEVEL_OF)
+#undef DSA_LOG_LEVEL_OF
+};
+
+constexpr const char* kNames[] = {
+#define DSA_LOG_NAME_OF(S, LEVEL) #S,
+    DSA_LOG_CATEGORIES(DSA_LOG_NAME_OF)
+#undef DSA_LOG_NAME_OF
+};
+
+/*! \brief Parse the categories separated by commas, or "all", to a bitmask. */
+inline uint64_t ParseMask(const char* spec) {
+  uint64_t res = 0;
+  if (!spec) return res;
+  std::string s(spec);
+  for (size_t begin = 0, end; begin <= s.size(); begin = end + 1) {
+    end = std::min(s.find(',', begin), s.size());
+    std::string name = s.substr(begin, end - begin);
+    for (int i = 0; i < (int)Category::NumCategories; ++i) {
+      if (name == "all" || name == kNames[i]) res |= 1ull << i;
+    }
+  }
+  return res;
+}
+
+/*!
+ * \brief The categories LOG prints, parsed once from the environment: those listed in
+ *        DSA_LOG, and, as before, those whose names are set as environment variables.
+ */
+inline uint64_t& LogMask() {
+  static uint64_t mask = []() {
+    uint64_t res = ParseMask(getenv("DSA_LOG"));
+    for (int i = 0; i < (int)Category::NumCategories; ++i) {
+      if (getenv(kNames[i])) res |= 1ull << i;
+    }
+    return res;
+  }();
+  return mask;
+}
+
+/*! \brief The categories TRACE records, parsed once from DSA_TRACE. */
+inline uint64_t& TraceMask() {
+  static uint64_t mask = ParseMask(getenv("DSA_TRACE"));
+  return mask;
+}
+
+/*! \brief A TRACE statement in the source, which is what an event refers to. */
+struct Site {
+  const char* category;
+  const char* file;
+  int line;
+  /*! \brief What the arguments are. */
+  const char* what;
+};
+
+/*!
+ * \brief The latest events recorded by a thread. Only the owner thread writes it, so
+ *        recording is a few stores without locks. A dump reads the rings of the other
+ *        threads as they are, which is good enough for a post-mortem.
+ */
+class TraceRing {
+ public:
+  static const int kSize = 1024;
+
+  struct Event {
+    const Site* site;
+    int64_t args[3];
+  };
+
+  TraceRing();
+  ~TraceRing();
+
+  void Push(const Site* site, int64_t a, int64_t b = 0, int64_t c = 0) {
+    uint64_t h = head.load(std::memory_order_relaxed);
+    Event& event = events[h & (kSize - 1)];
+    event.site = site;
+    event.args[0] = a;
+    event.args[1] = b;
+    event.args[2] = c;
+    head.store(h + 1, std::memory_order_release);
+  }
+
+  /*! \brief Print the events kept, the oldest first. */
+  void Dump(std::ostream& os) const {
+    uint64_t h = head.load(std::memory_order_acquire);
+    uint64_t n = std::min<uint64_t>(h, kSize);
+    os << "[TRACE] thread " << tid << ", the last " << n << " of " << h << " event(s)\n";
+    for (uint64_t i = h - n; i < h; ++i) {
+      const Event& event = events[i & (kSize - 1)];
+      const char* file = strrchr(event.site->file, '/');
+      os << "  " << event.site->category << " " << (file ? file + 1 : event.site->file) << ":"
+         << event.site->line << " " << event.site->what << ": " << event.args[0] << " "
+         << event.args[1] << " " << event.args[2] << "\n";
+    }
+  }
+
+ private:
+  int tid;
+  std::atomic<uint64_t> head{0};
+  Event events[kSize];
+};
+
+/*! \brief The rings of the live threads. */
+struct TraceRegistry {
+  std::mutex lock;
+  std::vector<TraceRing*> rings;
+  int num_threads{0};
+};
+
+inline TraceRegistry& Registry() {
+  static TraceRegistry registry;
+  return registry;
+}
+
+inline TraceRing::TraceRing() {
+  auto& registry = Registry();
+  std::lock_guard<std::mutex> guard(registry.lock);
+  tid = registry.num_threads++;
+  registry.rings.push_back(this);
+}
+
+inline TraceRing::~TraceRing() {
+  auto& registry = Registry();
+  std::lock_guard<std::mutex> guard(registry.lock);
+  for (size_t i = 0; i < registry.rings.size(); ++i) {
+    if (registry.rings[i] == this) {
+      registry.rings.erase(registry.rings.begin() + i);
+      break;
+    }
+  }
+}
+
+/*! \brief The ring of this thread, allocated when the thread first traces. */
+inline TraceRing& ThisRing() {
+  thread_local TraceRing ring;
+  return ring;
+}
+
+/*! \brief Print the rings of all the threads. CHECK does this before aborting. */
+inline void DumpTrace(std::ostream& os) {
+  auto& registry = Registry();
+  std::lock_guard<std::mutex> guard(registry.lock);
+  for (auto ring : registry.rings) {
+    ring->Dump(os);
+  }
+}
+
+}  // namespace logging
+}  // namespace dsa
 
 class LOGGER {
 
@@ -19,6 +242,9 @@ class LOGGER {
   ~LOGGER() noexcept(false) {
     std::cerr << std::endl;
     if (abort) {
+      if (dsa::logging::TraceMask()) {
+        dsa::logging::DumpTrace(std::cerr);
+      }
       // TODO(@were): This is great for debugging backtrace but confuses user when reading the logs.
       throw;
     }
@@ -34,11 +260,30 @@ class LOGGER {
 #define CHECK(COND) \
   if (!(COND)) LOGGER("[CHECK FAIL]", __FILE__, __LINE__, true) << #COND << " "
 
-#ifdef DEBUG_MODE
-#define LOG(S) if (getenv(#S)) LOGGER("[DEBUG]", __FILE__, __LINE__, false)
-#else
-#define LOG(S) if (false) LOGGER("[DEBUG]", __FILE__, __LINE__, false)
-#endif
+/*! \brief If a category is compiled in. It is a constant, so the dead sites are dropped. */
+#define DSA_LOG_COMPILED(S) \
+  (::dsa::logging::kLevels[(int)::dsa::logging::Category::S] <= DSA_LOG_LEVEL)
+
+#define DSA_LOG_BIT(S) (1ull << (int)::dsa::logging::Category::S)
+
+#define LOG(S)                                                            \
+  if (DSA_LOG_COMPILED(S) && (::dsa::logging::LogMask() & DSA_LOG_BIT(S))) \
+  LOGGER("[DEBUG]", __FILE__, __LINE__, false)
+
+/*!
+ * \brief Record an event of up to three integers to the ring of this thread, if the
+ *        category is on in DSA_TRACE. Unlike LOG, nothing is formatted, so it is cheap
+ *        enough to leave on, and the rings are printed when a CHECK fails. It is compiled
+ *        in unless DSA_TRACE_ENABLED is 0, whatever DSA_LOG_LEVEL is.
+ *        For example, TRACE(ROUTE, "edge node", edge->id, node->id()).
+ */
+#define TRACE(S, WHAT, ...)                                                           \
+  do {                                                                                \
+    if (DSA_TRACE_ENABLED && (::dsa::logging::TraceMask() & DSA_LOG_BIT(S))) {        \
+      static const ::dsa::logging::Site dsa_trace_site{#S, __FILE__, __LINE__, WHAT}; \
+      ::dsa::logging::ThisRing().Push(&dsa_trace_site, __VA_ARGS__);                  \
+    }                                                                                 \
+  } while (false)
 
 #define ENFORCED_SYSTEM(CMD)                    \
   if (int ret = system(CMD))                    \
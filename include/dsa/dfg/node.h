@@ -1,7 +1,5 @@
 #pragma once
 
-#include <queue>
-
 #include "dsa/debug.h"
 #include "dsa/simulation/data.h"
 #include "dsa/dfg/metadata.h"
@@ -38,7 +36,14 @@ struct Value {
   SSDfgNode* node() const;
 
   // @{
-  std::queue<dsa::simulation::Data> fifo;
+  /*!
+   * \brief The depth of the FIFO. The producers only push to an empty FIFO, see
+   *        SSDfgInst::forward and SSDfgVecInput::can_push, so one entry is in use at a time.
+   */
+  static constexpr int kFifoDepth = 2;
+  /*! \brief The FIFO of the tokens not forwarded yet, allocated in the DFG on the first use. */
+  simulation::Fifo fifo();
+  int fifo_id{-1};
   void push(uint64_t value, bool valid, int delay);
   bool forward(bool attempt);
   // @}
@@ -80,7 +85,9 @@ struct Operand {
   // @{
   bool valid();
 
-  std::vector<std::queue<simulation::Data>> fifos;
+  /*! \brief The operand buffer of the i-th edge, allocated in the DFG on the first use. */
+  simulation::Fifo fifo(int i);
+  std::vector<int> fifo_ids;
 
   bool ready();
 
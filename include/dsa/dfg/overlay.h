@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "dsa/dfg/ssdfg.h"
+
+namespace dsa {
+namespace dfg {
+
+/*! \brief A read-only range of edge ids. */
+struct EdgeRange {
+  const int *b, *e;
+  const int* begin() const { return b; }
+  const int* end() const { return e; }
+  int size() const { return e - b; }
+};
+
+/*!
+ * \brief A view of a DFG with passthrough noops injected, without copying the DFG.
+ *        The base DFG is not modified. The noops and their input edges are numbered
+ *        after the nodes and the edges of the base, just as they would be if they were
+ *        appended to a copy of the base, so the id-indexed tables of the passes work
+ *        on both. The ranges returned are invalidated by InjectNoop.
+ */
+class DfgOverlay {
+ public:
+  explicit DfgOverlay(SSDfg* base);
+
+  /*!
+   * \brief Route an edge through a noop.
+   *        before: def -[eid]-> use
+   *        after:  def -[new edge]-> noop -[eid]-> use
+   *        If an existing noop is given, the edge is redirected to it instead, and no
+   *        edge is created.
+   * \param eid The edge to route.
+   * \param noop The id of an existing noop, or -1 to create one.
+   * \return The id of the noop.
+   */
+  int InjectNoop(int eid, int noop = -1);
+
+  /*! \brief Copy the base DFG with the noops injected. */
+  SSDfg* Materialize() const;
+
+  SSDfg* base() const { return _base; }
+
+  int num_nodes() const { return _num_base_nodes + _noop_in.size(); }
+
+  int num_edges() const { return _ends.size(); }
+
+  bool is_noop(int nid) const { return nid >= _num_base_nodes; }
+
+  /*! \brief The node in the base DFG, or nullptr for a noop. */
+  SSDfgNode* node(int nid) const { return is_noop(nid) ? nullptr : _base->nodes[nid]; }
+
+  /*! \brief The source node of an edge. */
+  int src(int eid) const { return _ends[eid].sid; }
+
+  /*! \brief The consumer node of an edge. */
+  int dst(int eid) const { return _ends[eid].uid; }
+
+  /*! \brief The edges of all the operands of a node, in order. */
+  EdgeRange in_edges(int nid) const {
+    if (is_noop(nid)) {
+      const int* p = &_noop_in[nid - _num_base_nodes];
+      return {p, p + 1};
+    }
+    return {_in_edges.data() + _in_offset[nid], _in_edges.data() + _in_offset[nid + 1]};
+  }
+
+  int num_values(int nid) const { return is_noop(nid) ? 1 : _base->nodes[nid]->values.size(); }
+
+  /*! \brief The out-going edges of a value. */
+  EdgeRange uses(int nid, int vid) const {
+    const std::vector<int>* res;
+    if (is_noop(nid)) {
+      res = &_noop_uses[nid - _num_base_nodes];
+    } else {
+      auto iter = _uses.find(ValueKey(nid, vid));
+      res = iter == _uses.end() ? &_base->nodes[nid]->values[vid].uses : &iter->second;
+    }
+    return {res->data(), res->data() + res->size()};
+  }
+
+  int lat_of_inst(int nid) const {
+    return is_noop(nid) ? inst_lat(SS_NONE) : _base->nodes[nid]->lat_of_inst();
+  }
+
+  /*! \brief As a noop appended to the DFG, a noop belongs to the last sub-DFG. */
+  int group_id(int nid) const {
+    return is_noop(nid) ? _base->num_groups() - 1 : _base->nodes[nid]->group_id();
+  }
+
+  bool is_temporal(int nid) const { return _base->group_prop(group_id(nid)).is_temporal; }
+
+  /*! \brief For debug. The text representative of a node. */
+  std::string name(int nid) const;
+
+  /*! \brief For debug. The text representative of an edge. */
+  std::string edge_name(int eid) const;
+
+ private:
+  struct Ends {
+    int sid, vid, uid;
+  };
+
+  static int64_t ValueKey(int nid, int vid) { return (int64_t) nid << 32 | vid; }
+
+  /*! \brief The uses of a value to modify, copied from the base on the first write. */
+  std::vector<int>& mutable_uses(int nid, int vid);
+
+  SSDfg* _base;
+  int _num_base_nodes;
+  /*! \brief The operand edges of the base nodes, in the compressed sparse row format. */
+  std::vector<int> _in_offset, _in_edges;
+  /*! \brief The endpoints of all the edges, redirected by the injections. */
+  std::vector<Ends> _ends;
+  /*! \brief The base edge a new edge is sliced like. */
+  std::vector<int> _origin;
+  /*! \brief The uses of the base values modified by the injections. */
+  std::unordered_map<int64_t, std::vector<int>> _uses;
+  /*! \brief The input edge, and the uses of each noop. */
+  std::vector<int> _noop_in;
+  std::vector<std::vector<int>> _noop_uses;
+  /*! \brief The injections in order, as pairs of the edge and the noop, to materialize. */
+  std::vector<std::pair<int, int>> _log;
+};
+
+}  // namespace dfg
+}  // namespace dsa
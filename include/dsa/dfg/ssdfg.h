@@ -388,6 +388,9 @@ class SSDfg {
 
   uint64_t cur_cycle() { return _cur_cycle; }
 
+  /*! \brief The FIFOs of the values and the operands in simulation. */
+  dsa::simulation::FifoArena& fifo_arena() { return _fifos; }
+
   /*! \brief The instances of the instructions. */
   std::vector<SSDfgInst> instructions;
   /*! \brief The instances of the vector inputs. */
@@ -404,6 +407,7 @@ class SSDfg {
   // TODO(@were): These are for simulation. Move them out later!
   uint64_t _cur_cycle = 0;
   int dyn_issued[2] = {0, 0};
+  dsa::simulation::FifoArena _fifos;
   // @}
 
   void normalize();
@@ -427,4 +431,5 @@ inline T &SSDfg::emplace_back(Args&&... args) {
   if (vec.capacity() != capacity) {
     normalize();
   }
+  return vec.back();
 }
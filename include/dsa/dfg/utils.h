@@ -10,19 +10,37 @@ namespace dfg {
 
 /*!
  * \brief Dump the DFG in json format for simulation.
+ *        A filename ending with ".dfg.bin" is dumped by ExportBinary instead.
  * \param dfg The DFG to dump.
  * \param fname The json filename.
+ * \param compact If the edges are dumped as tuples instead of keyed objects.
  */
-void Export(SSDfg *dfg, const std::string &fname);
+void Export(SSDfg *dfg, const std::string &fname, bool compact = false);
 
 /*!
  * \brief Load the json into DFG data structure.
+ *        A filename ending with ".dfg.bin" is loaded by ImportBinary instead.
  * \param fname The filename to load
  * \return The DFG loaded.
  */
 SSDfg* Import(const std::string &fname);
 
+/*!
+ * \brief Dump the DFG in the binary format, which is loaded without parsing.
+ *        Unlike the json, the names of the instructions, the metadata of the ports,
+ *        and the properties of the sub-DFGs are kept.
+ * \param dfg The DFG to dump.
+ * \param fname The binary filename, conventionally with the ".dfg.bin" suffix.
+ * \param hash If a hash of the content is dumped, so that the loader checks it.
+ */
+void ExportBinary(SSDfg *dfg, const std::string &fname, bool hash = true);
 
+/*!
+ * \brief Load the DFG dumped by ExportBinary, by mapping the file into the memory.
+ * \param fname The filename to load.
+ * \return The DFG loaded.
+ */
+SSDfg* ImportBinary(const std::string &fname);
 
 }
 }
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace dsa {
+
+/*!
+ * \brief A JSON writer which streams the tokens to a file through a buffer, without
+ *        building a DOM first. Commas and line breaks are inserted automatically.
+ */
+class JSONWriter {
+ public:
+  /*!
+   * \param filename The file to write.
+   * \param compact If the dumpers should write arrays of tuples instead of keyed objects.
+   *        The loaders accept both.
+   */
+  JSONWriter(const std::string& filename, bool compact = false)
+      : fd(open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644)), _compact(compact),
+        failed(fd == -1) {}
+
+  ~JSONWriter() { Close(); }
+
+  /*!
+   * \brief Flush the data and close the file.
+   * \return If the file is opened, and all the data is written.
+   */
+  bool Close() {
+    if (fd != -1) {
+      Put('\n');
+      Flush();
+      failed |= close(fd) != 0;
+      fd = -1;
+    }
+    return !failed;
+  }
+
+  bool good() const { return fd != -1; }
+
+  /*! \brief If the file cannot be opened, or some data failed to be written. */
+  bool fail() const { return failed; }
+
+  bool compact() const { return _compact; }
+
+  JSONWriter& BeginObject() { return Open('{'); }
+  JSONWriter& EndObject() { return Close('}'); }
+  JSONWriter& BeginArray() { return Open('['); }
+  JSONWriter& EndArray() { return Close(']'); }
+
+  /*! \brief The key of the next value in an object. */
+  JSONWriter& Key(const char* key) {
+    Value(key);
+    Put(':');
+    after_key = true;
+    return *this;
+  }
+
+  JSONWriter& Value(int64_t x) {
+    char buf[24];
+    return Raw(buf, snprintf(buf, sizeof buf, "%lld", (long long)x));
+  }
+  JSONWriter& Value(int x) { return Value((int64_t)x); }
+  JSONWriter& Value(bool x) { return x ? Raw("true", 4) : Raw("false", 5); }
+  /*! \brief JSON has no NaN or infinity, so they are written as null. */
+  JSONWriter& Value(double x) {
+    if (!std::isfinite(x)) return Raw("null", 4);
+    char buf[32];
+    return Raw(buf, snprintf(buf, sizeof buf, "%.17g", x));
+  }
+  JSONWriter& Value(const char* x) {
+    Prefix();
+    Put('"');
+    for (; *x; ++x) {
+      switch (*x) {
+        case '"': Put('\\'); Put('"'); break;
+        case '\\': Put('\\'); Put('\\'); break;
+        case '\n': Put('\\'); Put('n'); break;
+        case '\t': Put('\\'); Put('t'); break;
+        default:
+          if ((unsigned char)*x < 0x20) {
+            char buf[8];
+            Append(buf, snprintf(buf, sizeof buf, "\\u%04x", *x));
+          } else {
+            Put(*x);
+          }
+      }
+    }
+    Put('"');
+    return *this;
+  }
+  JSONWriter& Value(const std::string& x) { return Value(x.c_str()); }
+
+  /*! \brief A shorthand of a key-value pair. */
+  template <typename T>
+  JSONWriter& Field(const char* key, const T& x) {
+    return Key(key).Value(x);
+  }
+
+  /*! \brief Write the buffered data to the file. A failure is kept in fail(). */
+  void Flush() {
+    for (size_t i = 0; i < size;) {
+      ssize_t n = write(fd, buffer + i, size - i);
+      if (n <= 0) {
+        failed = true;
+        break;
+      }
+      i += n;
+    }
+    size = 0;
+  }
+
+ private:
+  /*! \brief Put a comma and a line break before a value if needed. */
+  void Prefix() {
+    if (after_key) {
+      after_key = false;
+      return;
+    }
+    if (!count.empty()) {
+      if (count.back()++) Put(',');
+      // Only the elements of the outer containers go to separated lines.
+      if ((int)count.size() <= (_compact ? 1 : 2)) NewLine(count.size());
+    }
+  }
+
+  JSONWriter& Open(char c) {
+    Prefix();
+    Put(c);
+    count.push_back(0);
+    return *this;
+  }
+
+  JSONWriter& Close(char c) {
+    bool broken = count.back() && (int)count.size() <= (_compact ? 1 : 2);
+    count.pop_back();
+    if (broken) NewLine(count.size());
+    Put(c);
+    return *this;
+  }
+
+  JSONWriter& Raw(const char* s, int n) {
+    Prefix();
+    Append(s, n);
+    return *this;
+  }
+
+  void NewLine(int indent) {
+    Put('\n');
+    for (int i = 0; i < indent; ++i) Put(' ');
+  }
+
+  void Append(const char* s, size_t n) {
+    for (size_t i = 0; i < n; ++i) Put(s[i]);
+  }
+
+  void Put(char c) {
+    if (size == sizeof buffer) Flush();
+    buffer[size++] = c;
+  }
+
+  int fd;
+  bool _compact;
+  bool failed;
+  /*! \brief The number of values written in each of the open containers. */
+  std::vector<int> count;
+  /*! \brief If a key is just written, so that the value needs no prefix. */
+  bool after_key{false};
+  char buffer[1 << 16];
+  size_t size{0};
+};
+
+}  // namespace dsa
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace dsa {
+
+/*! \brief Which debug artifacts the scheduler writes. */
+enum class ArtifactPolicy {
+  /*! \brief Only the configuration the compiler consumes. */
+  None,
+  /*! \brief Besides, the visualization and the verification files of the final mapping. */
+  Final,
+  /*! \brief Besides, the snapshots of the mappings during the search. */
+  All
+};
+
+/*! \brief Parse "none", "final", or "all". */
+ArtifactPolicy ParseArtifactPolicy(const std::string& s);
+
+/*!
+ * \brief A background thread which writes the artifacts of the search, so that the search
+ *        does not wait for the files. A dump should work on a snapshot it owns.
+ */
+class ArtifactWriter {
+ public:
+  ~ArtifactWriter();
+
+  /*!
+   * \brief Queue a dump. A queued dump of the same file is replaced, since it would be
+   *        overwritten anyway.
+   * \param filename The file the dump writes.
+   * \param dump The function which writes the file.
+   */
+  void Submit(const std::string& filename, std::function<void()> dump);
+
+  /*! \brief Wait for all the queued dumps to be written. */
+  void Drain();
+
+ private:
+  void Worker();
+
+  std::mutex _lock;
+  std::condition_variable _cv, _idle;
+  std::vector<std::pair<std::string, std::function<void()>>> _pending;
+  bool _busy{false}, _closing{false};
+  /*! \brief Started on the first dump, so a scheduler writing nothing has no thread. */
+  std::thread _worker;
+};
+
+}  // namespace dsa
@@ -4,6 +4,7 @@
 #include "schedule.h"
 #include "dsa/arch/model.h"
 #include "dsa/arch/estimation.h"
+#include "dsa/rng.h"
 
 // This class contains all info which you might want to remember about
 class WorkloadSchedules {
@@ -28,12 +29,16 @@ class SchedStats {
 // 2.
 
 template<typename T>
-inline int non_uniform_random(const std::vector<T> &nodes, const std::vector<bool> &vec) {
-  for (int res = rand() % nodes.size(); ;res = rand() % nodes.size()) {
+inline int non_uniform_random(const std::vector<T> &nodes, const std::vector<bool> &vec,
+                              dsa::Rng &rng) {
+  for (int res = rng.Below(nodes.size()); ;res = rng.Below(nodes.size())) {
+    if (!nodes[res]) {
+      continue;
+    }
     if (vec[nodes[res]->id()]) {
       return res;
     }
-    if (rand() % 2 == 0) {
+    if (rng.Below(2) == 0) {
       return res;
     }
   }
@@ -53,7 +58,13 @@ class CodesignInstance {
 
   bool sanity_check{false};
 
-  CodesignInstance(SSModel* model);
+  /*! \brief The random numbers of the modifications, shared by the copies of an exploration. */
+  dsa::Rng* rng;
+
+  // How the area/power of the fabric is estimated in the objective
+  dsa::adg::estimation::Model estimation_model{dsa::adg::estimation::Model::Analytical};
+
+  CodesignInstance(SSModel* model, dsa::Rng* rng);
 
   // Check that everything is okay
   void verify() {
@@ -69,9 +80,10 @@ class CodesignInstance {
 
       for (auto& ep : sched.edge_prop()) {
         for (auto& p : ep.links) {
-          assert(p.second->id() < (int)_ssModel.subModel()->link_list().size());
-          assert(p.second->id() < (int)sched.link_prop().size());
-          assert(_ssModel.subModel()->link_list()[p.second->id()] == p.second);
+          assert(p.second < (int)_ssModel.subModel()->link_list().size());
+          assert(p.second < (int)sched.link_prop().size());
+          assert(_ssModel.subModel()->link_list()[p.second]);
+          assert(_ssModel.subModel()->link_list()[p.second]->id() == p.second);
         }
       }
     });
@@ -81,7 +93,8 @@ class CodesignInstance {
       }
     }
     for (unsigned i = 0; i < _ssModel.subModel()->link_list().size(); ++i) {
-      assert(_ssModel.subModel()->link_list()[i]->id() == (int)i);
+      auto* link = _ssModel.subModel()->link_list()[i];
+      assert(!link || link->id() == (int)i);
     }
   }
 
@@ -95,21 +108,21 @@ class CodesignInstance {
 
     if (sub->node_list().empty()) return;
 
-    int n_ins = rand() % (max_in - min_in) + min_in;
+    int n_ins = rng->Below(max_in - min_in) + min_in;
     for (int i = 0, j = 0; i < n_ins && j < n_ins * 10 && n->in_links().size() <= 4; ++i, ++j) {
-      int src_node_index = rand() % sub->nodes<ssnode*>().size();
+      int src_node_index = rng->Below(sub->nodes<ssnode*>().size());
       ssnode* src = sub->node_list()[src_node_index];
-      if ((dynamic_cast<ssvport*>(src) && src->out_links().empty()) || src == n) {
+      if (!src || (dynamic_cast<ssvport*>(src) && src->out_links().empty()) || src == n) {
         i--;
         continue;
       }
       sub->add_link(src, n);
     }
-    int n_outs = rand() % (max_out - min_out) + min_out;
+    int n_outs = rng->Below(max_out - min_out) + min_out;
     for (int i = 0, j = 0; i < n_outs && j < n_outs * 10 && n->out_links().size() <= 4; ++i, ++j) {
-      int dst_node_index = rand() % sub->node_list().size();
+      int dst_node_index = rng->Below(sub->node_list().size());
       ssnode* dst = sub->node_list()[dst_node_index];
-      if ((dynamic_cast<ssvport*>(dst) && dst->in_links().empty()) || dst == n) {
+      if (!dst || (dynamic_cast<ssvport*>(dst) && dst->in_links().empty()) || dst == n) {
         i--;
         continue;
       }
@@ -164,7 +177,7 @@ class CodesignInstance {
     auto* sub = _ssModel.subModel();
 
     for (int j = 0, n = sub->link_list().size(); j < n; ++j) {
-      if (unused_links[j])
+      if (unused_links[j] && sub->link_list()[j])
         delete_link(sub->link_list()[j]);
     }
     for (int j = 0, n = sub->switch_list().size(); j < n; ++j) {
@@ -190,17 +203,18 @@ class CodesignInstance {
     }
   }
 
-  void make_random_modification(double temperature) {
-    switch (rand() % 3) {
-    case 0: add_something(temperature); break;
-    case 1: remove_something(temperature); break;
-    case 2: change_parameters_of_nodes(temperature);
+  /*! \brief Return the kind of the modification made. */
+  const char* make_random_modification(double temperature) {
+    switch (rng->Below(3)) {
+    case 0: add_something(temperature); return "add";
+    case 1: remove_something(temperature); return "remove";
+    default: change_parameters_of_nodes(temperature); return "change";
     }
   }
 
   void add_something(int cnt) {
-    if (rand() % 100 <= cnt * cnt)
-      _ssModel.io_ports += rand() % (4 - _ssModel.io_ports + 1);
+    if (rng->Below(100) <= cnt * cnt)
+      _ssModel.io_ports += rng->Below(4 - _ssModel.io_ports + 1);
     
     auto* sub = _ssModel.subModel();
 
@@ -208,14 +222,15 @@ class CodesignInstance {
 
     // Items to add
     for (int i = 0; i < cnt; ++i) {
-      int item_class = rand() % 100;
+      int item_class = rng->Below(100);
       if (item_class < 65) {
         // Add a random link -- really? really
         if (sub->node_list().empty()) continue;
-        int src_node_index = rand() % sub->node_list().size();
-        int dst_node_index = rand() % sub->node_list().size();
+        int src_node_index = rng->Below(sub->node_list().size());
+        int dst_node_index = rng->Below(sub->node_list().size());
         ssnode* src = sub->node_list()[src_node_index];
         ssnode* dst = sub->node_list()[dst_node_index];
+        if (!src || !dst) continue;
         if (dynamic_cast<ssvport*>(src) && src->out_links().empty()) {
           continue;
         }
@@ -239,7 +254,7 @@ class CodesignInstance {
         auto& fu_defs = _ssModel.fu_types;
         if (fu_defs.empty()) continue;
         ssfu* fu = sub->add_fu();
-        int fu_def_index = rand() % fu_defs.size();
+        int fu_def_index = rng->Below(fu_defs.size());
         Capability* def = fu_defs[fu_def_index];
         fu->fu_type_ = *def;
 
@@ -271,17 +286,17 @@ class CodesignInstance {
   }
 
   void remove_something(int cnt) {
-    if (rand() % 100 <= cnt * cnt) {
-      _ssModel.io_ports = rand() % _ssModel.io_ports + 1;
+    if (rng->Below(100) <= cnt * cnt) {
+      _ssModel.io_ports = rng->Below(_ssModel.io_ports) + 1;
     }
     auto* sub = _ssModel.subModel();
     // Choose a set of Items to remove
     for (int i = 0; i < cnt; ++i) {
-      int item_class = rand() % 100;
+      int item_class = rng->Below(100);
       if (item_class < 60) {
         // delete a link
-        if (sub->link_list().empty()) continue;
-        int index = non_uniform_random(sub->link_list(), unused_links);
+        if (!sub->num_links()) continue;
+        int index = non_uniform_random(sub->link_list(), unused_links, *rng);
         sslink* l = sub->link_list()[index];
         if (delete_linkp_list.count(l)) continue;  // don't double delete
         std::cout << "remove: " << l->name() << std::endl;
@@ -289,28 +304,28 @@ class CodesignInstance {
       } else if (item_class < 75) {
         // delete a switch
         if (sub->switch_list().empty()) continue;
-        int index = non_uniform_random(sub->switch_list(), unused_nodes);
+        int index = non_uniform_random(sub->switch_list(), unused_nodes, *rng);
         ssswitch* sw = sub->switch_list()[index];
         if (delete_nodep_list.count(sw)) continue;  // don't double delete
         delete_hw(sw);
       } else if (item_class < 90) {
         // delete an FU
         if (sub->fu_list().empty()) continue;
-        int index = non_uniform_random(sub->fu_list(), unused_nodes);
+        int index = non_uniform_random(sub->fu_list(), unused_nodes, *rng);
         ssfu* fu = sub->fu_list()[index];
         if (delete_nodep_list.count(fu)) continue;  // don't double delete
         delete_hw(fu);
       } else if (item_class < 95) {
         // delete an VPort
         if (sub->input_list().size() == 0) continue;
-        int index = non_uniform_random(sub->input_list(), unused_nodes);
+        int index = non_uniform_random(sub->input_list(), unused_nodes, *rng);
         ssvport* vport = sub->input_list()[index];
         if (delete_nodep_list.count(vport)) continue;  // don't double delete
         delete_hw(vport);
       } else { 
         // delete an VPort
         if (sub->output_list().size() == 0) continue;
-        int index = non_uniform_random(sub->output_list(), unused_nodes);
+        int index = non_uniform_random(sub->output_list(), unused_nodes, *rng);
         ssvport* vport = sub->output_list()[index];
         if (delete_nodep_list.count(vport)) continue;  // don't double delete
         delete_hw(vport);
@@ -333,18 +348,18 @@ class CodesignInstance {
   void change_parameters_of_nodes(int cnt) {
     auto* sub = _ssModel.subModel();
 
-    if (rand() % 100 <= cnt) {
-      _ssModel.io_ports = rand() % 4 + 1;
+    if (rng->Below(100) <= cnt) {
+      _ssModel.io_ports = rng->Below(4) + 1;
     }
 
     // Modifiers
     for (int i = 0; i < cnt; ++i) {
-      int item_class = rand() % 100;
+      int item_class = rng->Below(100);
       if (item_class < 15) {
         if (sub->node_list().empty()) continue;
-        int node_index = rand() % sub->node_list().size();
+        int node_index = rng->Below(sub->node_list().size());
         ssnode* node = sub->node_list()[node_index];
-        if (dynamic_cast<ssvport*>(node)) continue;
+        if (!node || dynamic_cast<ssvport*>(node)) continue;
 
         node->set_flow_control(!node->flow_control());
         if (!node->flow_control()) {
@@ -366,9 +381,9 @@ class CodesignInstance {
 
         if (sub->fu_list().empty()) continue;
         // Modify FU utilization
-        int diff = rand() % 16 - 8;
+        int diff = rng->Below(16) - 8;
         if (diff == 0) continue;
-        int fu_index = rand() % sub->fu_list().size();
+        int fu_index = rng->Below(sub->fu_list().size());
         ssfu* fu = sub->fu_list()[fu_index];
         int old_util = fu->max_util();
         int new_util = std::max(1, old_util + diff);
@@ -395,8 +410,8 @@ class CodesignInstance {
       } else if (item_class < 60) {
         if (sub->fu_list().empty()) continue;
         // Modify FU delay-fifo depth
-        int diff = -(rand() % 3 + 1);
-        int fu_index = rand() % sub->fu_list().size();
+        int diff = -(rng->Below(3) + 1);
+        int fu_index = rng->Below(sub->fu_list().size());
         ssfu* fu = sub->fu_list()[fu_index];
         int new_delay_fifo_depth = std::max(1, fu->delay_fifo_depth() + diff);
         fu->set_delay_fifo_depth(new_delay_fifo_depth);
@@ -422,13 +437,13 @@ class CodesignInstance {
 
       } else if (item_class < 80) {
         // change fu-type
-        int index = rand() % sub->fu_list().size();
+        int index = rng->Below(sub->fu_list().size());
         auto fu = sub->fu_list()[index];
 
-        if (rand() & 1) {
-          fu->fu_type_ = *ss_model()->fu_types[rand() % ss_model()->fu_types.size()];
+        if (rng->Below(2)) {
+          fu->fu_type_ = *ss_model()->fu_types[rng->Below(ss_model()->fu_types.size())];
         } else if (fu->fu_type_.capability.size() > 1) {
-          int j = rand() % fu->fu_type_.capability.size();
+          int j = rng->Below(fu->fu_type_.capability.size());
           fu->fu_type_.Erase(j);
         }
 
@@ -445,12 +460,13 @@ class CodesignInstance {
         });
       } else if (item_class < 100) {
         // change decomposer
-        int index = rand() % sub->node_list().size();
+        int index = rng->Below(sub->node_list().size());
         auto fu = sub->node_list()[index];
+        if (!fu) continue;
         static const int candidates[] = {1, 2, 4, 8};
-        int new_one = candidates[rand() % 4];
+        int new_one = candidates[rng->Below(4)];
         while (new_one == fu->decomposer) {
-          new_one = candidates[rand() % 4];
+          new_one = candidates[rng->Below(4)];
         }
         if (new_one < fu->decomposer) {
           for_each_sched([&](Schedule& sched) {
@@ -488,6 +504,8 @@ class CodesignInstance {
     // "\n"; assert(_ssModel.subModel() != copy_sub);
 
     weight = c.weight;
+    estimation_model = c.estimation_model;
+    rng = c.rng;
 
     if (from_scratch) {
       for (auto &work: c.workload_array) {
@@ -499,8 +517,7 @@ class CodesignInstance {
     } else {
       workload_array = c.workload_array;
       for_each_sched([&](Schedule& sched) {
-        // replace this ssmodel with the copy
-        sched.swap_model(_ssModel.subModel());
+        // replace this ssmodel with the copy, schedules only refer to the hardware by id
         sched.set_model(&_ssModel);
       });
     }
@@ -549,35 +566,21 @@ class CodesignInstance {
 
   // This makes the delete consistent across model and schedules
   void finalize_delete() {
-    // Grab a copy copy of all nodes
     auto* sub = _ssModel.subModel();
-    std::vector<ssnode*> n_copy = sub->node_list();  // I hope this copies the list?
-    std::vector<sslink*> l_copy = sub->link_list();  // I hope this copies the list?
 
     verify();
 
-    // Remove the elements from these lists
-    sub->delete_nodes(delete_node_list);  // these happen after above, b/c above uses id
+    // Tombstone the elements, the links go first so that they can be unlinked from nodes.
+    // The ids of the remaining elements are stable, so the schedules only have to drop
+    // the properties of the deleted ones.
     sub->delete_links(delete_link_list);
-
-    // got to reorder all the links
-    for_each_sched([&](Schedule& sched) { sched.reorder_node_link(n_copy, l_copy); });
+    sub->delete_nodes(delete_node_list);
+    for_each_sched([&](Schedule& sched) { sched.release_hw(delete_node_list, delete_link_list); });
 
     verify();
 
-    // finally, we just deleted a bunch of nodes/links, and we should
-    // probably free the memory somehow?
-    // that's why we tracked these datastructures
-    for (auto* link : delete_linkp_list) {
-      // we also need to tell the model to delete the link from its little lists
-      // The sslink destructor unlinks it from the connected nodes' references
-      delete link;
-    }
-    for (auto* node : delete_nodep_list) {
-      delete node;
-    }
-
-    verify();
+    // The deleted nodes/links are owned by the arenas of the fabric, and were already
+    // unlinked from the remaining ones by delete_links above.
 
     // finally finally, clear all datastructres used for deleting
     delete_nodep_list.clear();
@@ -592,6 +595,28 @@ class CodesignInstance {
     verify();
   }
 
+  /*!
+   * \brief Squeeze the tombstones out of the fabric, and renumber the hardware referred
+   *        by the schedules once. This is required before dumping the fabric.
+   */
+  void compact() {
+    auto* sub = _ssModel.subModel();
+    if (sub->is_compact()) return;
+    auto remap = sub->compact();
+    for_each_sched([&](Schedule& sched) { sched.remap_hw(remap.first, remap.second); });
+    auto f = [](std::vector<bool>& unused, const std::vector<int>& remap, int n) {
+      if (unused.size() != remap.size()) return;
+      std::vector<bool> res(n, true);
+      for (int i = 0, m = remap.size(); i < m; ++i) {
+        if (remap[i] != -1) res[remap[i]] = unused[i];
+      }
+      unused.swap(res);
+    };
+    f(unused_nodes, remap.first, sub->node_list().size());
+    f(unused_links, remap.second, sub->link_list().size());
+    verify();
+  }
+
   std::pair<double, int> dse_sched_obj(Schedule* sched) {
     if (!sched) return {0.1, INT_MIN};
     // YES, I KNOW THIS IS A COPY OF SCHED< JUST A TEST FOR NOW
@@ -652,7 +677,7 @@ class CodesignInstance {
     total_score.first = pow(total_score.first, (1.0 / workload_array.size()));
 
 
-    auto estimated = dsa::adg::estimation::EstimatePowerAera(&_ssModel);
+    auto estimated = dsa::adg::estimation::EstimatePowerAera(&_ssModel, estimation_model);
 
     float area = (estimated.Total<dsa::adg::estimation::Metric::Area>());
     //float obj = total_score.first * 1e6 / area;
@@ -669,8 +694,9 @@ class CodesignInstance {
     if (abs(dse_obj()) < (1.0 + 1e-3) || !res[0]) {
       return {0, 0, 0};
     }
-    unused_nodes = std::vector<bool>(res[0]->ssModel()->subModel()->node_list().size(), true);
-    unused_links = std::vector<bool>(res[0]->ssModel()->subModel()->link_list().size(), true);
+    auto* sub = res[0]->ssModel()->subModel();
+    unused_nodes = std::vector<bool>(sub->node_list().size(), true);
+    unused_links = std::vector<bool>(sub->link_list().size(), true);
     for (size_t i = 0; i < res.size(); ++i) {
       if (!res[i]) {
         return {0, 0, 0};
@@ -696,17 +722,22 @@ class CodesignInstance {
         }
       }
     }
+    // Tombstones are neither used nor unused.
     int cnt_nodes = 0, cnt_links = 0;
-    for (auto elem : unused_nodes) cnt_nodes += elem;
-    for (auto elem : unused_links) cnt_links += elem;
-    float overall = (float)(cnt_nodes + cnt_links) / (unused_nodes.size() + unused_links.size());
-    float nodes_ratio = (float)(cnt_nodes) / (unused_nodes.size());
-    float links_ratio = (float)(cnt_links) / (unused_links.size());
+    for (int j = 0, n = unused_nodes.size(); j < n; ++j) {
+      cnt_nodes += unused_nodes[j] && sub->node_list()[j];
+    }
+    for (int j = 0, n = unused_links.size(); j < n; ++j) {
+      cnt_links += unused_links[j] && sub->link_list()[j];
+    }
+    float overall = (float)(cnt_nodes + cnt_links) / (sub->num_nodes() + sub->num_links());
+    float nodes_ratio = (float)(cnt_nodes) / (sub->num_nodes());
+    float links_ratio = (float)(cnt_links) / (sub->num_links());
     return {overall, nodes_ratio, links_ratio};
   }
 
   void dump_breakdown(bool verbose) {
-    auto estimated = dsa::adg::estimation::EstimatePowerAera(ss_model());
+    auto estimated = dsa::adg::estimation::EstimatePowerAera(ss_model(), estimation_model);
     estimated.Dump(std::cout);
     if (verbose) {
       for (int i = 0, n = res.size(); i < n; ++i) {
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "dsa/mapper/schedule.h"
+
+namespace dsa {
+
+/*!
+ * \brief A directory of the mappings found before, addressed by the content of the DFG,
+ *        the hardware, and the options of the mapper, so that compiling the same DFG
+ *        against the same fabric again skips the search.
+ *
+ *        The entries are the files of DumpMappingInJson. They are written to a temporary
+ *        file and renamed, so concurrent builds sharing a directory never see a partial
+ *        entry. When the directory grows beyond its budget, the least recently used
+ *        entries are removed.
+ */
+class MappingCache {
+ public:
+  /*!
+   * \param dir The directory of the entries, created if absent.
+   * \param max_bytes The budget of the total size of the entries.
+   * \param options The options of the mapper which affect the mapping.
+   */
+  MappingCache(const std::string& dir, int64_t max_bytes, const std::string& options);
+
+  /*!
+   * \brief The key of a DFG and a hardware. The comments and the whitespaces of a text DFG
+   *        are normalized away before hashing.
+   */
+  std::string Key(const std::string& dfg_filename, const std::string& model_filename) const;
+
+  /*!
+   * \brief Load the entry of the key to an empty schedule, and check that it is complete,
+   *        its routes are consistent, and it has neither a latency mismatch nor an overuse.
+   * \return If the schedule is loaded. If not, the schedule may be partially assigned.
+   */
+  bool Load(const std::string& key, Schedule* sched) const;
+
+  /*!
+   * \brief Write the mapping of a schedule as the entry of the key, and evict. An illegal
+   *        mapping is not written, and neither is an entry which fails to be written.
+   */
+  void Store(const std::string& key, Schedule* sched) const;
+
+ private:
+  std::string Entry(const std::string& key) const { return dir + "/" + key + ".json"; }
+
+  /*! \brief Remove the least recently used entries until the budget is met. */
+  void Evict() const;
+
+  std::string dir;
+  int64_t max_bytes;
+  std::string options;
+};
+
+}  // namespace dsa
@@ -4,6 +4,7 @@
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <unordered_set>
 
 #include <climits>
@@ -43,13 +44,25 @@ class Schedule {
 
   void printSwitchGraphviz(std::ofstream& ofs, ssswitch* sw);
 
-  void DumpMappingInJson(const std::string& mapping_filename);
+  /*!
+   * \brief Dump the mapping as a JSON array of instructions, loadable by LoadMappingInJson.
+   * \param mapping_filename The file to dump.
+   * \param compact If the instructions are dumped as tuples instead of keyed objects.
+   * \return If the file is completely written.
+   */
+  bool DumpMappingInJson(const std::string& mapping_filename, bool compact = false);
 
   void LoadMappingInJson(const std::string& mapping_filename);
 
-  void printConfigHeader(std::ostream& os, std::string cfg_name, bool cheat = true);
+  /*!
+   * \brief Print the config header. The cheat dumps the DFG and the mapping it refers to in
+   *        sched_dir, which should exist.
+   */
+  void printConfigHeader(std::ostream& os, std::string cfg_name, bool cheat = true,
+                         const std::string& sched_dir = "sched/");
 
-  void printConfigCheat(std::ostream& os, std::string cfg_name);
+  void printConfigCheat(std::ostream& os, std::string cfg_name,
+                        const std::string& sched_dir = "sched/");
 
   void printConfigVerif(std::ostream& os);
 
@@ -83,7 +96,7 @@ class Schedule {
     }
     _nodeProp[pt.second->id()].slots[pt.first].passthrus.push_back(edge);
     ++const_cast<int&>(total_passthrough);
-    _edgeProp[edge->id].passthroughs.push_back(pt);
+    _edgeProp[edge->id].passthroughs.emplace_back(pt.first, pt.second->id());
   }
 
   int groupMismatch(int g) { return _groupMismatch[g]; }
@@ -127,7 +140,8 @@ class Schedule {
     bool fail = false;
     int prev_num_edges = 10000;
 
-    for (auto link : links_of(edge)) {
+    for (auto elem : links_of(edge)) {
+      auto link = std::make_pair(elem.first, hw_link(elem.second));
       if (prev_link != NULL && prev_link->dest() != link.second->orig()) {
         std::cout << edge->name() << " has Failed Link Order Check\n";
         fail = true;
@@ -153,7 +167,8 @@ class Schedule {
       prev_link = link.second;
     }
     if (fail) {
-      for (auto link : links_of(edge)) {
+      for (auto elem : links_of(edge)) {
+        auto link = std::make_pair(elem.first, hw_link(elem.second));
         std::cout << link.second->name() << " #edges";
 
         std::unordered_set<dsa::dfg::Edge*> edges;
@@ -197,10 +212,10 @@ class Schedule {
     int orig_slot = assigned.first;
     auto snode = assigned.second;
 
-    assert(_vertexProp[vid].node == nullptr || _vertexProp[vid].node == snode);
-    if (_vertexProp[vid].node == snode) return;
+    assert(_vertexProp[vid].node_id == -1 || _vertexProp[vid].node_id == snode->id());
+    if (_vertexProp[vid].node_id == snode->id()) return;
 
-    _vertexProp[vid].node = snode;
+    _vertexProp[vid].node_id = snode->id();
     _vertexProp[vid].idx = orig_slot;
     _vertexProp[vid].width = dfgnode->bitwidth();
 
@@ -225,7 +240,7 @@ class Schedule {
 
     // Remove all the edges for each of links
     for (auto& link : ep.links) {
-      auto& lp = _linkProp[link.second->id()];
+      auto& lp = _linkProp[link.second];
 
       int last_slot = edge->bitwidth() / 8;
       for (int i = 0; i < last_slot; ++i) {
@@ -246,7 +261,7 @@ class Schedule {
 
     // Remove all passthroughs associated with this edge
     for (auto& pt : ep.passthroughs) {
-      auto& np = _nodeProp[pt.second->id()];
+      auto& np = _nodeProp[pt.second];
       auto &passthrus = np.slots[pt.first].passthrus;
       bool erased = false;
       for (auto iter = passthrus.begin(), end = passthrus.end(); iter != end; ++iter) {
@@ -280,13 +295,13 @@ class Schedule {
     }
 
     auto& vp = _vertexProp[dfgnode->id()];
-    ssnode* node = vp.node;
+    ssnode* node = vp.node_id == -1 ? nullptr : hw_node(vp.node_id);
 
     if (node) {
       int orig_slot = vp.idx;
 
       _num_mapped[dfgnode->type()]--;
-      vp.node = nullptr;
+      vp.node_id = -1;
 
       int num_slots = dfgnode->bitwidth() / 8;
       for (int i = 0; i < num_slots; ++i) {
@@ -310,8 +325,8 @@ class Schedule {
     // TODO: can't get vertex/edge from id, need to modify dfg to maintain
     for (unsigned i = 0; i < _vertexProp.size(); ++i) {
       auto& v = _vertexProp[i];
-      if (v.node) {
-        std::cout << i << "->" << v.node->name() << " ";
+      if (v.node_id != -1) {
+        std::cout << i << "->" << hw_node(v.node_id)->name() << " ";
       }
     }
     std::cout << "\nEdges: ";
@@ -346,17 +361,17 @@ class Schedule {
 
   // pdg edge to sslink
   void assign_edgelink(dsa::dfg::Edge* dfgedge, int slot, sslink* slink,
-                       std::vector<std::pair<int, sslink*>>::iterator it) {
+                       std::vector<std::pair<int, int>>::iterator it) {
     assign_link_to_edge(dfgedge, slot, slink);
     int idx = it - _edgeProp[dfgedge->id].links.begin();
     CHECK(idx >= 0 && idx <= (int) _edgeProp[dfgedge->id].links.size()) << idx;
-    _edgeProp[dfgedge->id].links.insert(it, std::make_pair(slot, slink));
+    _edgeProp[dfgedge->id].links.insert(it, std::make_pair(slot, slink->id()));
   }
 
   // pdg edge to sslink
   void assign_edgelink(dsa::dfg::Edge* dfgedge, int slot, sslink* slink) {
     assign_link_to_edge(dfgedge, slot, slink);
-    _edgeProp[dfgedge->id].links.push_back(std::make_pair(slot, slink));
+    _edgeProp[dfgedge->id].links.push_back(std::make_pair(slot, slink->id()));
   }
 
   // void print_links(dsa::dfg::Edge* dfgedge) {
@@ -379,21 +394,29 @@ class Schedule {
     auto& ep = _edgeProp[pdgedge->id];
     int total_delay = 0;
     for (auto& link : ep.links) {
-      total_delay += link.second->dest()->delay_fifo_depth();
+      total_delay += hw_link(link.second)->dest()->delay_fifo_depth();
     }
     return total_delay;
   }
 
-  std::vector<std::pair<int, sslink*>>& links_of(dsa::dfg::Edge* edge) {
+  /*! \brief The (slot, link id) pairs routing the given edge, in order. */
+  std::vector<std::pair<int, int>>& links_of(dsa::dfg::Edge* edge) {
     auto& ep = _edgeProp[edge->id];
     return ep.links;
   }
 
-  std::vector<std::pair<int, ssnode*>>& thrus_of(dsa::dfg::Edge* edge) {
+  /*! \brief The (slot, node id) pairs the given edge passes through. */
+  std::vector<std::pair<int, int>>& thrus_of(dsa::dfg::Edge* edge) {
     auto& ep = _edgeProp[edge->id];
     return ep.passthroughs;
   }
 
+  /*! \brief Resolve a hardware node id against the current model. */
+  ssnode* hw_node(int id) { return _ssModel->subModel()->node_list()[id]; }
+
+  /*! \brief Resolve a hardware link id against the current model. */
+  sslink* hw_link(int id) { return _ssModel->subModel()->link_list()[id]; }
+
   void setLatOfLink(std::pair<int, sslink*> link, int l) {
     _linkProp[link.second->id()].slots[link.first].lat = l;
   }
@@ -507,15 +530,17 @@ class Schedule {
   int num_slots(sslink* link) { return 8; }
 
   // we should depricate this?
-  ssnode* locationOf(SSDfgNode* dfgnode) { return _vertexProp[dfgnode->id()].node; }
+  ssnode* locationOf(SSDfgNode* dfgnode) {
+    int id = _vertexProp[dfgnode->id()].node_id;
+    return id == -1 ? nullptr : hw_node(id);
+  }
 
   std::pair<int, ssnode*> location_of(SSDfgNode* dfgnode) {
-    return std::make_pair(_vertexProp[dfgnode->id()].idx,
-                          _vertexProp[dfgnode->id()].node);
+    return std::make_pair(_vertexProp[dfgnode->id()].idx, locationOf(dfgnode));
   }
 
   bool is_scheduled(SSDfgNode* dfgnode) {
-    return _vertexProp[dfgnode->id()].node != nullptr;
+    return _vertexProp[dfgnode->id()].node_id != -1;
   }
 
   void stat_printOutputLatency();
@@ -526,6 +551,12 @@ class Schedule {
   void iterativeFixLatency();
 
   // Assert error if problem with consistency of schedule
+  /*!
+   * \brief If the routes start at the definitions, end at the uses, and pass through no
+   *        port in between. Unlike validate, it does not abort.
+   */
+  bool consistent();
+
   void validate();
 
   void calcLatency(int& lat, int& latmis, bool warnMismatch = false);
@@ -647,69 +678,60 @@ class Schedule {
   void get_overprov(int& ovr, int& agg_ovr, int& max_util);
   void get_link_overprov(sslink* link, int& ovr, int& agg_ovr, int& max_util);
 
-  // Swaps the nodes from one schedule to another
-  void swap_model(SpatialFabric* copy_sub) {
-    for (auto& vp : _vertexProp) {
-      if (vp.node) {
-        vp.node = copy_sub->node_list()[vp.node->id()];  // bo ya
-      }
+  /*!
+   * \brief Reset the properties of the deleted nodes and links, so that their ids can be
+   *        recycled. Whatever was mapped onto them should be already unassigned.
+   */
+  void release_hw(const std::vector<int>& nodes, const std::vector<int>& links) {
+    for (int id : nodes) {
+      if (id < (int)_nodeProp.size()) _nodeProp[id] = NodeProp();
     }
-    for (auto& ep : _edgeProp) {
-      for (auto& p : ep.links) {
-        if (p.second) {
-          p.second = copy_sub->link_list()[p.second->id()];
-        }
-      }
-      for (auto& p : ep.passthroughs) {
-        if (p.second) {
-          p.second = copy_sub->node_list()[p.second->id()];
-        }
-      }
+    for (int id : links) {
+      if (id < (int)_linkProp.size()) _linkProp[id] = LinkProp();
     }
   }
 
-  // Shuffle node and link properties post-delete
-  void reorder_node_link(std::vector<ssnode*>& old_n, std::vector<sslink*>& old_l) {
-    // first bulk copy node and link properties, b/c we're about to blow
-    // everything away and shuffle
-    auto copy_nodeProp = _nodeProp;
-    auto copy_linkProp = _linkProp;
-
-    _nodeProp.clear();
-    _linkProp.clear();
-
-    auto& new_node_list = _ssModel->subModel()->node_list();
-    auto& new_link_list = _ssModel->subModel()->link_list();
-
-    _nodeProp.resize(new_node_list.size());
-    _linkProp.resize(new_link_list.size());
-
-    // std::cout << _nodeProp.size() << "just resized\n";
-
-    for (unsigned i = 0; i < copy_nodeProp.size(); ++i) {
-      ssnode* n = old_n[i];
-      // at this point, we don't know if this node has been deleted...
-      // so to check, we are going to look up if its still there
-      if (n->id() < (int)new_node_list.size() && new_node_list[n->id()] == n) {
-        // ok, this node is still there, so perform the move
-        _nodeProp[n->id()] = copy_nodeProp[i];
+  /*!
+   * \brief Renumber the hardware referred by this schedule after the fabric is compacted.
+   * \param node_remap The old-to-new node ids, where -1 is a tombstone.
+   * \param link_remap The old-to-new link ids, where -1 is a tombstone.
+   */
+  void remap_hw(const std::vector<int>& node_remap, const std::vector<int>& link_remap) {
+    auto f = [](auto& props, const std::vector<int>& remap, int n) {
+      std::decay_t<decltype(props)> res(n);
+      for (int i = 0, m = std::min(props.size(), remap.size()); i < m; ++i) {
+        if (remap[i] != -1) res[remap[i]] = std::move(props[i]);
       }
+      props.swap(res);
+    };
+    f(_nodeProp, node_remap, _ssModel->subModel()->node_list().size());
+    f(_linkProp, link_remap, _ssModel->subModel()->link_list().size());
+    for (auto& vp : _vertexProp) {
+      if (vp.node_id != -1) vp.node_id = node_remap[vp.node_id];
     }
-    for (unsigned i = 0; i < copy_linkProp.size(); ++i) {
-      sslink* l = old_l[i];
-      // at this point, we don't know if this link has been deleted...
-      // so to check, we are going to look up if its still there
-      if (l->id() < (int)new_link_list.size() && new_link_list[l->id()] == l) {
-        // ok, this link is still there, so perform the move
-        _linkProp[l->id()] = copy_linkProp[i];
+    for (auto& ep : _edgeProp) {
+      for (auto& p : ep.links) p.second = link_remap[p.second];
+      for (auto& p : ep.passthroughs) p.second = node_remap[p.second];
+    }
+    // The distances may be shared with other schedules, so a remapped copy replaces them.
+    if (distances) {
+      int n = _ssModel->subModel()->node_list().size();
+      auto& old = *distances;
+      std::vector<std::vector<int>> res(n, std::vector<int>(n, 1e6));
+      for (int i = 0, m = std::min(old.size(), node_remap.size()); i < m; ++i) {
+        if (node_remap[i] == -1) continue;
+        for (int j = 0; j < m; ++j) {
+          if (node_remap[j] != -1) res[node_remap[i]][node_remap[j]] = old[i][j];
+        }
       }
+      distances = std::make_shared<const std::vector<std::vector<int>>>(std::move(res));
     }
-    // std::cout << _nodeProp.size() << "just resized\n";
   }
 
   struct VertexProp {
     int min_lat = 0, max_lat = 0, lat = 0, vio = 0;
-    ssnode* node = nullptr;
+    /*! \brief The id of the hardware node it is mapped to, -1 if not mapped. */
+    int node_id = -1;
     int width = -1, idx = -1;
   };
 
@@ -717,8 +739,9 @@ class Schedule {
     int num_links = 0;
     int extra_lat = 0;
     int vio = 0;  // temporary variable
-    std::vector<std::pair<int, sslink*>> links;
-    std::vector<std::pair<int, ssnode*>> passthroughs;
+    /*! \brief (slot, id) pairs of the hardware links and pass-through nodes. */
+    std::vector<std::pair<int, int>> links;
+    std::vector<std::pair<int, int>> passthroughs;
 
     void reset() {
       num_links = 0;
@@ -768,8 +791,11 @@ class Schedule {
   std::vector<std::vector<dsa::dfg::Edge*>> operands;
   /*! \brief The gathered redundant user edges of each node in the DFG. */
   std::vector<std::vector<dsa::dfg::Edge*>> users;
-  /*! \brief The distances among the nodes in the spatial hardware. */
-  std::vector<std::vector<int>> distances;
+  /*!
+   * \brief The distances among the nodes in the spatial hardware. They are read-only, so
+   *        the copies of a schedule, and the schedules of a model which has them, share them.
+   */
+  std::shared_ptr<const std::vector<std::vector<int>>> distances;
   /*! \brief The data issue throughput of each sub-DFG. Used by simulation. */
   std::vector<int> group_throughput;
   /*! \brief The number of candidate spots of each DFG nodes. */
@@ -2,6 +2,7 @@
 
 #include <stdlib.h>
 
+#include <atomic>
 #include <chrono>
 #include <fstream>
 #include <functional>
@@ -13,9 +14,13 @@
 #include <unordered_map>
 #include <vector>
 
+#include "dsa/mapper/artifact_writer.h"
+#include "dsa/mapper/mapping_cache.h"
 #include "dsa/mapper/schedule.h"
 #include "dsa/arch/model.h"
 #include "dsa/dfg/ssdfg.h"
+#include "dsa/rng.h"
+#include "dsa/telemetry.h"
 
 #define MAX_ROUTE 100000000
 
@@ -51,6 +56,21 @@ class Scheduler {
 
   bool suppress_timing_print = false;
 
+  /*! \brief If not null, the search loop emits a record per iteration to it. */
+  dsa::telemetry::Sink* telemetry{nullptr};
+
+  /*! \brief Which debug artifacts are written. */
+  dsa::ArtifactPolicy artifacts{dsa::ArtifactPolicy::All};
+
+  /*! \brief If not null, a mapping found before is loaded instead of searching. */
+  dsa::MappingCache* cache{nullptr};
+
+  /*! \brief If not empty, the search starts from this mapping of a previous version of the DFG. */
+  std::string warm_start;
+
+  /*! \brief The random numbers of the search, seeded by the driver. */
+  dsa::Rng rng;
+
   std::string AUX(int x) { return (x == -1 ? "-" : std::to_string(x)); }
 
   double total_msec() {
@@ -78,7 +98,12 @@ class Scheduler {
   bool running() { return !_should_stop; }
   void stop() { _should_stop = true; }
 
-  Schedule* invoke(SSModel* model, SSDfg* dfg, bool);
+  /*!
+   * \brief Map the DFG and write the config header. The header and the debug artifacts go
+   *        beside the DFG, and the dump of the cheat in sched/ of the working directory,
+   *        unless out_dir is given, where all of them go instead.
+   */
+  Schedule* invoke(SSModel* model, SSDfg* dfg, bool, const std::string& out_dir = "");
 
  protected:
   dsa::SSModel* getSSModel() { return _ssModel; }
@@ -87,11 +112,19 @@ class Scheduler {
 
   float _reslim;
   bool verbose{false};
-  bool _should_stop{false};
+  /*! \brief Set by stop(), which may be called from another thread. */
+  std::atomic<bool> _should_stop{false};
   std::string mapping_file{""};
   bool dump_mapping_if_improved{false};
 
   std::chrono::time_point<std::chrono::steady_clock> _start;
+
+  /*! \brief Where the snapshots of the search go, set by invoke. */
+  std::string _viz_dir{"viz/"};
+
+  /*! \brief Writes the snapshots of the search in the background. */
+  dsa::ArtifactWriter _artifact_writer;
 };
 
+/*! \brief Create a directory and its missing parents, like `mkdir -p`. */
 void make_directories(const std::string& s);
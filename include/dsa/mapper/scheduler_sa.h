@@ -11,8 +11,8 @@
 
 struct CandidateRoute {
   struct EdgeProp {
-    std::vector<std::pair<int, ssnode*>> thrus;
-    std::vector<std::pair<int, sslink*>> links;
+    std::vector<std::pair<int, int>> thrus;
+    std::vector<std::pair<int, int>> links;
   };
 
   // record an edge from the schedule
@@ -54,6 +54,8 @@ class SchedulerSimulatedAnnealing : public Scheduler {
   int routing_times{0};
 
   int candidates_tried{0}, candidates_succ{0};
+  /*! \brief If the improved mappings are dumped in the compact json form. */
+  bool compact_json{false};
 
   void initialize(SSDfg*, Schedule*&);
 
@@ -100,7 +102,7 @@ class SchedulerSimulatedAnnealing : public Scheduler {
   int route(Schedule* sched, dsa::dfg::Edge* dfgnode,
             std::pair<int, dsa::ssnode*> source,
             std::pair<int, dsa::ssnode*> dest,
-            std::vector<std::pair<int, sslink*>>::iterator* ins_it, int max_path_lengthen);
+            std::vector<std::pair<int, int>>::iterator* ins_it, int max_path_lengthen);
 
   int routing_cost(dsa::dfg::Edge*, int, int, sslink*, Schedule*,
                    const std::pair<int, ssnode*>&);
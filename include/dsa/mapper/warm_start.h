@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+
+#include "dsa/mapper/schedule.h"
+
+namespace dsa {
+namespace mapper {
+
+/*! \brief How much of a previous mapping is reused by a warm start. */
+struct WarmStartStats {
+  /*! \brief The nodes of the new DFG matched to a node of the old DFG. */
+  int nodes_matched{0};
+  /*! \brief The matched nodes placed where they were. */
+  int nodes_placed{0};
+  /*! \brief The edges routed as they were. */
+  int edges_routed{0};
+};
+
+/*!
+ * \brief Seed an empty schedule with the mapping of a previous version of its DFG, so that
+ *        the search only repairs the difference.
+ *
+ *        The ports are matched by their names. An instruction is matched if it has the same
+ *        opcode and operands as an old instruction, whose operands come from the matched
+ *        producers, or if it feeds the same operands of the matched consumers. A matched node
+ *        is placed where the old node was, unless the spot is taken or no longer capable,
+ *        and an edge between placed nodes keeps the route of the old edge.
+ *
+ * \param sched The schedule of the new DFG to seed.
+ * \param mapping_filename The mapping dumped by DumpMappingInJson. The old DFG is expected
+ *        beside it, as printConfigCheat dumps them: "sched/x.sched.json" is accompanied by
+ *        "sched/x.dfg.bin" or "sched/x.dfg.json".
+ */
+WarmStartStats WarmStart(Schedule* sched, const std::string& mapping_filename);
+
+}  // namespace mapper
+}  // namespace dsa
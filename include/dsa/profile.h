@@ -0,0 +1,91 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace dsa {
+namespace profile {
+
+/*! \brief The phases of the mapper accounted by the profiler. */
+enum class Phase : int {
+  Route,
+  RoutingCost,
+  Objective,
+  Overprov,
+  FixLatency,
+  IterativeLatency,
+  CandidateSpot,
+  ScheduleHere,
+  UnmapSome,
+  ScheduleCopy,
+  DumpGraphviz,
+  DumpJson,
+  NumPhases
+};
+
+/*! \brief The allocations made by operator new in this thread, when the profiler is built. */
+struct AllocCounter {
+  uint64_t count{0}, bytes{0};
+};
+extern thread_local AllocCounter allocations;
+
+/*! \brief If the scopes are accounted. The drivers turn it on by a flag. */
+extern bool enabled;
+
+/*! \brief Start accounting the scopes. */
+void Enable();
+
+/*! \brief Merge the counters of all the threads, and print a row per phase. */
+void Report(std::ostream& os);
+
+/*! \brief The time stamp counter, or the steady clock in nanoseconds without one. */
+inline uint64_t Cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+#endif
+}
+
+/*! \brief Account a sample of a phase to the counters of this thread. */
+void Record(Phase phase, uint64_t cycles, uint64_t allocs, uint64_t bytes);
+
+/*!
+ * \brief Account the time and the allocations from the construction to the destruction
+ *        to a phase. Nested scopes are accounted inclusively.
+ */
+class Scope {
+ public:
+  explicit Scope(Phase phase) : _phase(phase) {
+    if (!enabled) return;
+    _allocs = allocations.count;
+    _bytes = allocations.bytes;
+    _start = Cycles();
+  }
+
+  ~Scope() {
+    if (!_start) return;
+    uint64_t cycles = Cycles() - _start;
+    Record(_phase, cycles, allocations.count - _allocs, allocations.bytes - _bytes);
+  }
+
+ private:
+  Phase _phase;
+  uint64_t _start{0}, _allocs{0}, _bytes{0};
+};
+
+}  // namespace profile
+}  // namespace dsa
+
+#ifdef DSA_PROFILE
+#define PROFILE_SCOPE(P) dsa::profile::Scope _profile_scope(dsa::profile::Phase::P)
+#else
+#define PROFILE_SCOPE(P)
+#endif
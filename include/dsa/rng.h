@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+namespace dsa {
+
+/*!
+ * \brief The xoshiro256** generator. The mapper and the DSE draw from an instance they are
+ *        given instead of the global rand(), so that a search is reproduced by its seed no
+ *        matter what else runs in the process.
+ *
+ *        It satisfies UniformRandomBitGenerator, so it also drives std::shuffle.
+ */
+class Rng {
+ public:
+  using result_type = uint64_t;
+
+  explicit Rng(uint64_t seed = 0) { Seed(seed); }
+
+  /*! \brief Restart the stream of a seed. The state is expanded from it by SplitMix64. */
+  void Seed(uint64_t seed) {
+    for (auto& elem : s) {
+      uint64_t z = (seed += 0x9e3779b97f4a7c15ull);
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+      elem = z ^ (z >> 31);
+    }
+  }
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+  result_type operator()() {
+    uint64_t res = Rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = Rotl(s[3], 45);
+    return res;
+  }
+
+  /*! \brief A uniform integer in [0, n), which replaces "rand() % n". n should be positive. */
+  int Below(int n) { return (int)(((unsigned __int128)(*this)() * (uint64_t)n) >> 64); }
+
+  /*! \brief A uniform real in [0, 1). */
+  double Uniform() { return ((*this)() >> 11) * 0x1.0p-53; }
+
+  /*! \brief Advance the stream by 2^128 draws. */
+  void Jump() {
+    static const uint64_t kJump[] = {0x180ec6d33cfd0aba, 0xd5a61266f0c9392c,
+                                     0xa9582618e03fc9aa, 0x39abdc4529b1661c};
+    uint64_t t[4] = {0, 0, 0, 0};
+    for (uint64_t jump : kJump) {
+      for (int b = 0; b < 64; ++b) {
+        if (jump >> b & 1) {
+          for (int i = 0; i < 4; ++i) t[i] ^= s[i];
+        }
+        (*this)();
+      }
+    }
+    for (int i = 0; i < 4; ++i) s[i] = t[i];
+  }
+
+  /*!
+   * \brief Split off an independent stream: the returned generator continues this stream,
+   *        and this one jumps ahead of everything the returned one will ever draw. Forking
+   *        the streams of the workers in a fixed order keeps a parallel run reproducible.
+   */
+  Rng Fork() {
+    Rng res(*this);
+    Jump();
+    return res;
+  }
+
+ private:
+  static uint64_t Rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+  uint64_t s[4];
+};
+
+}  // namespace dsa
@@ -4,6 +4,7 @@
 #include <utility>
 
 #include "dsa/arch/ssinst.h"
+#include "dsa/debug.h"
 
 namespace dsa {
 namespace simulation {
@@ -16,5 +17,91 @@ struct Data {
       : available_at(aa), value(value), valid(valid) {}
 };
 
+/*!
+ * \brief The fixed-capacity FIFOs of a DFG, as ring buffers in one contiguous arena.
+ *        The fields of the entries are stored separately, and the valid flags are
+ *        bit-packed, so copying all the FIFOs is copying a few flat arrays.
+ */
+class FifoArena {
+ public:
+  /*! \brief Allocate a FIFO of the given capacity, and return its id. */
+  int Allocate(int capacity) {
+    CHECK(capacity > 0);
+    rings.push_back({(int) value.size(), capacity, 0, 0});
+    size_t n = value.size() + capacity;
+    available_at.resize(n);
+    value.resize(n);
+    valid.resize((n + 63) / 64);
+    return rings.size() - 1;
+  }
+
+  int size(int id) const { return rings[id].size; }
+  int capacity(int id) const { return rings[id].capacity; }
+  bool empty(int id) const { return !rings[id].size; }
+  bool full(int id) const { return rings[id].size == rings[id].capacity; }
+
+  Data front(int id) const {
+    CHECK(!empty(id));
+    int slot = rings[id].base + rings[id].head;
+    return Data(available_at[slot], value[slot], (valid[slot / 64] >> (slot % 64)) & 1);
+  }
+
+  void push(int id, const Data& data) {
+    auto& ring = rings[id];
+    CHECK(ring.size < ring.capacity) << "FIFO " << id << " overflows";
+    int slot = ring.base + (ring.head + ring.size) % ring.capacity;
+    available_at[slot] = data.available_at;
+    value[slot] = data.value;
+    if (data.valid) {
+      valid[slot / 64] |= 1ull << (slot % 64);
+    } else {
+      valid[slot / 64] &= ~(1ull << (slot % 64));
+    }
+    ++ring.size;
+  }
+
+  void pop(int id) {
+    auto& ring = rings[id];
+    CHECK(ring.size);
+    ring.head = (ring.head + 1) % ring.capacity;
+    --ring.size;
+  }
+
+  /*! \brief Empty all the FIFOs. */
+  void clear() {
+    for (auto& ring : rings) {
+      ring.head = ring.size = 0;
+    }
+  }
+
+ private:
+  struct Ring {
+    /*! \brief The first slot of this FIFO in the arena. */
+    int base;
+    int capacity;
+    int head, size;
+  };
+  std::vector<Ring> rings;
+  std::vector<uint64_t> available_at;
+  std::vector<uint64_t> value;
+  std::vector<uint64_t> valid;
+};
+
+/*! \brief A handle of a FIFO in an arena, with the interface of a queue. */
+class Fifo {
+ public:
+  Fifo(FifoArena* arena, int id) : arena(arena), id(id) {}
+
+  bool empty() const { return arena->empty(id); }
+  int size() const { return arena->size(id); }
+  Data front() const { return arena->front(id); }
+  void push(const Data& data) { arena->push(id, data); }
+  void pop() { arena->pop(id); }
+
+ private:
+  FifoArena* arena;
+  int id;
+};
+
+}
 }
-}
\ No newline at end of file
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+class SSDfg;
+class SSDfgInst;
+class SSDfgVecInput;
+class SSDfgVecOutput;
+
+namespace dsa {
+namespace dfg {
+struct Operand;
+}  // namespace dfg
+
+namespace simulation {
+
+/*!
+ * \brief A functional evaluator for golden-output checks of a sub-DFG before mapping.
+ *        The sub-DFG is lowered once into a topologically ordered tape over a dense
+ *        register file, where each register is a column of lanes, and each lane is one
+ *        vector of the input stream. A pass runs each step of the tape over all the
+ *        lanes, so that no queue, timing or virtual dispatch is involved per firing.
+ *        The predication is a lane mask along each column: an invalid or discarded
+ *        result clears the lane instead of being dropped from the stream.
+ *        Only non-temporal sub-DFGs without backpressure can be straight-lined; the
+ *        timing and the operand reuse are left to SSDfg::forward and the Simulator.
+ */
+class Evaluator {
+ public:
+  /*!
+   * \brief Lower a sub-DFG to the tape.
+   * \param dfg The DFG to evaluate.
+   * \param group The sub-DFG to lower.
+   * \param batch The maximum number of lanes evaluated in a pass.
+   */
+  Evaluator(SSDfg* dfg, int group, int batch = 1024);
+
+  /*! \brief The input ports of the sub-DFG, in the order of the port indices below. */
+  const std::vector<SSDfgVecInput*>& inputs() const { return _inputs; }
+  /*! \brief The output ports of the sub-DFG, in the order of the port indices below. */
+  const std::vector<SSDfgVecOutput*>& outputs() const { return _outputs; }
+
+  /*! \brief The lanes of the given value of an input port, to fill before a pass. */
+  uint64_t* Input(int port, int value) { return column(input_regs[port][value]); }
+  /*! \brief The lane mask of the given value of an input port. All lanes are valid by default. */
+  uint8_t* InputMask(int port, int value) { return mask(input_regs[port][value]); }
+
+  /*!
+   * \brief Evaluate the first n lanes. The states of the accumulating instructions carry
+   *        over from lane to lane, and from pass to pass, like a continuous stream.
+   */
+  void Run(int n);
+
+  /*! \brief The lanes of the given operand of an output port, after a pass. */
+  const uint64_t* Output(int port, int operand) { return column(output_regs[port][operand]); }
+  /*! \brief The lane mask of the given operand of an output port, after a pass. */
+  const uint8_t* OutputMask(int port, int operand) { return mask(output_regs[port][operand]); }
+
+  /*! \brief Clear the states of the accumulating instructions. */
+  void Reset();
+
+  int batch() const { return _batch; }
+
+  /*! \brief The number of steps of the tape. */
+  int tape_size() const { return tape.size(); }
+
+ private:
+  /*! \brief A bit range of a source register, which is a part of a concatenation. */
+  struct Slice {
+    int reg, l, r;
+  };
+
+  /*! \brief A step of the tape. */
+  struct Step {
+    /*! \brief The instruction to execute, or null to concatenate slices[begin, end) to dst. */
+    SSDfgInst* inst{nullptr};
+    int begin{0}, end{0};
+    /*! \brief The registers of the operands. */
+    int ops[4]{-1, -1, -1, -1};
+    /*! \brief If each operand is a control operand tested by the predicate. */
+    bool ctrl[4]{false, false, false, false};
+    int arity{0};
+    /*! \brief The register of the first value. The other values follow it. */
+    int dst{-1};
+    int num_values{0};
+    /*!
+     * \brief If the instruction has a batched SIMD kernel. These are stateless and never
+     *        discard, so all the lanes can be computed at once and masked afterwards.
+     */
+    bool batched{false};
+    /*! \brief The states of the instruction, e.g. the accumulator. */
+    uint64_t reg[8]{0, 0, 0, 0, 0, 0, 0, 0};
+  };
+
+  /*! \brief Allocate a register, and return its index. */
+  int NewRegister();
+  /*! \brief The register holding an operand, adding a concatenation step if needed. */
+  int Lower(dfg::Operand& operand);
+
+  void Gather(const Step& step, int n);
+  void Execute(Step& step, int n);
+  /*! \brief Execute all the lanes with the SIMD kernel, and mask the results. */
+  void ExecuteBatched(Step& step, int n);
+
+  uint64_t* column(int reg) { return &regs[reg * _batch]; }
+  uint8_t* mask(int reg) { return &masks[reg * _batch]; }
+
+  SSDfg* dfg;
+  int _batch;
+  int num_regs{0};
+  std::vector<SSDfgVecInput*> _inputs;
+  std::vector<SSDfgVecOutput*> _outputs;
+  /*! \brief The register of each value of each input port. */
+  std::vector<std::vector<int>> input_regs;
+  /*! \brief The register of each operand of each output port. */
+  std::vector<std::vector<int>> output_regs;
+  /*! \brief The register of each value of each node, indexed by the node id. */
+  std::vector<std::vector<int>> value_regs;
+  /*! \brief The constants, which are filled to their registers once. */
+  std::vector<std::pair<int, uint64_t>> imms;
+  std::vector<Step> tape;
+  std::vector<Slice> slices;
+  /*! \brief The register file, and its lane masks, each register a column of _batch lanes. */
+  std::vector<uint64_t> regs;
+  std::vector<uint8_t> masks;
+  /*! \brief The scratch flags of the predicate tests. */
+  std::vector<bool> back_array;
+};
+
+}  // namespace simulation
+}  // namespace dsa
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <queue>
+#include <vector>
+
+#include "dsa/simulation/data.h"
+
+class Schedule;
+class SSDfg;
+class SSDfgNode;
+class SSDfgVecInput;
+class SSDfgVecOutput;
+
+namespace dsa {
+namespace simulation {
+
+/*! \brief The reasons for which a woken node fails to fire. */
+enum class Stall {
+  /*! \brief Some operand has not arrived yet. */
+  Operand,
+  /*! \brief Some consumer channel is full. */
+  Backpressure,
+  /*! \brief The initiation interval of the instruction is not passed yet. */
+  Throughput,
+  /*! \brief The temporal FU already issued another instruction in this cycle. */
+  Sharing,
+  Total
+};
+
+/*! \brief The text representative of a stall cause. */
+const char* StallName(Stall s);
+
+/*! \brief The statistics gathered by the simulator. */
+struct Stats {
+  /*! \brief The cycle at which the last event happened. */
+  uint64_t cycles{0};
+  /*! \brief The number of valid instructions fired in each sub-DFG. */
+  std::vector<int64_t> issued;
+  /*! \brief The number of vectors drained from the output ports of each sub-DFG. */
+  std::vector<int64_t> produced;
+  /*! \brief The failed attempts to fire of each sub-DFG, indexed by the cause. */
+  std::vector<std::vector<int64_t>> stalls;
+
+  /*! \brief The measured instructions per cycle of the given sub-DFG. */
+  double ipc(int group) const { return cycles ? (double) issued[group] / cycles : 0.0; }
+
+  void Dump(std::ostream& os) const;
+};
+
+/*!
+ * \brief A cycle-level simulator which runs a DFG with the latencies of its mapping.
+ *        Each DFG edge is a channel whose latency is the hops of its route plus the
+ *        delay FIFO, and whose capacity bounds the tokens in flight, so that a full
+ *        channel backpressures its producer. The IR is not mutated: all the dynamic
+ *        states live in the simulator. The core is event driven: a node is evaluated
+ *        only when something it waits for changes, and the idle cycles are skipped.
+ *        The nodes which depend on no input port would fire forever, so they fire only
+ *        while some data pushed to the input ports is not consumed yet.
+ */
+class Simulator {
+ public:
+  /*!
+   * \brief Build the channels from a mapping.
+   * \param sched The schedule to simulate. All the nodes and edges should be mapped.
+   */
+  Simulator(Schedule* sched);
+
+  /*!
+   * \brief Enqueue a vector to an input port.
+   * \param port The input port.
+   * \param data The 64-bit words of each value of the port.
+   * \param valid If these data are valid.
+   */
+  void Push(SSDfgVecInput* port, const std::vector<uint64_t>& data, bool valid = true);
+
+  /*!
+   * \brief Dequeue a vector from an output port.
+   * \param port The output port.
+   * \param data The words of each operand of the port.
+   * \param valid The predication of each operand of the port.
+   * \return False if no vector is produced yet.
+   */
+  bool Pop(SSDfgVecOutput* port, std::vector<uint64_t>& data, std::vector<bool>& valid);
+
+  /*!
+   * \brief Run until no event is pending, or the given cycle is reached.
+   * \param max_cycles The cycle limit.
+   * \return The current cycle.
+   */
+  uint64_t Run(uint64_t max_cycles = UINT64_MAX);
+
+  /*! \brief The current cycle. */
+  uint64_t cur_cycle() const { return now; }
+
+  /*! \brief If no event is pending. */
+  bool quiescent() const { return events.empty(); }
+
+  const Stats& stats() const { return _stats; }
+
+ private:
+  /*! \brief A bounded FIFO of the tokens carried by a DFG edge. */
+  struct Channel {
+    std::vector<Data> buffer;
+    int head{0}, size{0};
+    /*! \brief The cycles from the producer firing to the token available. */
+    int latency{0};
+    int l{0}, r{63};
+    int producer{-1}, consumer{-1};
+    /*! \brief If the tokens are derived from the input ports, so that they are pending. */
+    bool live{true};
+
+    bool full() const { return size == (int) buffer.size(); }
+    Data& front() { return buffer[head]; }
+    void push(const Data& d);
+    void pop();
+  };
+
+  /*! \brief The dynamic states of a DFG node. */
+  struct NodeState {
+    /*! \brief The hardware node it is mapped to. */
+    int hw{-1};
+    uint64_t last_fire{0};
+    bool fired{false};
+    /*! \brief The cycle this node was last evaluated, to deduplicate the events. */
+    uint64_t last_eval{UINT64_MAX};
+    /*! \brief The channels of each operand, and each value. */
+    std::vector<std::vector<int>> operands, values;
+    std::vector<uint64_t> reg;
+    /*! \brief If the node depends on no input port. */
+    bool free_running{false};
+    /*! \brief The round-robin value of a temporal input port. */
+    int current{0};
+    /*! \brief The vectors enqueued to an input port, or produced by an output port. */
+    std::deque<std::pair<std::vector<uint64_t>, std::vector<bool>>> queue;
+  };
+
+  /*! \brief Evaluate a node in the current cycle. */
+  void Evaluate(int nid);
+  bool FireInst(int nid);
+  bool FireInput(int nid);
+  bool FireOutput(int nid);
+
+  /*! \brief If all the operands are available; otherwise, wake up at the next arrival. */
+  bool OperandsReady(int nid);
+  /*! \brief If the given values have space in all the channels of their uses. */
+  bool ValuesWritable(int nid, int begin, int end);
+  /*! \brief Concatenate the head tokens of an operand. */
+  uint64_t Poll(int nid, int i, bool& valid);
+  /*! \brief Pop the head tokens of an operand, and wake up the producers. */
+  void Consume(int nid, int i);
+  /*! \brief Broadcast a value to the channels of its uses. */
+  void Produce(int nid, int i, uint64_t value, bool valid, int lat);
+
+  void Stalled(int nid, Stall s);
+  void Wake(uint64_t cycle, int nid);
+
+  Schedule* sched;
+  SSDfg* dfg;
+  std::vector<Channel> channels;
+  std::vector<NodeState> states;
+  /*! \brief The cycle at which each temporal FU can issue again. */
+  std::vector<uint64_t> fu_free;
+  /*!
+   * \brief The vectors queued in the input ports, and the tokens in the live channels.
+   *        The free-running nodes stop when it drops to zero.
+   */
+  int64_t pending{0};
+  /*! \brief The pending (cycle, node) events. */
+  std::priority_queue<std::pair<uint64_t, int>, std::vector<std::pair<uint64_t, int>>,
+                      std::greater<std::pair<uint64_t, int>>> events;
+  uint64_t now{0};
+  Stats _stats;
+  /*! \brief If the invalid outputs are discarded instead of pushed downstream. */
+  bool discard_invalid{getenv("DSCDIVLD") != nullptr};
+  /*! \brief The scratch buffers of the instruction execution. */
+  std::vector<uint64_t> inputs, outputs;
+  std::vector<bool> back_array;
+};
+
+}  // namespace simulation
+}  // namespace dsa
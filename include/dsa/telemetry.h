@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dsa {
+namespace telemetry {
+
+/*! \brief A record of the telemetry stream, a JSON object on a line, built field by field. */
+class Record {
+ public:
+  /*! \param type The kind of the record, as the "type" field. */
+  explicit Record(const char* type) {
+    line = "{";
+    Field("type", type);
+  }
+
+  Record& Field(const char* key, int64_t x) {
+    char buf[24];
+    return Raw(key, buf, snprintf(buf, sizeof buf, "%lld", (long long)x));
+  }
+  Record& Field(const char* key, int x) { return Field(key, (int64_t)x); }
+  Record& Field(const char* key, bool x) { return Raw(key, x ? "true" : "false", x ? 4 : 5); }
+  /*! \brief NaN and infinity are not JSON, so they are written as null. */
+  Record& Field(const char* key, double x) {
+    if (!std::isfinite(x)) return Raw(key, "null", 4);
+    char buf[32];
+    return Raw(key, buf, snprintf(buf, sizeof buf, "%.6g", x));
+  }
+  Record& Field(const char* key, const char* x);
+  Record& Field(const char* key, const std::string& x) { return Field(key, x.c_str()); }
+
+ private:
+  Record& Raw(const char* key, const char* value, int n);
+
+  std::string line;
+
+  friend class Sink;
+};
+
+/*!
+ * \brief A JSON-lines file the search loops emit records to. The records are buffered
+ *        and written by a background thread, so that the loops do not wait for the file.
+ */
+class Sink {
+ public:
+  explicit Sink(const std::string& filename);
+
+  /*! \brief Write the pending records, and close the file. */
+  ~Sink();
+
+  /*! \brief Queue a record to write. The content of the record is moved. */
+  void Emit(Record& record);
+
+ private:
+  void Writer();
+
+  FILE* _file;
+  std::mutex _lock;
+  std::condition_variable _cv;
+  std::vector<std::string> _pending;
+  bool _closing{false};
+  std::thread _writer;
+};
+
+}  // namespace telemetry
+}  // namespace dsa
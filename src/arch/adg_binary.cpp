@@ -0,0 +1,347 @@
+// The binary ADG format. A file is a header followed by flat tables, so that it can be
+// mapped into the memory and walked to construct the fabric without any parsing.
+//
+//   Header | nodes | links | adjacency | capabilities | operations | subnets | ints | chars
+//
+// All the tables are 8-byte aligned, and refer to each other by index.
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "dsa/arch/fabric.h"
+#include "dsa/arch/ssinst.h"
+#include "dsa/debug.h"
+#include "../utils/mapped_file.h"
+
+using namespace dsa;
+using mapped_file::MappedFile;
+using mapped_file::Section;
+
+namespace {
+
+const char kMagic[8] = {'D', 'S', 'A', 'A', 'D', 'G', '\0', '\0'};
+
+// Bump this whenever the layout of any table below changes.
+const uint32_t kVersion = 1;
+
+/*! \brief A slice of one of the tables. */
+struct Range {
+  uint32_t begin, size;
+};
+
+enum class NodeKind : int32_t { FU, Switch, VPort };
+
+struct NodeEntry {
+  NodeKind kind;
+  int32_t x, y;
+  int32_t decomposer, granularity, mf_decomposer, data_width;
+  int32_t max_util, flow_control, bitwidth;
+  /*! \brief The max FIFO depth of a switch, or the delay FIFO depth of an FU. */
+  int32_t fifo_depth;
+  int32_t register_file_size;
+  /*! \brief The index in the capability table of an FU, -1 for the others. */
+  int32_t capability;
+  /*! \brief The port number of a vector port, and if it is registered as an input (1),
+   *         an output (0), or not registered (-1). */
+  int32_t port, is_input;
+  /*! \brief The node type string, in the char table. */
+  Range node_type;
+  /*! \brief The ids of {output, input} links, in the adjacency table. */
+  Range links[2];
+  /*! \brief The port vector of a vector port, in the int table. */
+  Range port_vec;
+};
+
+struct LinkEntry {
+  int32_t orig, dest;
+  int32_t max_util, flow_control, bitwidth, decomp_bitwidth;
+  /*! \brief The subnet masks, in the subnet table. */
+  Range subnet;
+};
+
+struct CapabilityEntry {
+  /*! \brief The name, in the char table. */
+  Range name;
+  /*! \brief The operations, in the operation table. */
+  Range ops;
+};
+
+struct OperationEntry {
+  /*! \brief The opcode is kept by name, so that a file survives changes of the ISA. */
+  Range name;
+  int32_t encoding, count;
+};
+
+struct Header {
+  char magic[8];
+  uint32_t version;
+  int32_t sizex, sizey;
+  /*! \brief The indices of the FU types of the model in the capability table. */
+  Range fu_types;
+  Section nodes, links, adjacency, capabilities, operations, subnets, ints, chars;
+};
+
+uint64_t Align(uint64_t x) { return (x + 7) & ~7ull; }
+
+/*! \brief Accumulates the tables in the memory, before they are written at once. */
+struct Writer {
+  std::vector<NodeEntry> nodes;
+  std::vector<LinkEntry> links;
+  std::vector<int32_t> adjacency;
+  std::vector<CapabilityEntry> capabilities;
+  std::vector<OperationEntry> operations;
+  std::vector<int64_t> subnets;
+  std::vector<int32_t> ints;
+  std::vector<char> chars;
+  /*! \brief Deduplicate capabilities by their content, since FUs of a type share one. */
+  std::map<std::string, int> capability_index;
+
+  template <typename T, typename U>
+  Range Append(std::vector<T>& table, const U& data) {
+    Range res{(uint32_t)table.size(), (uint32_t)data.size()};
+    table.insert(table.end(), data.begin(), data.end());
+    return res;
+  }
+
+  int AddCapability(const Capability& cap) {
+    std::string key = cap.name;
+    for (auto& elem : cap.capability) {
+      key += "," + std::to_string(elem.op) + ":" + std::to_string(elem.encoding) + ":" +
+             std::to_string(elem.count);
+    }
+    auto iter = capability_index.find(key);
+    if (iter != capability_index.end()) {
+      return iter->second;
+    }
+    CapabilityEntry entry;
+    entry.name = Append(chars, cap.name);
+    entry.ops.begin = operations.size();
+    entry.ops.size = cap.capability.size();
+    for (auto& elem : cap.capability) {
+      OperationEntry op;
+      op.name = Append(chars, std::string(dsa::name_of_inst(elem.op)));
+      op.encoding = elem.encoding;
+      op.count = elem.count;
+      operations.push_back(op);
+    }
+    capabilities.push_back(entry);
+    return capability_index[key] = capabilities.size() - 1;
+  }
+
+  template <typename T>
+  Section Write(std::ofstream& os, const std::vector<T>& table) {
+    Section res{(uint64_t)os.tellp(), table.size()};
+    os.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(T));
+    static const char zeros[8] = {0};
+    os.write(zeros, Align(os.tellp()) - (uint64_t)os.tellp());
+    return res;
+  }
+};
+
+}  // namespace
+
+void SpatialFabric::DumpHwInBinary(const char* name, const std::vector<Capability*>& fu_types) {
+  CHECK(is_compact()) << "Compact the fabric before dumping it!";
+  std::ofstream os(name, std::ios::binary);
+  std::cout << "Hardware binary file: " << name << std::endl;
+  if (!os.good()) {
+    return;
+  }
+
+  Writer w;
+  for (auto* node : _node_list) {
+    NodeEntry entry;
+    memset(&entry, 0, sizeof entry);
+    entry.x = node->_x;
+    entry.y = node->_y;
+    entry.decomposer = node->decomposer;
+    entry.granularity = node->granularity;
+    entry.mf_decomposer = node->mf_decomposer;
+    entry.data_width = node->data_width;
+    entry.max_util = node->_max_util;
+    entry.flow_control = node->_flow_control;
+    entry.bitwidth = node->_bitwidth;
+    entry.capability = -1;
+    entry.port = -1;
+    entry.is_input = -1;
+    entry.node_type = w.Append(w.chars, node->node_type);
+    for (int i = 0; i < 2; ++i) {
+      entry.links[i] = w.Append(w.adjacency, node->links[i]);
+    }
+    if (auto* fu = dynamic_cast<ssfu*>(node)) {
+      entry.kind = NodeKind::FU;
+      entry.fifo_depth = fu->_delay_fifo_depth;
+      entry.register_file_size = fu->register_file_size;
+      entry.capability = w.AddCapability(fu->fu_type_);
+    } else if (auto* sw = dynamic_cast<ssswitch*>(node)) {
+      entry.kind = NodeKind::Switch;
+      entry.fifo_depth = sw->max_fifo_depth;
+    } else {
+      auto* vport = dynamic_cast<ssvport*>(node);
+      CHECK(vport) << node->name() << " has unknown type";
+      entry.kind = NodeKind::VPort;
+      entry.port = vport->port();
+      for (int i = 0; i < 2; ++i) {
+        auto iter = _ssio_interf.vports_map[i].find(vport->port());
+        if (iter != _ssio_interf.vports_map[i].end() && iter->second == vport) {
+          entry.is_input = i;
+        }
+      }
+      entry.port_vec = w.Append(w.ints, vport->port_vec());
+    }
+    w.nodes.push_back(entry);
+  }
+
+  for (auto* link : _link_list) {
+    LinkEntry entry;
+    entry.orig = link->_orig;
+    entry.dest = link->_dest;
+    entry.max_util = link->_max_util;
+    entry.flow_control = link->_flow_control;
+    entry.bitwidth = link->_bitwidth;
+    entry.decomp_bitwidth = link->_decomp_bitwidth;
+    entry.subnet = w.Append(w.subnets, link->subnet);
+    w.links.push_back(entry);
+  }
+
+  std::vector<int32_t> types;
+  for (auto* elem : fu_types) {
+    types.push_back(w.AddCapability(*elem));
+  }
+
+  Header header;
+  memset(&header, 0, sizeof header);
+  memcpy(header.magic, kMagic, sizeof kMagic);
+  header.version = kVersion;
+  header.sizex = _sizex;
+  header.sizey = _sizey;
+  header.fu_types = w.Append(w.ints, types);
+  // Write a placeholder first, and the header with all the offsets at last.
+  os.write(reinterpret_cast<const char*>(&header), sizeof header);
+  os.write(std::string(Align(sizeof header) - sizeof header, '\0').data(),
+           Align(sizeof header) - sizeof header);
+  header.nodes = w.Write(os, w.nodes);
+  header.links = w.Write(os, w.links);
+  header.adjacency = w.Write(os, w.adjacency);
+  header.capabilities = w.Write(os, w.capabilities);
+  header.operations = w.Write(os, w.operations);
+  header.subnets = w.Write(os, w.subnets);
+  header.ints = w.Write(os, w.ints);
+  header.chars = w.Write(os, w.chars);
+  os.seekp(0);
+  os.write(reinterpret_cast<const char*>(&header), sizeof header);
+}
+
+void SpatialFabric::parse_binary(const std::string& filename,
+                                 std::vector<Capability*>* fu_types) {
+  CHECK(_node_list.empty() && _link_list.empty()) << "Only an empty fabric can be loaded";
+
+  MappedFile file(filename);
+  CHECK(file.size >= sizeof(Header)) << filename << " is too small to be a binary ADG";
+  Header header;
+  memcpy(&header, file.data, sizeof header);
+  CHECK(memcmp(header.magic, kMagic, sizeof kMagic) == 0)
+      << filename << " is not a binary ADG";
+  CHECK(header.version == kVersion)
+      << filename << " is of version " << header.version << ", but " << kVersion
+      << " is expected. Convert it again.";
+
+  auto* nodes = file.Table<NodeEntry>(header.nodes);
+  auto* links = file.Table<LinkEntry>(header.links);
+  auto* adjacency = file.Table<int32_t>(header.adjacency);
+  auto* capabilities = file.Table<CapabilityEntry>(header.capabilities);
+  auto* operations = file.Table<OperationEntry>(header.operations);
+  auto* subnets = file.Table<int64_t>(header.subnets);
+  auto* ints = file.Table<int32_t>(header.ints);
+  auto* chars = file.Table<char>(header.chars);
+
+  auto str = [chars](const Range& r) { return std::string(chars + r.begin, r.size); };
+  auto vec = [](const auto* table, const Range& r) {
+    return std::vector<std::decay_t<decltype(*table)>>(table + r.begin,
+                                                        table + r.begin + r.size);
+  };
+
+  // Only the distinct capabilities are decoded, and then copied to each FU.
+  std::vector<Capability> caps(header.capabilities.size);
+  for (size_t i = 0; i < caps.size(); ++i) {
+    caps[i].name = str(capabilities[i].name);
+    caps[i].capability.clear();
+    for (uint32_t j = 0; j < capabilities[i].ops.size; ++j) {
+      auto& op = operations[capabilities[i].ops.begin + j];
+      caps[i].capability.emplace_back(inst_from_string(str(op.name).c_str()), op.encoding,
+                                      op.count);
+    }
+  }
+
+  _sizex = header.sizex;
+  _sizey = header.sizey;
+
+  for (uint64_t i = 0; i < header.nodes.size; ++i) {
+    auto& entry = nodes[i];
+    ssnode* node = nullptr;
+    switch (entry.kind) {
+      case NodeKind::FU: {
+        CHECK(entry.capability >= 0 && entry.capability < (int)caps.size());
+        auto* fu = add_fu();
+        fu->_delay_fifo_depth = entry.fifo_depth;
+        fu->register_file_size = entry.register_file_size;
+        fu->fu_type_ = caps[entry.capability];
+        node = fu;
+        break;
+      }
+      case NodeKind::Switch: {
+        auto* sw = add_switch();
+        sw->max_fifo_depth = entry.fifo_depth;
+        node = sw;
+        break;
+      }
+      case NodeKind::VPort: {
+        auto* vport = entry.is_input == -1 ? add_vport(false)
+                                           : add_vport(entry.is_input, entry.port);
+        vport->set_port(entry.port);
+        vport->set_port_vec(vec(ints, entry.port_vec));
+        node = vport;
+        break;
+      }
+      default:
+        CHECK(false) << "Node " << i << " has unknown type " << (int)entry.kind;
+    }
+    node->setXY(entry.x, entry.y);
+    node->decomposer = entry.decomposer;
+    node->granularity = entry.granularity;
+    node->mf_decomposer = entry.mf_decomposer;
+    node->data_width = entry.data_width;
+    node->_max_util = entry.max_util;
+    node->_flow_control = entry.flow_control;
+    node->_bitwidth = entry.bitwidth;
+    node->node_type = str(entry.node_type);
+    for (int j = 0; j < 2; ++j) {
+      node->links[j] = vec(adjacency, entry.links[j]);
+    }
+  }
+
+  for (uint64_t i = 0; i < header.links.size; ++i) {
+    auto& entry = links[i];
+    CHECK(entry.orig >= 0 && entry.orig < (int)_node_list.size() && entry.dest >= 0 &&
+          entry.dest < (int)_node_list.size())
+        << "Link " << i << " connects nodes out of range";
+    auto* link = new_link(_node_list[entry.orig], _node_list[entry.dest]);
+    link->_max_util = entry.max_util;
+    link->_flow_control = entry.flow_control;
+    link->_bitwidth = entry.bitwidth;
+    link->_decomp_bitwidth = entry.decomp_bitwidth;
+    link->subnet = vec(subnets, entry.subnet);
+  }
+
+  _ssio_interf.fill_vec();
+
+  if (fu_types) {
+    for (int32_t i : vec(ints, header.fu_types)) {
+      fu_types->push_back(new Capability(caps[i]));
+    }
+  }
+}
@@ -2,6 +2,7 @@
 
 #include "dsa/debug.h"
 #include "dsa/arch/estimation.h"
+#include "dsa/arch/predict.h"
 #include "dsa/arch/visitor.h"
 
 namespace dsa {
@@ -65,6 +66,11 @@ struct Estimator : Visitor {
   }
 
   void Visit(ssswitch *sw) {
+    if (model == Model::Predictor) {
+      double *features = sw->collect_features();
+      sw_features.insert(sw_features.end(), features, features + 9);
+      return;
+    }
     for (int i = 0; i < 2; ++i) {
       res((Metric) i, Breakdown::Network) += RadixEst((Metric) i, sw->in_links().size(),
                                                       sw->out_links().size(),
@@ -86,6 +92,11 @@ struct Estimator : Visitor {
   void Visit(ssfu *fu) {
     res(Metric::Area, Breakdown::FU) += fu->fu_type_.area();
     res(Metric::Power, Breakdown::FU) += fu->fu_type_.power();
+    if (model == Model::Predictor) {
+      double *features = fu->collect_features();
+      fu_features.insert(fu_features.end(), features, features + 12);
+      return;
+    }
     for (int i = 0; i < 2; ++i) {
       res((Metric) i, Breakdown::Network) += RadixEst((Metric) i, 2, fu->in_links().size(),
                                                       fu->decomposer, fu->flow_control());
@@ -95,13 +106,41 @@ struct Estimator : Visitor {
     }
   }
 
+  /*! \brief Evaluate the predictors on the features collected from all the switches and FUs. */
+  void Predict() {
+    int n_sw = sw_features.size() / 9;
+    int n_fu = fu_features.size() / 12;
+    std::vector<double> buffer(std::max(n_sw, n_fu));
+    auto accumulate = [this, &buffer](int n, Metric metric) {
+      for (int i = 0; i < n; ++i) {
+        res(metric, Breakdown::Network) += buffer[i];
+      }
+    };
+    router_area_predict_batch(sw_features.data(), n_sw, buffer.data());
+    accumulate(n_sw, Metric::Area);
+    router_power_predict_batch(sw_features.data(), n_sw, buffer.data());
+    accumulate(n_sw, Metric::Power);
+    pe_area_predict_batch(fu_features.data(), n_fu, buffer.data());
+    accumulate(n_fu, Metric::Area);
+    pe_power_predict_batch(fu_features.data(), n_fu, buffer.data());
+    accumulate(n_fu, Metric::Power);
+  }
+
   SSModel *arch;
+  Model model{Model::Analytical};
   Result res;
+  /*! \brief The features of switches and FUs, 9 and 12 per node, to be predicted in batch. */
+  std::vector<double> sw_features;
+  std::vector<double> fu_features;
 };
 
-Result EstimatePowerAera(SSModel *arch) {
+Result EstimatePowerAera(SSModel *arch, Model model) {
   Estimator estimator(arch);
+  estimator.model = model;
   arch->subModel()->Apply(&estimator);
+  if (model == Model::Predictor) {
+    estimator.Predict();
+  }
   return estimator.res;
 }
 
@@ -1,4 +1,5 @@
 
+#include <algorithm>
 #include <cassert>
 
 #include <fstream>
@@ -11,6 +12,8 @@
 #include "dsa/arch/visitor.h"
 #include "dsa/arch/fabric.h"
 #include "dsa/debug.h"
+#include "dsa/profile.h"
+#include "../utils/json_parsing.h"
 #include "../utils/model_parsing.h"
 #include "dsa/arch/sub_model.h"
 
@@ -25,24 +28,14 @@ using namespace std;
 
 // ----------------------- sslink ---------------------------------------------
 
-bool sslink::flow_control() { return _dest->flow_control(); }
+bool sslink::flow_control() { return dest()->flow_control(); }
 
 std::string sslink::name() const {
   std::stringstream ss;
-  ss << _orig->name() << "_to_" << _dest->name();
+  ss << orig()->name() << "_to_" << dest()->name();
   return ss.str();
 }
 
-sslink::~sslink() {
-  auto f = [this](std::vector<sslink*>& links) {
-    auto iter = std::find(links.begin(), links.end(), this);
-    assert(iter != links.end() && "Cannot find this link!");
-    links.erase(iter);
-  };
-  f(orig()->links[0]);
-  f(dest()->links[1]);
-}
-
 // ---------------------- ssswitch --------------------------------------------
 
 void parse_list_of_ints(std::istream& istream, std::vector<int>& int_vec) {
@@ -263,15 +256,67 @@ void SpatialFabric::PrintGraphviz(ostream& os) {
   os << "}\n";
 }
 
+void SpatialFabric::DumpHwInJson(const char* name, bool compact) {
+  PROFILE_SCOPE(DumpJson);
+  CHECK(is_compact()) << "Compact the fabric before dumping it!";
+  JSONWriter w(name, compact);
+  std::cout << "Hardware JSON file: " << name << std::endl;
+  if (!w.good()) {
+    return;
+  }
+
+  w.BeginObject();
+
+  // Instruction Set
+  int start_enc = 3;
+  std::set<OpCode> ss_inst_set;
+  for (auto* fu : fu_list()) {
+    for (auto &elem : fu->fu_type_.capability) {
+      ss_inst_set.insert(elem.op);
+    }
+  }
+  w.Key("Instruction Set").BeginObject();
+  for (OpCode inst : ss_inst_set) {
+    w.Field(dsa::name_of_inst(inst), start_enc++);
+  }
+  w.EndObject();
+
+  // Links
+  w.Key("links").BeginArray();
+  for (auto link : link_list()) {
+    if (compact) {
+      w.BeginArray();
+      link->orig()->dumpIdentifier(w);
+      link->dest()->dumpIdentifier(w);
+      w.EndArray();
+    } else {
+      w.BeginObject();
+      link->orig()->dumpIdentifier(w.Key("source"));
+      link->dest()->dumpIdentifier(w.Key("sink"));
+      w.EndObject();
+    }
+  }
+  w.EndArray();
+
+  // Nodes
+  w.Key("nodes").BeginArray();
+  for (auto node : node_list()) {
+    node->dumpFeatures(w);
+  }
+  w.EndArray();
+
+  w.EndObject();
+}
+
 void SpatialFabric::Apply(adg::Visitor *visitor) {
   for (auto &elem : node_list()) {
-    elem->Accept(visitor);
+    if (elem) elem->Accept(visitor);
   }
 }
 
 void SpatialFabric::clear_all_runtime_vals() {
   for (ssnode* n : _node_list) {
-    n->reset_runtime_vals();
+    if (n) n->reset_runtime_vals();
   }
 }
 
@@ -301,10 +346,9 @@ void SpatialFabric::build_substrate(int sizex, int sizey) {
 }
 
 sslink* ssnode::add_link(ssnode* node) {
-  sslink* link = new sslink(this, node);
   CHECK(this != node) << "Cycle link is not allowed! " << id() << " " << node->id();
-  auto& olinks = links[0];
-  olinks.push_back(link);
+  sslink* link = static_cast<SpatialFabric*>(parent)->new_link(this, node);
+  links[0].push_back(link->id());
 
   link->subnet.resize(link->bitwidth() / 8);
   link->subnet[0] = ~0ull >> (64 - link->bitwidth());
@@ -312,7 +356,7 @@ sslink* ssnode::add_link(ssnode* node) {
 
   LOG(SUBNET) << link->subnet[0] << link->subnet[1] << "\n";
 
-  node->links[1].push_back(link);
+  node->links[1].push_back(link->id());
   return link;
 }
 
@@ -485,25 +529,137 @@ void ssio_interface::fill_vec() {
 void SpatialFabric::post_process() {
 
   struct Aggreator : dsa::adg::Visitor {
-    std::vector<sslink*> &links;
-    Aggreator(std::vector<sslink*> &links_) : links(links_) {
-      links.clear();
-    }
+    std::vector<int> &remap;
+    int cnt{0};
+    Aggreator(std::vector<int> &remap_) : remap(remap_) {}
     void Visit(ssnode *node) override {
       for (auto &elem : node->out_links()) {
-        int x = links.size();
-        links.push_back(elem);
-        links.back()->set_id(x);
+        remap[elem->id()] = cnt++;
       }
     }
   };
 
-  Aggreator aggreator(_link_list);
+  std::vector<int> remap(_link_list.size(), -1);
+  Aggreator aggreator(remap);
   Apply(&aggreator);
+  remap_links(remap);
 
   _ssio_interf.fill_vec();
 }
 
+void SpatialFabric::reindex(int num_nodes, int num_links) {
+  _node_list.assign(num_nodes, nullptr);
+  _link_list.assign(num_links, nullptr);
+  auto f = [this](ssnode &node) {
+    node.parent = this;
+    if (node.id() != -1) {
+      _node_list[node.id()] = &node;
+    }
+  };
+  for (auto &elem : _fu_arena) f(elem);
+  for (auto &elem : _switch_arena) f(elem);
+  for (auto &elem : _vport_arena) f(elem);
+  for (auto &elem : _link_arena) {
+    elem.parent = this;
+    if (elem.id() != -1) {
+      _link_list[elem.id()] = &elem;
+    }
+  }
+}
+
+void SpatialFabric::remap_nodes(const std::vector<int> &remap) {
+  int n = 0;
+  for (int elem : remap) n += elem != -1;
+  std::vector<ssnode*> nodes(n);
+  for (auto *node : _node_list) {
+    if (!node) continue;
+    int to = remap[node->id()];
+    node->set_id(to);
+    if (to != -1) {
+      nodes[to] = node;
+    }
+  }
+  _node_list = nodes;
+  _node_free.clear();
+  // Links to the deleted nodes are expected to be deleted before.
+  for (auto *link : _link_list) {
+    if (!link) continue;
+    if (link->_orig != -1) link->_orig = remap[link->_orig];
+    if (link->_dest != -1) link->_dest = remap[link->_dest];
+  }
+}
+
+void SpatialFabric::remap_links(const std::vector<int> &remap) {
+  int n = 0;
+  for (int elem : remap) n += elem != -1;
+  std::vector<sslink*> links(n);
+  for (auto *link : _link_list) {
+    if (!link) continue;
+    int to = remap[link->id()];
+    link->set_id(to);
+    if (to != -1) {
+      links[to] = link;
+    }
+  }
+  _link_list = links;
+  _link_free.clear();
+  for (auto *node : _node_list) {
+    if (!node) continue;
+    for (auto &ids : node->links) {
+      int j = 0;
+      for (int id : ids) {
+        if (remap[id] != -1) {
+          ids[j++] = remap[id];
+        }
+      }
+      ids.resize(j);
+    }
+  }
+}
+
+void SpatialFabric::delete_nodes(const std::vector<int> &v) {
+  for (int id : v) {
+    // The same node can be deleted more than once.
+    if (auto *node = _node_list[id]) {
+      CHECK(node->links[0].empty() && node->links[1].empty())
+        << node->name() << " is deleted with its links left";
+      node->set_id(-1);
+      _node_list[id] = nullptr;
+      _node_free.push_back(id);
+    }
+  }
+}
+
+void SpatialFabric::delete_links(const std::vector<int> &v) {
+  for (int id : v) {
+    // The same link can be deleted more than once.
+    if (auto *link = _link_list[id]) {
+      auto &out = link->orig()->links[0];
+      out.erase(std::find(out.begin(), out.end(), id));
+      auto &in = link->dest()->links[1];
+      in.erase(std::find(in.begin(), in.end(), id));
+      link->set_id(-1);
+      _link_list[id] = nullptr;
+      _link_free.push_back(id);
+    }
+  }
+}
+
+std::pair<std::vector<int>, std::vector<int>> SpatialFabric::compact() {
+  std::pair<std::vector<int>, std::vector<int>> res;
+  auto f = [](const auto &table, std::vector<int> &remap) {
+    remap.resize(table.size());
+    for (int i = 0, j = 0, n = table.size(); i < n; ++i) {
+      remap[i] = table[i] ? j++ : -1;
+    }
+  };
+  f(_node_list, res.first);
+  f(_link_list, res.second);
+  remap_nodes(res.first);
+  remap_links(res.second);
+  return res;
+}
+
 int ssnode::num_node() {
   return parent->node_list().size();
 }
@@ -588,9 +744,16 @@ struct JSONModel : json::BaseVisitor{
   void linksVisit(json::BaseNode * jsonNodes){
     // Go over all links
     for (auto &jsonNode : *jsonNodes->As<plain::Array>()){
-      plain::Object cgralink = *jsonNode->As<plain::Object>();
-      auto source = *cgralink["source"]->As<plain::Array>();
-      auto sink = *cgralink["sink"]->As<plain::Array>();
+      plain::Array source, sink;
+      if (auto tuple = jsonNode->As<plain::Array>()) {
+        // The compact form of [source, sink]
+        source = *(*tuple)[0]->As<plain::Array>();
+        sink = *(*tuple)[1]->As<plain::Array>();
+      } else {
+        plain::Object cgralink = *jsonNode->As<plain::Object>();
+        source = *cgralink["source"]->As<plain::Array>();
+        sink = *cgralink["sink"]->As<plain::Array>();
+      }
       int source_id = *source[0]->As<int64_t>();
       int sink_id = *sink[0]->As<int64_t>();
       
@@ -611,12 +774,8 @@ struct JSONModel : json::BaseVisitor{
 };
 
 void SpatialFabric::parse_json(const std::string filename){
-  FILE *fjson = fopen(filename.c_str(), "r");
-  struct params p;
-  JSONrestart(fjson);
-  JSONparse(&p);
+  json::BaseNode *root = json_parsing::Parse(filename);
   JSONModel modeler(this);
-  p.data->Accept(&modeler);
-  fclose(fjson);
-  delete p.data;
+  root->Accept(&modeler);
+  delete root;
 }
@@ -146,6 +146,13 @@ SSModel::SSModel(const char *filename_) : filename(filename_) {
     return;
   }
 
+  // Load the binary ADG, which is already laid out as the fabric
+  if (string_utils::String(filename).EndsWith(".adg.bin")) {
+    _subModel = new SpatialFabric();
+    _subModel->parse_binary(filename, &fu_types);
+    return;
+  }
+
   // Parse the JSON-format IR
   if (string_utils::String(filename).EndsWith(".json")) {
     _subModel = new SpatialFabric();
@@ -15,6 +15,11 @@ using ConstDataEntry = dsa::dfg::ConstDataEntry;
 using ValueEntry = dsa::dfg::ValueEntry;
 using EdgeType = dsa::dfg::OperandType;
 
+#ifndef YY_TYPEDEF_YY_SCANNER_T
+#define YY_TYPEDEF_YY_SCANNER_T
+typedef void* yyscan_t;
+#endif
+
 }
 
 %{
@@ -28,20 +33,24 @@ using EdgeType = dsa::dfg::OperandType;
 #include <map>
 #include <tuple>
 
-extern int yylineno;
-void yyrestart(FILE *); 
-
+// All the states of a parse, so that DFGs can be parsed in parallel.
 struct parse_param {
   SSDfg* dfg;
   dsa::dfg::MetaPort meta;
   dsa::dfg::SymbolTable symbols;
 };
 
-int yylex();     
-static void yyerror(parse_param*, const char *); 
+int yylex(YYSTYPE* lval, yyscan_t scanner);
+int yylex_init(yyscan_t* scanner);
+int yylex_destroy(yyscan_t scanner);
+void yyset_in(FILE* in, yyscan_t scanner);
+int yyget_lineno(yyscan_t scanner);
+static void yyerror(parse_param*, yyscan_t, const char *);
 %}
 
-%parse-param {struct parse_param* p}
+%define api.pure full
+%lex-param {yyscan_t scanner}
+%parse-param {struct parse_param* p} {yyscan_t scanner}
 
 %union {
   uint64_t i;
@@ -422,13 +431,17 @@ int parse_dfg(const char* filename, SSDfg* _dfg) {
   struct parse_param p;
   p.dfg = _dfg;
 
-  yyrestart(dfg_file);
-  yyparse(&p);
+  yyscan_t scanner;
+  yylex_init(&scanner);
+  yyset_in(dfg_file, scanner);
+  yyparse(&p, scanner);
+  yylex_destroy(scanner);
+  fclose(dfg_file);
   return 0;
 }
 
 
-static void yyerror(struct parse_param* p, char const* s) {
-  fprintf(stderr, "Error parsing DFG at line %d: %s\n", yylineno, s);
+static void yyerror(struct parse_param* p, yyscan_t scanner, char const* s) {
+  fprintf(stderr, "Error parsing DFG at line %d: %s\n", yyget_lineno(scanner), s);
   assert(0);
 }
@@ -0,0 +1,392 @@
+// The binary DFG format. A file is a header followed by flat tables, so that it can be
+// mapped into the memory and walked to construct the DFG without any parsing.
+//
+//   Header | groups | nodes | values | operands | edges | ints | chars
+//
+// All the tables are 8-byte aligned, and refer to each other by index. The header
+// optionally carries a hash of everything after it, which is checked on load.
+
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "dsa/arch/ssinst.h"
+#include "dsa/debug.h"
+#include "dsa/dfg/metadata.h"
+#include "dsa/dfg/utils.h"
+#include "../utils/mapped_file.h"
+
+namespace dsa {
+namespace dfg {
+
+namespace {
+
+using mapped_file::MappedFile;
+using mapped_file::Section;
+
+const char kMagic[8] = {'D', 'S', 'A', 'D', 'F', 'G', '\0', '\0'};
+
+// Bump this whenever the layout of any table below changes.
+const uint32_t kVersion = 1;
+
+/*! \brief A slice of one of the tables. */
+struct Range {
+  uint32_t begin, size;
+};
+
+struct GroupEntry {
+  int64_t is_temporal, frequency, unroll;
+};
+
+enum class NodeKind : int32_t { Inst, VecInput, VecOutput };
+
+struct NodeEntry {
+  /*! \brief The predication masks of an instruction. */
+  uint64_t ctrl, self;
+  /*! \brief The memory command coefficients of a vector port. */
+  double cmd, repeat;
+  NodeKind kind;
+  int32_t group;
+  /*! \brief If the predications depend on the control operand. */
+  int32_t ctrl_dynamic, self_dynamic;
+  /*! \brief The element bitwidth, the port width, and the length of a vector port. */
+  int32_t bitwidth, port_width, vp_len;
+  /*! \brief The MetaPort of a vector port, except the fields in the ranges below. */
+  int32_t source, dest, op, conc;
+  /*! \brief The name, and the destination port, in the char table. */
+  Range name, dest_port;
+  /*! \brief The opcode is kept by name, so that a file survives changes of the ISA. */
+  Range opcode;
+  /*! \brief The values in the value table, and the operands in the operand table. */
+  Range values, operands;
+};
+
+struct OperandEntry {
+  uint64_t imm;
+  int32_t type;
+  /*! \brief The ids of the concatenated edges, in the int table. */
+  Range edges;
+};
+
+struct EdgeEntry {
+  int32_t id, sid, vid, uid, l, r, buf_len, delay;
+};
+
+struct Header {
+  char magic[8];
+  uint32_t version;
+  int32_t num_nodes;
+  /*! \brief The FNV-1a hash of all the bytes after the header, 0 if it is not computed. */
+  uint64_t hash;
+  Section groups, nodes, values, operands, edges, ints, chars;
+};
+
+uint64_t Align(uint64_t x) { return (x + 7) & ~7ull; }
+
+uint64_t Hash(const char* data, uint64_t size) {
+  uint64_t res = 14695981039346656037ull;
+  for (uint64_t i = 0; i < size; ++i) {
+    res = (res ^ (uint8_t)data[i]) * 1099511628211ull;
+  }
+  // 0 is reserved for the files without a hash.
+  return res ? res : 1;
+}
+
+/*! \brief Accumulates the tables in the memory, before they are written at once. */
+struct Writer {
+  std::vector<GroupEntry> groups;
+  std::vector<NodeEntry> nodes;
+  /*! \brief The uses of each value, in the int table. */
+  std::vector<Range> values;
+  std::vector<OperandEntry> operands;
+  std::vector<EdgeEntry> edges;
+  std::vector<int32_t> ints;
+  std::vector<char> chars;
+  /*! \brief The payload after the header. */
+  std::string buffer;
+
+  template <typename T, typename U>
+  Range Append(std::vector<T>& table, const U& data) {
+    Range res{(uint32_t)table.size(), (uint32_t)data.size()};
+    table.insert(table.end(), data.begin(), data.end());
+    return res;
+  }
+
+  template <typename T>
+  Section Write(const std::vector<T>& table) {
+    Section res{Align(sizeof(Header)) + buffer.size(), table.size()};
+    buffer.append(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(T));
+    buffer.resize(Align(buffer.size()), '\0');
+    return res;
+  }
+};
+
+/*! \brief Restore the predication mask, and mark it dynamic by setting its B1/B2 bits again. */
+CtrlBits DecodeCtrl(uint64_t mask, bool dynamic) {
+  CtrlBits res(mask);
+  if (dynamic) {
+    for (int loc = 0; loc < 64; ++loc) {
+      auto b = (CtrlBits::Control)(loc % CtrlBits::Total);
+      if ((mask >> loc & 1) && (b == CtrlBits::B1 || b == CtrlBits::B2)) {
+        res.set(loc / CtrlBits::Total, b);
+      }
+    }
+  }
+  return res;
+}
+
+}  // namespace
+
+void ExportBinary(SSDfg* dfg, const std::string& fname, bool hash) {
+  Writer w;
+  for (int i = 0; i < dfg->num_groups(); ++i) {
+    auto& prop = dfg->group_prop(i);
+    w.groups.push_back({prop.is_temporal, prop.frequency, prop.unroll});
+  }
+
+  for (int i = 0, n = dfg->nodes.size(); i < n; ++i) {
+    auto* node = dfg->nodes[i];
+    CHECK(node->id() == i) << node->id() << " != " << i;
+    NodeEntry entry;
+    memset(&entry, 0, sizeof entry);
+    entry.group = node->group_id();
+    if (auto* inst = dynamic_cast<SSDfgInst*>(node)) {
+      entry.kind = NodeKind::Inst;
+      entry.ctrl = inst->predicate.bits();
+      entry.self = inst->self_predicate.bits();
+      entry.ctrl_dynamic = inst->predicate.is_dynamic;
+      entry.self_dynamic = inst->self_predicate.is_dynamic;
+      entry.opcode = w.Append(w.chars, std::string(name_of_inst(inst->inst())));
+      // The name of an instruction is decorated with its opcode and id.
+      CHECK(inst->name().find('(') != std::string::npos);
+      entry.name = w.Append(w.chars, inst->name().substr(0, inst->name().rfind('(')));
+    } else {
+      auto* vec = dynamic_cast<SSDfgVec*>(node);
+      CHECK(vec) << node->name() << " has unknown type";
+      entry.kind = dynamic_cast<SSDfgVecInput*>(vec) ? NodeKind::VecInput : NodeKind::VecOutput;
+      entry.bitwidth = vec->bitwidth();
+      entry.port_width = vec->get_port_width();
+      entry.vp_len = vec->get_vp_len();
+      entry.source = (int)vec->meta.source;
+      entry.dest = (int)vec->meta.dest;
+      entry.op = vec->meta.op;
+      entry.conc = vec->meta.conc;
+      entry.cmd = vec->meta.cmd;
+      entry.repeat = vec->meta.repeat;
+      entry.dest_port = w.Append(w.chars, vec->meta.dest_port);
+      entry.name = w.Append(w.chars, vec->name());
+    }
+    entry.values.begin = w.values.size();
+    entry.values.size = node->values.size();
+    for (auto& value : node->values) {
+      w.values.push_back(w.Append(w.ints, value.uses));
+    }
+    entry.operands.begin = w.operands.size();
+    entry.operands.size = node->ops().size();
+    for (auto& operand : node->ops()) {
+      OperandEntry op;
+      memset(&op, 0, sizeof op);
+      op.imm = operand.imm;
+      op.type = (int)operand.type;
+      op.edges = w.Append(w.ints, operand.edges);
+      w.operands.push_back(op);
+    }
+    w.nodes.push_back(entry);
+  }
+
+  for (auto& edge : dfg->edges) {
+    w.edges.push_back(
+        {edge.id, edge.sid, edge.vid, edge.uid, edge.l, edge.r, edge.buf_len, edge.delay});
+  }
+
+  Header header;
+  memset(&header, 0, sizeof header);
+  memcpy(header.magic, kMagic, sizeof kMagic);
+  header.version = kVersion;
+  header.num_nodes = dfg->nodes.size();
+  header.groups = w.Write(w.groups);
+  header.nodes = w.Write(w.nodes);
+  header.values = w.Write(w.values);
+  header.operands = w.Write(w.operands);
+  header.edges = w.Write(w.edges);
+  header.ints = w.Write(w.ints);
+  header.chars = w.Write(w.chars);
+  if (hash) {
+    header.hash = Hash(w.buffer.data(), w.buffer.size());
+  }
+
+  // Written to a temporary file and renamed, so that a failed write, e.g. on a full disk,
+  // never leaves a truncated file, which would be newer than the json dumped beside it.
+  static std::atomic<int> counter{0};
+  std::string tmp =
+      fname + "." + std::to_string(getpid()) + "." + std::to_string(counter++) + ".tmp";
+  std::ofstream os(tmp, std::ios::binary);
+  CHECK(os.good()) << "Failed to open " << tmp;
+  os.write(reinterpret_cast<const char*>(&header), sizeof header);
+  os.write(std::string(Align(sizeof header) - sizeof header, '\0').data(),
+           Align(sizeof header) - sizeof header);
+  os.write(w.buffer.data(), w.buffer.size());
+  os.close();
+  if (!os.good() || rename(tmp.c_str(), fname.c_str()) != 0) {
+    unlink(tmp.c_str());
+    CHECK(false) << "Failed to write " << fname;
+  }
+}
+
+SSDfg* ImportBinary(const std::string& fname) {
+  MappedFile file(fname);
+  CHECK(file.size >= Align(sizeof(Header))) << fname << " is too small to be a binary DFG";
+  Header header;
+  memcpy(&header, file.data, sizeof header);
+  CHECK(memcmp(header.magic, kMagic, sizeof kMagic) == 0) << fname << " is not a binary DFG";
+  CHECK(header.version == kVersion)
+      << fname << " is of version " << header.version << ", but " << kVersion
+      << " is expected. Dump it again.";
+  if (header.hash) {
+    uint64_t offset = Align(sizeof header);
+    CHECK(Hash(file.data + offset, file.size - offset) == header.hash)
+        << fname << " is corrupted: the hash does not match";
+  }
+
+  auto* groups = file.Table<GroupEntry>(header.groups);
+  auto* nodes = file.Table<NodeEntry>(header.nodes);
+  auto* values = file.Table<Range>(header.values);
+  auto* operands = file.Table<OperandEntry>(header.operands);
+  auto* edges = file.Table<EdgeEntry>(header.edges);
+  auto* ints = file.Table<int32_t>(header.ints);
+  auto* chars = file.Table<char>(header.chars);
+
+  // The ranges are checked against their tables, since a file without a hash may be
+  // corrupted anywhere.
+  auto within = [&fname](const Range& r, const Section& table, const char* what) {
+    CHECK((uint64_t)r.begin + r.size <= table.size)
+        << fname << " is corrupted: a range is out of the " << what << " table";
+  };
+  auto str = [&](const Range& r) {
+    within(r, header.chars, "char");
+    return std::string(chars + r.begin, r.size);
+  };
+  auto vec = [&](const Range& r) {
+    within(r, header.ints, "int");
+    return std::vector<int>(ints + r.begin, ints + r.begin + r.size);
+  };
+
+  CHECK(header.num_nodes == (int64_t)header.nodes.size);
+  SSDfg* res = new SSDfg();
+  for (uint64_t i = 0; i < header.groups.size; ++i) {
+    res->start_new_dfg_group();
+    auto& prop = res->group_prop(i);
+    prop.is_temporal = groups[i].is_temporal;
+    prop.frequency = groups[i].frequency;
+    prop.unroll = groups[i].unroll;
+  }
+
+  // The MetaPort of a port may refer to another port by name, so it is resolved after
+  // all the nodes are constructed.
+  MetaPort empty;
+  for (uint64_t i = 0; i < header.nodes.size; ++i) {
+    auto& entry = nodes[i];
+    within(entry.values, header.values, "value");
+    within(entry.operands, header.operands, "operand");
+    SSDfgNode* node = nullptr;
+    switch (entry.kind) {
+      case NodeKind::Inst: {
+        auto& inst =
+            res->emplace_back<SSDfgInst>(res, inst_from_string(str(entry.opcode).c_str()));
+        inst.predicate = DecodeCtrl(entry.ctrl, entry.ctrl_dynamic);
+        inst.self_predicate = DecodeCtrl(entry.self, entry.self_dynamic);
+        inst.set_name(str(entry.name));
+        node = &inst;
+        break;
+      }
+      case NodeKind::VecInput:
+      case NodeKind::VecOutput: {
+        SSDfgVec* port;
+        if (entry.kind == NodeKind::VecInput) {
+          port = &res->emplace_back<SSDfgVecInput>(entry.vp_len, entry.bitwidth,
+                                                   str(entry.name), res, empty);
+        } else {
+          port = &res->emplace_back<SSDfgVecOutput>(entry.vp_len, entry.bitwidth,
+                                                    str(entry.name), res, empty);
+        }
+        port->set_port_width(entry.port_width);
+        node = port;
+        break;
+      }
+      default:
+        CHECK(false) << "Node " << i << " has unknown type " << (int)entry.kind;
+    }
+    CHECK(entry.group >= 0 && entry.group < res->num_groups());
+    node->set_group_id(entry.group);
+    CHECK(node->values.size() == entry.values.size)
+        << "Node " << i << " has " << node->values.size() << " values, but "
+        << entry.values.size << " are dumped";
+  }
+
+  res->edges.resize(header.edges.size);
+  for (uint64_t i = 0; i < header.edges.size; ++i) {
+    auto& entry = edges[i];
+    CHECK(entry.sid >= 0 && entry.sid < header.num_nodes && entry.uid >= 0 &&
+          entry.uid < header.num_nodes)
+        << "Edge " << i << " is dangling";
+    auto& edge = res->edges[i];
+    edge.parent = res;
+    edge.id = entry.id;
+    edge.sid = entry.sid;
+    edge.vid = entry.vid;
+    edge.uid = entry.uid;
+    edge.l = entry.l;
+    edge.r = entry.r;
+    edge.buf_len = entry.buf_len;
+    edge.delay = entry.delay;
+  }
+
+  for (uint64_t i = 0; i < header.nodes.size; ++i) {
+    auto& entry = nodes[i];
+    auto* node = res->nodes[i];
+    for (uint32_t j = 0; j < entry.operands.size; ++j) {
+      auto& op = operands[entry.operands.begin + j];
+      for (auto eid : vec(op.edges)) {
+        CHECK(eid >= 0 && eid < (int)res->edges.size()) << "Edge " << eid << " is missing";
+      }
+      if (op.edges.size) {
+        node->ops().emplace_back(res, vec(op.edges), (OperandType)op.type);
+      } else {
+        node->ops().emplace_back(op.imm);
+        node->ops().back().type = (OperandType)op.type;
+      }
+    }
+    if (auto* port = dynamic_cast<SSDfgVec*>(node)) {
+      MetaPort meta;
+      meta.source = (MetaPort::Data)entry.source;
+      meta.dest = (MetaPort::Data)entry.dest;
+      meta.op = entry.op;
+      meta.conc = entry.conc;
+      meta.cmd = entry.cmd;
+      meta.repeat = entry.repeat;
+      meta.dest_port = str(entry.dest_port);
+      port->meta = CompileMeta(meta, port);
+    }
+  }
+
+  // The operands pushed the uses in the order of the consumers, so the uses are
+  // overwritten to keep the order in the dumped DFG.
+  for (uint64_t i = 0; i < header.nodes.size; ++i) {
+    auto& entry = nodes[i];
+    auto& node_values = res->nodes[i]->values;
+    for (uint32_t j = 0; j < entry.values.size; ++j) {
+      node_values[j].uses = vec(values[entry.values.begin + j]);
+    }
+  }
+
+  return res;
+}
+
+}  // namespace dfg
+}  // namespace dsa
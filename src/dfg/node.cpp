@@ -6,7 +6,7 @@ namespace dsa {
 namespace dfg {
 
 Operand::Operand(SSDfg *parent, const std::vector<int> &es, OperandType type_) :
-  parent(parent), edges(es), type(type_), fifos(es.size()) {
+  parent(parent), edges(es), type(type_), fifo_ids(es.size(), -1) {
   for (auto eid : es) {
     auto &edge = parent->edges[eid];
     edge.val()->uses.push_back(eid);
@@ -27,19 +27,30 @@ bool Operand::valid() {
   return true;
 }
 
+simulation::Fifo Operand::fifo(int i) {
+  if (fifo_ids.size() < edges.size()) {
+    fifo_ids.resize(edges.size(), -1);
+  }
+  if (fifo_ids[i] == -1) {
+    fifo_ids[i] = parent->fifo_arena().Allocate(parent->edges[edges[i]].buf_len);
+  }
+  return simulation::Fifo(&parent->fifo_arena(), fifo_ids[i]);
+}
+
 bool Operand::ready() {
   if (edges.empty()) {
     return true;
   }
-  for (size_t i = 0; i < fifos.size(); ++i) {
+  for (size_t i = 0; i < edges.size(); ++i) {
     auto *e = &parent->edges[edges[i]];
-    if (fifos[i].empty()) {
+    auto buffer = fifo(i);
+    if (buffer.empty()) {
       LOG(FORWARD) << "no element!";
       return false;
     }
-    if (e->use()->ssdfg()->cur_cycle() < fifos[i].front().available_at) {
+    if (e->use()->ssdfg()->cur_cycle() < buffer.front().available_at) {
       LOG(FORWARD) << "time away: " << e->use()->ssdfg()->cur_cycle()
-                     << " < " << fifos[i].front().available_at;
+                     << " < " << buffer.front().available_at;
       return false;
     }
   }
@@ -49,10 +60,10 @@ bool Operand::ready() {
 uint64_t Operand::poll() {
   assert(ready());
   uint64_t res = 0;
-  for (int i = fifos.size() - 1; i >= 0; --i) {
+  for (int i = edges.size() - 1; i >= 0; --i) {
     auto *e = &parent->edges[edges[i]];
     uint64_t full = ~0ull >> (64 - e->bitwidth());
-    uint64_t sliced = (fifos[i].front().value >> e->l) & full;
+    uint64_t sliced = (fifo(i).front().value >> e->l) & full;
     res = (res << e->bitwidth()) | sliced;
   }
   return res;
@@ -60,15 +71,15 @@ uint64_t Operand::poll() {
 
 void Operand::pop() {
   CHECK(ready());
-  for (auto& elem : fifos) {
-    elem.pop();
+  for (size_t i = 0; i < edges.size(); ++i) {
+    fifo(i).pop();
   }
 }
 
 bool Operand::predicate() {
   CHECK(ready());
-  for (int i = fifos.size() - 1; i >= 0; --i) {
-    if (!fifos[i].front().valid) {
+  for (int i = edges.size() - 1; i >= 0; --i) {
+    if (!fifo(i).front().valid) {
       return false;
     }
   }
@@ -110,14 +121,21 @@ SSDfgNode* Value::node() const {
   return parent->nodes[nid];
 }
 
+simulation::Fifo Value::fifo() {
+  if (fifo_id == -1) {
+    fifo_id = parent->fifo_arena().Allocate(kFifoDepth);
+  }
+  return simulation::Fifo(&parent->fifo_arena(), fifo_id);
+}
+
 void Value::push(uint64_t val, bool valid, int delay) {
   // TODO: Support FIFO length backpressure.
-  fifo.push(simulation::Data(parent->cur_cycle() + delay, val, valid));
+  fifo().push(simulation::Data(parent->cur_cycle() + delay, val, valid));
 }
 
 bool Value::forward(bool attempt) {
-  if (fifo.empty()) return false;
-  simulation::Data data(fifo.front());
+  if (fifo().empty()) return false;
+  simulation::Data data(fifo().front());
   for (auto uid : uses) {
     int j = 0;
     auto *user = &parent->edges[uid];
@@ -126,16 +144,17 @@ bool Value::forward(bool attempt) {
       for (size_t i = 0; i < operand.edges.size(); ++i) {
         auto *edge = &parent->edges[operand.edges[i]];
         if (edge == user) {
-          if ((int)operand.fifos[i].size() + 1 < edge->buf_len
+          auto buffer = operand.fifo(i);
+          if (buffer.size() + 1 < edge->buf_len
               /*FIXME: The buffer size should be something more serious*/) {
             if (!attempt) {
               simulation::Data entry(parent->cur_cycle() + edge->delay, data.value, data.valid);
               LOG(FORWARD) << parent->cur_cycle() << ": " << name()
                              << " pushes " << data.value << "(" << data.valid << ")" << "to "
                              << user->use()->name() << "'s " << j << "th operand "
-                             << operand.fifos[i].size() + 1 << "/" << edge->buf_len
+                             << buffer.size() + 1 << "/" << edge->buf_len
                              << " in " << edge->delay << " cycles(" << entry.available_at << ")";
-              operand.fifos[i].push(entry);
+              buffer.push(entry);
             }
           } else {
             return false;
@@ -145,7 +164,7 @@ bool Value::forward(bool attempt) {
     }
   }
   if (!attempt) {
-    fifo.pop();
+    fifo().pop();
   }
   return true;
 }
@@ -0,0 +1,110 @@
+#include "dsa/dfg/overlay.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace dsa {
+namespace dfg {
+
+DfgOverlay::DfgOverlay(SSDfg* base) : _base(base), _num_base_nodes(base->nodes.size()) {
+  _in_offset.reserve(_num_base_nodes + 1);
+  _in_offset.push_back(0);
+  for (auto* node : base->nodes) {
+    for (auto& op : node->ops()) {
+      _in_edges.insert(_in_edges.end(), op.edges.begin(), op.edges.end());
+    }
+    _in_offset.push_back(_in_edges.size());
+  }
+  _ends.reserve(base->edges.size());
+  for (auto& edge : base->edges) {
+    _ends.push_back({edge.sid, edge.vid, edge.uid});
+  }
+  _origin.resize(base->edges.size());
+  for (int i = 0, n = _origin.size(); i < n; ++i) {
+    _origin[i] = i;
+  }
+}
+
+std::vector<int>& DfgOverlay::mutable_uses(int nid, int vid) {
+  if (is_noop(nid)) {
+    CHECK(vid == 0);
+    return _noop_uses[nid - _num_base_nodes];
+  }
+  auto iter = _uses.find(ValueKey(nid, vid));
+  if (iter == _uses.end()) {
+    iter = _uses.emplace(ValueKey(nid, vid), _base->nodes[nid]->values[vid].uses).first;
+  }
+  return iter->second;
+}
+
+int DfgOverlay::InjectNoop(int eid, int noop) {
+  CHECK(eid >= 0 && eid < num_edges());
+  _log.emplace_back(eid, noop);
+  if (noop == -1) {
+    noop = num_nodes();
+    int new_edge = num_edges();
+    _ends.push_back({_ends[eid].sid, _ends[eid].vid, noop});
+    _origin.push_back(_origin[eid]);
+    _noop_in.push_back(new_edge);
+    _noop_uses.emplace_back();
+    mutable_uses(_ends[eid].sid, _ends[eid].vid).push_back(new_edge);
+  } else {
+    CHECK(is_noop(noop) && noop < num_nodes()) << "The injected node should be a noop.";
+  }
+  _noop_uses[noop - _num_base_nodes].push_back(eid);
+  // Remove the edge from the uses of its source.
+  auto& uses = mutable_uses(_ends[eid].sid, _ends[eid].vid);
+  auto iter = std::find(uses.begin(), uses.end(), eid);
+  CHECK(iter != uses.end()) << "The value used by this edge not found!";
+  uses.erase(iter);
+  _ends[eid].sid = noop;
+  _ends[eid].vid = 0;
+  return noop;
+}
+
+SSDfg* DfgOverlay::Materialize() const {
+  SSDfg* res = new SSDfg(*_base);
+  for (auto& elem : _log) {
+    int eid = elem.first;
+    SSDfgInst* inst;
+    if (elem.second == -1) {
+      // Create a noop instruction, and an edge from the source to the noop.
+      res->emplace_back<SSDfgInst>(res, SS_NONE);
+      inst = &res->instructions.back();
+      Edge edge = res->edges[eid];
+      res->edges.emplace_back(res, edge.sid, edge.vid, inst->id(), edge.l, edge.r);
+      std::vector<int> es{res->edges.back().id};
+      inst->ops().emplace_back(res, es, OperandType::data);
+    } else {
+      inst = dynamic_cast<SSDfgInst*>(res->nodes[elem.second]);
+      CHECK(inst && inst->inst() == SS_NONE);
+    }
+    inst->values[0].uses.push_back(eid);
+    auto& uses = res->edges[eid].val()->uses;
+    uses.erase(std::find(uses.begin(), uses.end(), eid));
+    res->edges[eid].sid = inst->id();
+    res->edges[eid].vid = 0;
+  }
+  CHECK((int) res->nodes.size() == num_nodes() && (int) res->edges.size() == num_edges());
+  return res;
+}
+
+std::string DfgOverlay::name(int nid) const {
+  if (!is_noop(nid)) {
+    return _base->nodes[nid]->name();
+  }
+  std::ostringstream oss;
+  oss << "(" << name_of_inst(SS_NONE) << " " << nid << ")";
+  return oss.str();
+}
+
+std::string DfgOverlay::edge_name(int eid) const {
+  auto& origin = _base->edges[_origin[eid]];
+  std::ostringstream oss;
+  oss << name(src(eid)) << "." << _ends[eid].vid << "[" << origin.l << ", " << origin.r
+      << "]->" << name(dst(eid));
+  return oss.str();
+}
+
+}  // namespace dfg
+}  // namespace dsa
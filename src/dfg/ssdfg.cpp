@@ -10,7 +10,6 @@
 #include "dfg-parser.tab.h"
 #include "dsa/mapper/schedule.h"
 #include "../utils/model_parsing.h"
-#include "../utils/vector_utils.h"
 
 using namespace std;
 using namespace dsa;
@@ -171,18 +170,32 @@ SSDfgVec::SSDfgVec(V_TYPE v, int len, int bitwidth, const std::string& name,
 uint64_t SSDfgInst::do_compute(bool& discard) {
   last_execution = _ssdfg->cur_cycle();
 
+  // The operands and results are narrowed into stack buffers, so that firing an
+  // instruction allocates nothing.
 #define EXECUTE(bw)                                                                     \
   case bw: {                                                                            \
-    std::vector<uint##bw##_t> input =                                                   \
-      vector_utils::cast_vector<uint64_t, uint##bw##_t>(_input_vals);                   \
-    std::vector<uint##bw##_t> outputs(values.size());                                   \
-    output = dsa::execute##bw(opcode, input, outputs, (uint##bw##_t*)&_reg[0],          \
-                              discard, _back_array);                                    \
+    uint##bw##_t input[4], outputs[4] = {0, 0, 0, 0};                                   \
+    bool back[4] = {false, false, false, false};                                        \
+    for (int i = 0; i < n; ++i) {                                                       \
+      input[i] = _input_vals[i];                                                        \
+      back[i] = _back_array[i];                                                         \
+    }                                                                                   \
+    output = dsa::execute##bw(opcode, input, n, outputs, (uint##bw##_t*)&_reg[0],       \
+                              discard, back);                                           \
     outputs[0] = output;                                                                \
-    _output_vals = vector_utils::cast_vector<uint##bw##_t, uint64_t>(outputs);                        \
+    for (int i = 0; i < n; ++i) {                                                       \
+      _back_array[i] = back[i];                                                         \
+    }                                                                                   \
+    _output_vals.resize(values.size());                                                 \
+    for (int i = 0, m = values.size(); i < m; ++i) {                                    \
+      _output_vals[i] = outputs[i];                                                     \
+    }                                                                                   \
     return output;                                                                      \
   }
 
+  int n = _input_vals.size();
+  CHECK(n <= 4 && values.size() <= 4);
+  _back_array.resize(n);
   uint64_t output;
   switch (bitwidth()) {
     EXECUTE(64)
@@ -233,9 +246,9 @@ void SSDfgInst::forward() {
   }
 
   // Check the avaiability of output buffer
-  if (!values.front().fifo.empty()) {
+  if (!values.front().fifo().empty()) {
     for (auto &elem : values) {
-      CHECK(!elem.fifo.empty());
+      CHECK(!elem.fifo().empty());
       if (!elem.forward(true)) {
         LOG(FORWARD) << _ssdfg->cur_cycle() << ": "
                        << name() << " Cannot forward because of " << elem.name();
@@ -405,7 +418,7 @@ int SSDfg::forward(bool asap) {
 
 bool SSDfgVecInput::can_push() {
   for (auto &elem : values) {
-    if (!elem.fifo.empty()) {
+    if (!elem.fifo().empty()) {
       return false;
     }
   }
@@ -449,7 +462,7 @@ bool SSDfgVecOutput::can_pop() {
 SSDfg::SSDfg(const SSDfg &dfg) :
   filename(dfg.filename), instructions(dfg.instructions),
   vins(dfg.vins), vouts(dfg.vouts), edges(dfg.edges),
-  _groupProps(dfg._groupProps) {
+  _fifos(dfg._fifos), _groupProps(dfg._groupProps) {
   normalize();
   for (auto node : nodes) {
     node->ssdfg() = this;
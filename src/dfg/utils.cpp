@@ -3,107 +3,110 @@
 #include "dsa/dfg/metadata.h"
 #include "dsa/dfg/utils.h"
 #include "dsa/dfg/visitor.h"
+#include "dsa/json_writer.h"
+#include "dsa/profile.h"
 #include "json/data.h"
 #include "json/visitor.h"
-#include "json.tab.h"
-#include "json.lex.h"
+#include "../utils/json_parsing.h"
+#include "../utils/string_utils.h"
 
 namespace dsa {
 namespace dfg {
 
 struct Exporter : Visitor {
-  plain::Object current;
-  plain::Array nodes;
+  JSONWriter &w;
 
+  Exporter(JSONWriter &w) : w(w) {}
+
+  // The fields specific to each kind of node are written first, and then the common ones.
   void Visit(SSDfgNode *node) override {
-    current["id"] = new json::Int(node->id());
-    current["temporal"] = new json::Int(node->is_temporal());
-    current["group"] = new json::Int(node->group_id());
-    current["name"] = new json::String(node->name());
+    w.Field("id", node->id());
+    w.Field("temporal", (int) node->is_temporal());
+    w.Field("group", node->group_id());
+    w.Field("name", node->name());
 
-    plain::Array inputs;
+    w.Key("inputs").BeginArray();
     for (auto operand : node->ops()) {
-      plain::Object operand_obj;
+      w.BeginObject();
       if (operand.edges.empty()) {
-        operand_obj["imm"] = new json::Int(operand.imm);
+        w.Field("imm", (int64_t) operand.imm);
       } else {
-        operand_obj["type"] = (new json::String(OPERAND_TYPE[(int) operand.type]));
-        plain::Array edges;
+        w.Field("type", OPERAND_TYPE[(int) operand.type]);
+        w.Key("edges").BeginArray();
         for (auto eid : operand.edges) {
           auto *edge = &node->ssdfg()->edges[eid];
-          plain::Object edge_obj;
-          edge_obj["id"] = new json::Int(edge->id);
-          edge_obj["src_id"] = new json::Int(edge->def()->id());
-          edge_obj["src_val"] = new json::Int(edge->val()->index);
-          edge_obj["delay"] = new json::Int(edge->delay);
-          edge_obj["l"] = new json::Int(edge->l);
-          edge_obj["r"] = new json::Int(edge->r);
-          edges.push_back(new json::Object(edge_obj));
+          // The compact form is [id, src_id, src_val, delay, l, r].
+          if (w.compact()) {
+            w.BeginArray();
+            w.Value(edge->id).Value(edge->def()->id()).Value(edge->val()->index);
+            w.Value(edge->delay).Value(edge->l).Value(edge->r);
+            w.EndArray();
+          } else {
+            w.BeginObject();
+            w.Field("id", edge->id);
+            w.Field("src_id", edge->def()->id());
+            w.Field("src_val", edge->val()->index);
+            w.Field("delay", edge->delay);
+            w.Field("l", edge->l);
+            w.Field("r", edge->r);
+            w.EndObject();
+          }
         }
-        operand_obj["edges"] = new json::Array(edges);
+        w.EndArray();
       }
-      inputs.push_back(new json::Object(operand_obj));
+      w.EndObject();
     }
-    current["inputs"] = new json::Array(inputs);
-    nodes.push_back(new json::Object(current));
-    current.clear();
+    w.EndArray();
   }
   void Visit(SSDfgInst *inst) override {
-    current["op"] = new json::Int(inst->inst());
-    current["inst"] = new json::String(name_of_inst(inst->inst()));
-    current["ctrl"] = new json::Int(inst->predicate.bits());
-    current["self"] = new json::Int(inst->self_predicate.bits());
+    w.Field("op", (int) inst->inst());
+    w.Field("inst", name_of_inst(inst->inst()));
+    w.Field("ctrl", (int64_t) inst->predicate.bits());
+    w.Field("self", (int64_t) inst->self_predicate.bits());
     Visit(static_cast<SSDfgNode*>(inst));
   }
   void Visit(SSDfgVecInput *in) override {
-    current["width"] = new json::Int(in->get_port_width());
-    current["length"] = new json::Int(in->get_vp_len());
+    w.Field("width", in->get_port_width());
+    w.Field("length", in->get_vp_len());
     Visit(static_cast<SSDfgNode*>(in));
   }
   void Visit(SSDfgVecOutput *out) override {
-    current["width"] = new json::Int(out->get_port_width());
-    current["length"] = new json::Int(out->get_vp_len());
+    w.Field("width", out->get_port_width());
+    w.Field("length", out->get_vp_len());
     Visit(static_cast<SSDfgNode*>(out));
   }
 };
 
-void Export(SSDfg *dfg, const std::string &fname) {
-  Exporter exporter;
-  dfg->Apply(&exporter);
-  auto fcompare = [](json::BaseNode *a, json::BaseNode *b) {
-    auto oa = a->As<plain::Object>();
-    auto ob = b->As<plain::Object>();
-    CHECK(oa->count("id")) << "a has no id!";
-    CHECK(ob->count("id")) << "b has no id!";
-    auto ida = oa->operator[]("id")->As<int64_t>();
-    auto idb = ob->operator[]("id")->As<int64_t>();
-    CHECK(ida) << "The is of a is not an int!";
-    CHECK(idb) << "The is of b is not an int!";
-    return *ida < *idb;
-  };
-  auto &nodes = exporter.nodes;
-  std::sort(nodes.begin(), nodes.end(), fcompare);
-  for (int i = 0, n = nodes.size(); i < n; ++i) {
-    auto elem_id = *nodes[i]->As<plain::Object>()->operator[]("id")->As<int64_t>();
-    CHECK(elem_id == i) << elem_id << " != " << i;
+void Export(SSDfg *dfg, const std::string &fname, bool compact) {
+  if (string_utils::String(fname).EndsWith(".dfg.bin")) {
+    ExportBinary(dfg, fname);
+    return;
   }
-
-  json::Array json_array(exporter.nodes);
-  std::ofstream ofs(fname);
-  json::JSONPrinter printer(ofs);
-  json_array.Accept(&printer);
+  PROFILE_SCOPE(DumpJson);
+  JSONWriter w(fname, compact);
+  CHECK(w.good()) << "Failed to open " << fname;
+  Exporter exporter(w);
+  // The nodes are streamed in the order of their ids, which is what Import expects.
+  w.BeginArray();
+  for (int i = 0, n = dfg->nodes.size(); i < n; ++i) {
+    CHECK(dfg->nodes[i]->id() == i) << dfg->nodes[i]->id() << " != " << i;
+    w.BeginObject();
+    dfg->nodes[i]->Accept(&exporter);
+    w.EndObject();
+  }
+  w.EndArray();
 }
 
 SSDfg* Import(const std::string &s) {
+  if (string_utils::String(s).EndsWith(".dfg.bin")) {
+    return ImportBinary(s);
+  }
   SSDfg* res = new SSDfg();
   MetaPort meta;
 
-  FILE *fjson = fopen(s.c_str(), "r");
-  struct params p;
-  JSONrestart(fjson);
-  JSONparse(&p);
+  json::BaseNode *root = json_parsing::Parse(s);
 
-  auto nodes = p.data->As<plain::Array>();
+  auto nodes = root->As<plain::Array>();
   CHECK(nodes);
   int last_group = -1;
   for (int i = 0, n = nodes->size(); i < n; ++i) {
@@ -149,15 +152,26 @@ SSDfg* Import(const std::string &s) {
         auto &edges = *obj["edges"]->As<plain::Array>();
         std::vector<int> es;
         for (auto edge : edges) {
-          auto &edge_obj = *edge->As<plain::Object>();
-          int src_id = *edge_obj["src_id"]->As<int64_t>();
-          int src_val = *edge_obj["src_val"]->As<int64_t>();
-          int delay = *edge_obj["delay"]->As<int64_t>();
-          int l = *edge_obj["l"]->As<int64_t>();
-          int r = *edge_obj["r"]->As<int64_t>();
+          int id, src_id, src_val, delay, l, r;
+          if (auto tuple = edge->As<plain::Array>()) {
+            // The compact form of [id, src_id, src_val, delay, l, r]
+            CHECK(tuple->size() == 6);
+            int *fields[] = {&id, &src_id, &src_val, &delay, &l, &r};
+            for (int k = 0; k < 6; ++k) {
+              *fields[k] = *(*tuple)[k]->As<int64_t>();
+            }
+          } else {
+            auto &edge_obj = *edge->As<plain::Object>();
+            id = *edge_obj["id"]->As<int64_t>();
+            src_id = *edge_obj["src_id"]->As<int64_t>();
+            src_val = *edge_obj["src_val"]->As<int64_t>();
+            delay = *edge_obj["delay"]->As<int64_t>();
+            l = *edge_obj["l"]->As<int64_t>();
+            r = *edge_obj["r"]->As<int64_t>();
+          }
           CHECK(src_id < i);
           Edge e_instance(res, src_id, src_val, i, l, r);
-          es.push_back(*edge_obj["id"]->As<int64_t>());
+          es.push_back(id);
           if (es.back() >= res->edges.size())
             res->edges.resize(es.back() + 1);
           e_instance.delay = delay;
@@ -169,17 +183,7 @@ SSDfg* Import(const std::string &s) {
     }
   }
 
-  fclose(fjson);
-  delete p.data;
-
-  struct FIFOAllocator : Visitor {
-    void Visit(SSDfgNode *node) {
-      for (auto &op : node->ops()) {
-        op.fifos.resize(op.edges.size());
-      }
-    }
-  } fa;
-  res->Apply(&fa);
+  delete root;
 
   return res;
 }
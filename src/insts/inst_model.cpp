@@ -1,6 +1,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <algorithm>
 #include <map>
 #include <set>
 #include <sstream>
@@ -331,15 +332,64 @@ void InstModel::printCFiles(char* header_file, char* cpp_file) {
   ofs << "extern int num_ops[" << _instList.size() + 2 << "];\n";
   ofs << "extern int bitwidth[" << _instList.size() + 2 << "];\n";
 
+  // The properties of the opcodes are tables indexed by the opcode, so that the queries
+  // in the hot paths of the scheduler and the simulator inline to loads. The entries of
+  // SS_NONE and SS_ERR that the queries reject are 0.
+  auto print_table = [this, &ofs](const std::string& type, const std::string& name,
+                                  const std::string& none, auto f) {
+    ofs << "constexpr " << type << " " << name << "[SS_NUM_TYPES] = {\n"
+        << "  " << none << ", " << (type == "char const*" ? "nullptr" : "0") << ",\n";
+    for (auto* inst : _instList) {
+      ofs << "  " << f(inst) << ",\n";
+    }
+    ofs << "};\n";
+  };
+  ofs << "\n"
+         "namespace inst_table {\n";
+  print_table("char const*", "name", "\"NONE\"",
+              [](ConfigInst* inst) { return "\"" + inst->name() + "\""; });
+  print_table("int", "latency", "1",
+              [](ConfigInst* inst) { return std::to_string(inst->latency()); });
+  print_table("int", "throughput", "0",
+              [](ConfigInst* inst) { return std::to_string(inst->throughput()); });
+  print_table("int", "num_values", "1",
+              [](ConfigInst* inst) { return std::to_string(inst->numValues()); });
+  auto real = [](double x) {
+    std::ostringstream oss;
+    oss << x;
+    return oss.str();
+  };
+  print_table("double", "area", "0", [real](ConfigInst* inst) { return real(inst->area()); });
+  print_table("double", "power", "0", [real](ConfigInst* inst) { return real(inst->power()); });
+  ofs << "}\n";
+
   ofs << "\n"
          "// OpCode\n"
          "OpCode inst_from_string(const char* str);\n"
-         "const char* name_of_inst(OpCode inst);\n"
-         "double inst_area(OpCode inst);\n"
-         "double inst_power(OpCode inst);\n"
-         "int inst_lat(OpCode inst);\n"
-         "int inst_thr(OpCode inst);\n"
-         "int num_values(OpCode inst);\n"
+         "inline const char* name_of_inst(OpCode inst) {\n"
+         "  CHECK(inst != SS_ERR && inst < SS_NUM_TYPES) << \"Unknown inst \" << (int) inst;\n"
+         "  return inst_table::name[inst];\n"
+         "}\n"
+         "inline double inst_area(OpCode inst) {\n"
+         "  CHECK(inst > SS_ERR && inst < SS_NUM_TYPES) << \"Unknown inst \" << (int) inst;\n"
+         "  return inst_table::area[inst];\n"
+         "}\n"
+         "inline double inst_power(OpCode inst) {\n"
+         "  CHECK(inst > SS_ERR && inst < SS_NUM_TYPES) << \"Unknown inst \" << (int) inst;\n"
+         "  return inst_table::power[inst];\n"
+         "}\n"
+         "inline int inst_lat(OpCode inst) {\n"
+         "  CHECK(inst != SS_ERR && inst < SS_NUM_TYPES) << \"Unknown inst \" << (int) inst;\n"
+         "  return inst_table::latency[inst];\n"
+         "}\n"
+         "inline int inst_thr(OpCode inst) {\n"
+         "  CHECK(inst > SS_ERR && inst < SS_NUM_TYPES) << \"Unknown inst \" << (int) inst;\n"
+         "  return inst_table::throughput[inst];\n"
+         "}\n"
+         "inline int num_values(OpCode inst) {\n"
+         "  CHECK(inst != SS_ERR && inst < SS_NUM_TYPES) << \"Unknown inst \" << (int) inst;\n"
+         "  return inst_table::num_values[inst];\n"
+         "}\n"
          "// fu_type_t\n"
          "fu_type_t fu_type_from_string(const char* str);\n"
          "const char* name_of_fu_type(fu_type_t fu_type);\n"
@@ -351,6 +401,18 @@ void InstModel::printCFiles(char* header_file, char* cpp_file) {
   string types[4] = {"uint64_t", "uint32_t", "uint16_t", "uint8_t"};
   string suffixes[4] = {"64", "32", "16", "8"};
 
+  // The instruction implementations index the operands and query their size, so a
+  // fixed-size view over a caller-owned buffer keeps them working without allocation.
+  ofs << "\n"
+         "// A view of the operands in a caller-owned buffer.\n"
+         "template <typename T>\n"
+         "struct OperandView {\n"
+         "  const T* data;\n"
+         "  unsigned n;\n"
+         "  unsigned size() const { return n; }\n"
+         "  const T& operator[](unsigned i) const { return data[i]; }\n"
+         "};\n\n";
+
   ofs << "// execute \n";
   for (int i = 0; i < 4; ++i) {
     string dtype = types[i];
@@ -359,7 +421,20 @@ void InstModel::printCFiles(char* header_file, char* cpp_file) {
         << "std::vector<" << dtype << ">& ops, "
         << "std::vector<" << dtype << ">& outs, " << dtype << "* reg, "
         << "bool &discard, std::vector<bool>& back_array);\n";
+    // The allocation-free overload: at most 4 operands, `outs` holds num_values(inst)
+    // entries, and `back_array` holds one flag per operand.
+    ofs << dtype << " execute" << suffix << "(OpCode inst, "
+        << "const " << dtype << "* ops, int arity, "
+        << dtype << "* outs, " << dtype << "* reg, "
+        << "bool &discard, bool* back_array);\n";
+    // Apply the instruction to n words, res[k] = execute(ops[0][k], ..., ops[arity-1][k]).
+    ofs << "void execute" << suffix << "_batch(OpCode inst, "
+        << "const " << dtype << "* const* ops, int arity, "
+        << dtype << "* res, int n, " << dtype << "* reg);\n";
   }
+  // If execute_batch has a SIMD kernel of the instruction on this host. Such instructions
+  // are stateless and never discard, so the callers can compute all the words at once.
+  ofs << "bool has_batch_kernel(OpCode inst);\n";
 
   ofs << "\n"
          "}\n\n"
@@ -420,85 +495,34 @@ void InstModel::printCFiles(char* header_file, char* cpp_file) {
          "}\n"
          "\n"
 
-         "using namespace dsa;\n\n"
-         "OpCode dsa::inst_from_string(const char* str) {\n"
-         "  if(strcmp(str,\"NONE\")==0) return SS_NONE;\n";
+         "using namespace dsa;\n\n";
 
-  for (unsigned i = 0; i < _instList.size(); ++i) {
-    ofs << "  else if(strcmp(str,\"" << _instList[i]->name() << "\")==0) return SS_"
-        << _instList[i]->name() << ";\n";
+  // inst_from_string, by a binary search in the names sorted in the order of strcmp.
+  std::vector<std::string> sorted_names{"NONE"};
+  for (auto* inst : _instList) {
+    sorted_names.push_back(inst->name());
   }
-  /*
-  ofs << "  else { fprintf(stderr,\"Config Library does not understand "
-         "string\\\"%s\\\"\\n\",str); "
-         "return SS_ERR;}\n";
-         */
-  ofs << "  else {return SS_ERR;}\n";
-  ofs << "}\n\n";
-
-  // Properties of Instructions
-
-  // name_of_inst
-  ofs << "const char* dsa::name_of_inst(OpCode inst) {\n"
-         "  switch(inst) {\n";
-  for (unsigned i = 0; i < _instList.size(); ++i) {
-    ofs << "    case "
-        << "SS_" << _instList[i]->name() << ": return \"" << _instList[i]->name()
-        << "\";\n";
-  }
-  ofs << "  case SS_NONE: return \"NONE\";\n";
-  ofs << "  case SS_ERR:  CHECK(false) << \"Error opcode!\"; throw;\n";
-  ofs << "  case SS_NUM_TYPES:  CHECK(false) << \"Opcode exceeds.\";\n";
-  ofs << "    default: CHECK(false) << \"Unknown inst\"; throw;\n";
-  ofs << "  }\n";
-  ofs << "}\n\n";
-
-  // FUNCTION: inst_lat
-  ofs << "int dsa::inst_lat(OpCode inst) {\n"
-         "  switch(inst) {\n"
-         "    case SS_NONE: return 1;\n";
-  for (unsigned i = 0; i < _instList.size(); ++i) {
-    ofs << "    case "
-        << "SS_" << _instList[i]->name() << ": return " << _instList[i]->latency()
-        << ";\n";
-  }
-  ofs << "    default: CHECK(false) << \"Unknown inst\"; throw;\n";
-  ofs << "  }\n\n";
-  ofs << "}\n\n";
-
-  // FUNCTION: inst_thr
-  ofs << "int dsa::inst_thr(OpCode inst) {\n"
-         "  switch(inst) {\n";
-  for (unsigned i = 0; i < _instList.size(); ++i) {
-    ofs << "    case "
-        << "SS_" << _instList[i]->name() << ": return " << _instList[i]->throughput()
-        << ";\n";
-  }
-  ofs << "    default: CHECK(false) << \"Unknown inst\"; throw;\n";
-  ofs << "  }\n\n";
-  ofs << "}\n\n";
-
-  // area of the ssinst
-  ofs << "double dsa::inst_area(OpCode inst) {\n"
-         "  switch(inst) {\n";
-  for (unsigned i = 0; i < _instList.size(); ++i) {
-    ofs << "    case "
-        << "SS_" << _instList[i]->name() << ": return " << _instList[i]->area() << ";\n";
+  std::sort(sorted_names.begin(), sorted_names.end());
+  ofs << "namespace {\n"
+         "struct InstName {\n"
+         "  const char* name;\n"
+         "  OpCode inst;\n"
+         "};\n"
+         "const InstName inst_by_name[] = {\n";
+  for (auto& name : sorted_names) {
+    ofs << "  {\"" << name << "\", SS_" << name << "},\n";
   }
-  ofs << "    default: CHECK(false) << \"Unknown inst\"; throw;\n";
-  ofs << "  }\n\n";
-  ofs << "}\n\n";
-
-  // power of the ssinst
-  ofs << "double dsa::inst_power(OpCode inst) {\n"
-         "  switch(inst) {\n";
-  for (unsigned i = 0; i < _instList.size(); ++i) {
-    ofs << "    case "
-        << "SS_" << _instList[i]->name() << ": return " << _instList[i]->power() << ";\n";
-  }
-  ofs << "    default: CHECK(false) << \"Unknown inst\"; throw;\n";
-  ofs << "  }\n\n";
-  ofs << "}\n\n";
+  ofs << "};\n"
+         "}  // namespace\n\n"
+         "OpCode dsa::inst_from_string(const char* str) {\n"
+         "  auto end = inst_by_name + sizeof(inst_by_name) / sizeof(inst_by_name[0]);\n"
+         "  auto iter = std::lower_bound(inst_by_name, end, str, [](const InstName& a, "
+         "const char* b) {\n"
+         "    return strcmp(a.name, b) < 0;\n"
+         "  });\n"
+         "  if (iter != end && strcmp(iter->name, str) == 0) return iter->inst;\n"
+         "  return SS_ERR;\n"
+         "}\n\n";
 
   // Pre-defined Function Unit Type
   ofs << "fu_type_t dsa::fu_type_from_string(const char* str) {\n"
@@ -545,19 +569,6 @@ void InstModel::printCFiles(char* header_file, char* cpp_file) {
   ofs << "  }\n";
   ofs << "}\n\n";
 
-  // FUNCTION: num_values
-  ofs << "int dsa::num_values(OpCode inst) {\n"
-         "  switch(inst) {\n" <<
-         "    case SS_NONE: return 1;\n";
-  for (unsigned i = 0; i < _instList.size(); ++i) {
-    ofs << "    case "
-        << "SS_" << _instList[i]->name() << ": return " << _instList[i]->numValues()
-        << ";\n";
-  }
-  ofs << "    default: CHECK(false) << \"Unknown inst\"; throw;\n";
-  ofs << "  }\n\n";
-  ofs << "}\n\n";
-
   // num_ops_array
   ofs << "int dsa::num_ops[" << _instList.size() + 2 << "]={0, 0\n";
   ofs << "\t\t\t\t\t\t\t\t\t\t\t\t\t\t";
@@ -588,14 +599,28 @@ void InstModel::printCFiles(char* header_file, char* cpp_file) {
     string dtype = types[i];
     string suffix = suffixes[i];
 
+    // The vector overload forwards to the fixed-arity one.
     ofs << dtype << " dsa::execute" << suffix << "(OpCode inst, "
         << "std::vector<" << dtype << ">& ops, "
         << "std::vector<" << dtype << ">& outs, " << dtype << " *reg, "
-        << "bool &discard, std::vector<bool>& back_array) {\n";
+        << "bool &discard, std::vector<bool>& back_array) {\n"
+        << "  bool back[4] = {false, false, false, false};\n"
+           "  for (size_t i = 0; i < back_array.size() && i < 4; ++i) back[i] = back_array[i];\n"
+        << "  " << dtype << " res = execute" << suffix
+        << "(inst, ops.data(), ops.size(), outs.data(), reg, discard, back);\n"
+           "  for (size_t i = 0; i < back_array.size() && i < 4; ++i) back_array[i] = back[i];\n"
+           "  return res;\n"
+           "}\n\n";
+
+    ofs << dtype << " dsa::execute" << suffix << "(OpCode inst, "
+        << "const " << dtype << "* operands, int arity, "
+        << dtype << "* outs, " << dtype << " *reg, "
+        << "bool &discard, bool* back_array) {\n";
 
     // somwhere below is an implementation of pass through, is it though? (tony, 2018)
 
-    ofs << "  " << dtype << "& accum = reg[0];\n"
+    ofs << "  OperandView<" << dtype << "> ops{operands, (unsigned) arity};\n"
+           "  " << dtype << "& accum = reg[0];\n"
            "  (void) accum;\n"
            "  CHECK(ops.size() <= 4);\n"
            "  CHECK(ops.size() <=  (unsigned)(num_ops[inst]+1));\n"
@@ -630,6 +655,114 @@ void InstModel::printCFiles(char* header_file, char* cpp_file) {
     ofs << "  }\n\n";
     ofs << "}\n\n";
   }
+
+  // FUNCTION: execute_batch()
+  // The SIMD kernels in simd{bitwidth}/ are bodies of
+  //   int f(const T* const* ops, int arity, T* res, int n)
+  // which evaluate a prefix of the n words and return its length; the scalar bodies
+  // evaluate the rest. A kernel can also hand some words to ss_scalar, e.g. NaNs. The kernels must be bit-identical to the scalar bodies, and
+  // only stateless instructions have them, since the words in a batch share `reg'.
+  ofs << "#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))\n"
+         "#include <immintrin.h>\n"
+         "#define SS_INST_AVX2\n"
+         "\n"
+         "#define SS_LOAD(i, k) _mm256_loadu_si256((const __m256i*)(ops[i] + (k)))\n"
+         "#define SS_STORE(k, v) _mm256_storeu_si256((__m256i*)(res + (k)), v)\n"
+         "\n"
+         "static bool ss_has_avx2() {\n"
+         "  static const bool res = __builtin_cpu_supports(\"avx2\");\n"
+         "  return res;\n"
+         "}\n"
+         "\n"
+         "// Add 16-bit lanes, saturating the overflows to 0x7FFF and 0x8001.\n"
+         "__attribute__((target(\"avx2\"))) static inline __m256i ss_fx_add16(__m256i a, "
+         "__m256i b) {\n"
+         "  __m256i wrap = _mm256_add_epi16(a, b);\n"
+         "  __m256i sat = _mm256_adds_epi16(a, b);\n"
+         "  __m256i ovf = _mm256_andnot_si256(_mm256_cmpeq_epi16(wrap, sat), "
+         "_mm256_cmpeq_epi16(sat, _mm256_set1_epi16(-32768)));\n"
+         "  return _mm256_sub_epi16(sat, ovf);\n"
+         "}\n"
+         "#endif\n\n";
+
+  std::vector<std::string> all_kernels[4];
+  for (int i = 0; i < 4; ++i) {
+    int bitwidth = bitwidths[i];
+    string dtype = types[i];
+    string suffix = suffixes[i];
+
+    // The scalar evaluation of the words [k, n), shared by the kernels and the dispatcher.
+    ofs << "static void ss_scalar(OpCode inst, const " << dtype << "* const* ops, int arity, "
+        << dtype << "* res, int k, int n, " << dtype << "* reg) {\n"
+        << "  " << dtype << " operands[4], outs[4];\n"
+           "  bool back_array[4] = {false, false, false, false};\n"
+           "  CHECK(arity <= 4);\n"
+           "  for (; k < n; ++k) {\n"
+           "    for (int i = 0; i < arity; ++i) operands[i] = ops[i][k];\n"
+           "    bool discard = false;\n"
+           "    res[k] = execute" << suffix
+        << "(inst, operands, arity, outs, reg, discard, back_array);\n"
+           "  }\n"
+           "}\n\n";
+
+    auto& kernels = all_kernels[i];
+    ofs << "#ifdef SS_INST_AVX2\n";
+    for (auto* inst : _instList) {
+      if (inst->bitwidth() != bitwidth) continue;
+      string kernel_name = base_folder + "simd" + suffix + "/" + inst->name() + ".h";
+      ifstream f(kernel_name.c_str());
+      if (!f.good()) continue;
+      kernels.push_back(inst->name());
+      ofs << "__attribute__((target(\"avx2\"))) static int batch" << suffix << "_"
+          << inst->name() << "(const " << dtype << "* const* ops, int arity, " << dtype
+          << "* res, int n) {\n"
+             "  const OpCode inst = SS_" << inst->name() << ";\n"
+             "  (void) inst;\n"
+             "  (void) arity;\n";
+      std::string line;
+      while (std::getline(f, line)) {
+        ofs << "  " << line << "\n";
+      }
+      ofs << "}\n\n";
+    }
+    ofs << "#endif\n\n";
+
+    ofs << "void dsa::execute" << suffix << "_batch(OpCode inst, "
+        << "const " << dtype << "* const* ops, int arity, " << dtype << "* res, int n, "
+        << dtype << "* reg) {\n"
+           "  int k = 0;\n";
+    if (!kernels.empty()) {
+      ofs << "#ifdef SS_INST_AVX2\n"
+             "  if (ss_has_avx2()) {\n"
+             "    switch (inst) {\n";
+      for (auto& name : kernels) {
+        ofs << "      case SS_" << name << ": k = batch" << suffix << "_" << name
+            << "(ops, arity, res, n); break;\n";
+      }
+      ofs << "      default: break;\n"
+             "    }\n"
+             "  }\n"
+             "#endif\n";
+    }
+    ofs << "  ss_scalar(inst, ops, arity, res, k, n, reg);\n"
+           "}\n\n";
+  }
+
+  ofs << "bool dsa::has_batch_kernel(OpCode inst) {\n"
+         "#ifdef SS_INST_AVX2\n"
+         "  switch (inst) {\n";
+  for (auto& kernels : all_kernels) {
+    for (auto& name : kernels) {
+      ofs << "    case SS_" << name << ":\n";
+    }
+  }
+  ofs << "      return ss_has_avx2();\n"
+         "    default: break;\n"
+         "  }\n"
+         "#endif\n"
+         "  (void) inst;\n"
+         "  return false;\n"
+         "}\n";
   ofs.close();
 }
 
@@ -10,8 +10,8 @@ int16_t t0 = a0 >= b0 ? a0 : b0;
 int16_t t1 = a1 >= b1 ? a1 : b1;
 int16_t t2 = a2 >= b2 ? a2 : b2;
 int16_t t3 = a3 >= b3 ? a3 : b3;
-uint64_t c0 = (uint64_t)(t0) << 0;
-uint64_t c1 = (uint64_t)(t1) << 16;
-uint64_t c2 = (uint64_t)(t2) << 32;
-uint64_t c3 = (uint64_t)(t3) << 48;
+uint64_t c0 = (uint64_t)(uint16_t)(t0) << 0;
+uint64_t c1 = (uint64_t)(uint16_t)(t1) << 16;
+uint64_t c2 = (uint64_t)(uint16_t)(t2) << 32;
+uint64_t c3 = (uint64_t)(uint16_t)(t3) << 48;
 return c0 | c1 | c2 | c3;
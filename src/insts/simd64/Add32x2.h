@@ -0,0 +1,7 @@
+int k = 0;
+for (; k + 4 <= n; k += 4) {
+  __m256i a = SS_LOAD(0, k);
+  __m256i b = SS_LOAD(1, k);
+  SS_STORE(k, _mm256_add_epi32(a, b));
+}
+return k;
@@ -0,0 +1,14 @@
+// The NaN propagated by the scalar code depends on how the compiler orders the
+// operands, so the words with NaNs are left to the scalar body.
+uint64_t reg[8] = {0};
+int k = 0;
+for (; k + 4 <= n; k += 4) {
+  __m256 a = _mm256_castsi256_ps(SS_LOAD(0, k));
+  __m256 b = _mm256_castsi256_ps(SS_LOAD(1, k));
+  if (_mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_UNORD_Q))) {
+    ss_scalar(inst, ops, arity, res, k, k + 4, reg);
+  } else {
+    SS_STORE(k, _mm256_castps_si256(_mm256_add_ps(a, b)));
+  }
+}
+return k;
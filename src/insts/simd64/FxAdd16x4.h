@@ -0,0 +1,9 @@
+// FIX_TRUNC clamps to [-FIX_MAX, FIX_MAX], one above the saturation of adds.
+const __m256i fix_min = _mm256_set1_epi16(FIX_MIN);
+int k = 0;
+for (; k + 4 <= n; k += 4) {
+  __m256i a = SS_LOAD(0, k);
+  __m256i b = SS_LOAD(1, k);
+  SS_STORE(k, _mm256_max_epi16(_mm256_adds_epi16(a, b), fix_min));
+}
+return k;
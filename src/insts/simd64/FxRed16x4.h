@@ -0,0 +1,14 @@
+// A pairwise tree of ss_fx_add16, in the same order as the scalar version.
+const __m256i lo16 = _mm256_set1_epi64x(0xFFFF);
+int k = 0;
+for (; k + 4 <= n; k += 4) {
+  __m256i v = SS_LOAD(0, k);
+  __m256i swapped = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(v, 0xB1), 0xB1);
+  __m256i s = ss_fx_add16(v, swapped);
+  s = ss_fx_add16(s, _mm256_shuffle_epi32(s, 0xB1));
+  if (arity > 1) {
+    s = ss_fx_add16(s, SS_LOAD(1, k));
+  }
+  SS_STORE(k, _mm256_and_si256(s, lo16));
+}
+return k;
@@ -0,0 +1,15 @@
+// Sum the 16-bit lanes in 32-bit, so that the carries are kept as the scalar version.
+const __m256i lo16 = _mm256_set1_epi32(0xFFFF);
+const __m256i lo32 = _mm256_set1_epi64x(0xFFFFFFFF);
+const __m256i acc16 = _mm256_set1_epi64x(0xFFFF);
+int k = 0;
+for (; k + 4 <= n; k += 4) {
+  __m256i v = SS_LOAD(0, k);
+  __m256i s = _mm256_add_epi32(_mm256_and_si256(v, lo16), _mm256_srli_epi32(v, 16));
+  s = _mm256_and_si256(_mm256_add_epi32(s, _mm256_srli_epi64(s, 32)), lo32);
+  if (arity > 1) {
+    s = _mm256_add_epi64(s, _mm256_and_si256(SS_LOAD(1, k), acc16));
+  }
+  SS_STORE(k, s);
+}
+return k;
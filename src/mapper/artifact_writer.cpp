@@ -0,0 +1,67 @@
+#include "dsa/mapper/artifact_writer.h"
+
+#include "dsa/debug.h"
+
+namespace dsa {
+
+ArtifactPolicy ParseArtifactPolicy(const std::string& s) {
+  if (s == "none") return ArtifactPolicy::None;
+  if (s == "final") return ArtifactPolicy::Final;
+  CHECK(s == "all") << "Unknown artifact policy: " << s << ", expect none/final/all";
+  return ArtifactPolicy::All;
+}
+
+ArtifactWriter::~ArtifactWriter() {
+  {
+    std::lock_guard<std::mutex> guard(_lock);
+    _closing = true;
+  }
+  _cv.notify_one();
+  if (_worker.joinable()) {
+    _worker.join();
+  }
+}
+
+void ArtifactWriter::Submit(const std::string& filename, std::function<void()> dump) {
+  {
+    std::lock_guard<std::mutex> guard(_lock);
+    if (!_worker.joinable()) {
+      _worker = std::thread(&ArtifactWriter::Worker, this);
+    }
+    bool replaced = false;
+    for (auto& elem : _pending) {
+      if (elem.first == filename) {
+        elem.second = std::move(dump);
+        replaced = true;
+        break;
+      }
+    }
+    if (!replaced) {
+      _pending.emplace_back(filename, std::move(dump));
+    }
+  }
+  _cv.notify_one();
+}
+
+void ArtifactWriter::Drain() {
+  std::unique_lock<std::mutex> guard(_lock);
+  _idle.wait(guard, [this]() { return _pending.empty() && !_busy; });
+}
+
+void ArtifactWriter::Worker() {
+  std::unique_lock<std::mutex> guard(_lock);
+  while (true) {
+    _cv.wait(guard, [this]() { return _closing || !_pending.empty(); });
+    if (_pending.empty()) break;
+    auto dump = std::move(_pending.front().second);
+    _pending.erase(_pending.begin());
+    _busy = true;
+    guard.unlock();
+    dump();
+    guard.lock();
+    _busy = false;
+    _idle.notify_all();
+  }
+}
+
+}  // namespace dsa
@@ -1,6 +1,7 @@
 #include "dsa/mapper/dse.h"
 
-CodesignInstance::CodesignInstance(SSModel* model) : _ssModel(*model) {
+CodesignInstance::CodesignInstance(SSModel* model, dsa::Rng* rng_)
+    : _ssModel(*model), rng(rng_) {
   verify();
   unused_nodes = std::vector<bool>(model->subModel()->node_list().size(), true);
   unused_links = std::vector<bool>(model->subModel()->link_list().size(), true);
@@ -0,0 +1,197 @@
+#include "dsa/mapper/mapping_cache.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "dsa/debug.h"
+#include "dsa/mapper/scheduler.h"
+#include "../utils/string_utils.h"
+
+namespace dsa {
+
+namespace {
+
+/*! \brief The 64-bit FNV-1a hash, chained from a previous hash. */
+uint64_t Fnv1a(const std::string& s, uint64_t h = 0xcbf29ce484222325ull) {
+  for (unsigned char c : s) {
+    h = (h ^ c) * 0x100000001b3ull;
+  }
+  return h;
+}
+
+std::string ReadFile(const std::string& filename) {
+  std::ifstream ifs(filename);
+  CHECK(ifs.good()) << "Cannot open " << filename;
+  std::ostringstream oss;
+  oss << ifs.rdbuf();
+  return oss.str();
+}
+
+/*!
+ * \brief The text of a DFG without the comments, the empty lines, and the redundant
+ *        whitespaces, which do not change the graph.
+ */
+std::string NormalizeDfg(const std::string& filename) {
+  std::ifstream ifs(filename);
+  CHECK(ifs.good()) << "Cannot open " << filename;
+  std::string res, line;
+  while (std::getline(ifs, line)) {
+    auto comment = line.find('#');
+    if (comment != std::string::npos && line.compare(comment, 7, "#pragma") != 0) {
+      line.resize(comment);
+    }
+    std::istringstream iss(line);
+    std::string token, normalized;
+    while (iss >> token) {
+      normalized += normalized.empty() ? token : " " + token;
+    }
+    if (!normalized.empty()) {
+      res += normalized + "\n";
+    }
+  }
+  return res;
+}
+
+/*! \brief The files which are half written, or pinned by a reader, start with a dot and end with this. */
+const char* kTemporarySuffix = ".tmp";
+
+/*! \brief A file name in the directory private to this thread. */
+std::string Temporary(const std::string& dir, const std::string& key) {
+  static std::atomic<int> counter{0};
+  std::ostringstream oss;
+  oss << dir << "/." << key << "." << getpid() << "."
+      << std::hash<std::thread::id>()(std::this_thread::get_id()) << "." << counter++
+      << kTemporarySuffix;
+  return oss.str();
+}
+
+/*! \brief If a complete schedule has neither a latency mismatch nor an overused resource. */
+bool Legal(Schedule* sched, int& latmis, int& ovr) {
+  int lat = 0, agg_ovr = 0, max_util = 0;
+  sched->fixLatency(lat, latmis);
+  sched->get_overprov(ovr, agg_ovr, max_util);
+  return latmis == 0 && ovr == 0;
+}
+
+}  // namespace
+
+MappingCache::MappingCache(const std::string& dir_, int64_t max_bytes_,
+                           const std::string& options_)
+    : dir(dir_), max_bytes(max_bytes_), options(options_) {
+  make_directories(dir);
+}
+
+std::string MappingCache::Key(const std::string& dfg_filename,
+                              const std::string& model_filename) const {
+  bool text = string_utils::String(dfg_filename).EndsWith(".dfg");
+  uint64_t h = Fnv1a("mapping-v1");
+  h = Fnv1a(text ? NormalizeDfg(dfg_filename) : ReadFile(dfg_filename), Fnv1a("dfg", h));
+  h = Fnv1a(ReadFile(model_filename), Fnv1a("model", h));
+  h = Fnv1a(options, Fnv1a("options", h));
+  char buf[17];
+  snprintf(buf, sizeof buf, "%016llx", (unsigned long long)h);
+  return buf;
+}
+
+bool MappingCache::Load(const std::string& key, Schedule* sched) const {
+  // Pin the entry with a link of our own, so that an eviction by a concurrent build
+  // cannot remove it while it is parsed.
+  std::string entry = Entry(key), pinned = Temporary(dir, key);
+  if (link(entry.c_str(), pinned.c_str()) != 0) {
+    return false;
+  }
+  // The modification time is the recency of the entry for the eviction.
+  utimensat(AT_FDCWD, entry.c_str(), nullptr, 0);
+  sched->LoadMappingInJson(pinned);
+  unlink(pinned.c_str());
+
+  if (sched->num_left() != 0) {
+    LOG(CACHE) << "Entry " << key << " leaves " << sched->num_left() << " node(s) unmapped";
+    return false;
+  }
+  if (!sched->consistent()) {
+    LOG(CACHE) << "Entry " << key << " has inconsistent routes";
+    return false;
+  }
+  // Only legal mappings are stored, so anything else is not trusted.
+  int latmis = 0, ovr = 0;
+  if (!Legal(sched, latmis, ovr)) {
+    LOG(CACHE) << "Entry " << key << " has a mismatch of " << latmis << " and an overuse of "
+               << ovr;
+    return false;
+  }
+  return true;
+}
+
+void MappingCache::Store(const std::string& key, Schedule* sched) const {
+  // The best effort of a search which timed out is worth searching again.
+  int latmis = 0, ovr = 0;
+  if (!Legal(sched, latmis, ovr)) {
+    return;
+  }
+  std::string tmp = Temporary(dir, key);
+  // A partial entry, e.g. of a full disk, is never published.
+  if (!sched->DumpMappingInJson(tmp, true)) {
+    std::cerr << "Cannot write the mapping cache entry " << key << std::endl;
+    unlink(tmp.c_str());
+    return;
+  }
+  if (rename(tmp.c_str(), Entry(key).c_str()) != 0) {
+    std::cerr << "Cannot write the mapping cache entry " << key << ": " << strerror(errno)
+              << std::endl;
+    unlink(tmp.c_str());
+    return;
+  }
+  Evict();
+}
+
+void MappingCache::Evict() const {
+  DIR* d = opendir(dir.c_str());
+  if (!d) return;
+  // (last use, size, filename) of the entries
+  std::vector<std::tuple<time_t, int64_t, std::string>> entries;
+  int64_t total = 0;
+  time_t now = time(nullptr);
+  while (struct dirent* ent = readdir(d)) {
+    std::string name = ent->d_name;
+    std::string path = dir + "/" + name;
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) continue;
+    if (name[0] == '.') {
+      // The temporary files left by a build which crashed.
+      if (string_utils::String(name).EndsWith(kTemporarySuffix) && now - st.st_mtime > 3600) {
+        unlink(path.c_str());
+      }
+      continue;
+    }
+    if (!string_utils::String(name).EndsWith(".json")) continue;
+    entries.emplace_back(st.st_mtime, st.st_size, path);
+    total += st.st_size;
+  }
+  closedir(d);
+
+  std::sort(entries.begin(), entries.end());
+  for (auto& elem : entries) {
+    if (total <= max_bytes) break;
+    // Another build may have removed it already, which is as good.
+    unlink(std::get<2>(elem).c_str());
+    total -= std::get<1>(elem);
+  }
+}
+
+}  // namespace dsa
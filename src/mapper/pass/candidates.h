@@ -1,5 +1,7 @@
 #pragma once
 #include "dsa/mapper/schedule.h"
+#include "dsa/profile.h"
+#include "dsa/rng.h"
 
 namespace dsa{
 namespace mapper{
@@ -7,6 +9,7 @@ namespace mapper{
 struct CandidateSpotVisitor : dfg::Visitor {
 
   void Visit(SSDfgInst *inst) override {
+    PROFILE_SCOPE(CandidateSpot);
     auto fabric = sched->ssModel()->subModel();
     auto *model = fabric;
     std::vector<std::pair<int, ssnode*>> spots;
@@ -38,7 +41,7 @@ struct CandidateSpotVisitor : dfg::Visitor {
           }
           cnt = cnt / 8 + 1;
 
-          if (rand() % (cnt * cnt) == 0) {
+          if (rng.Below(cnt * cnt) == 0) {
             spots.emplace_back(k, fus[i]);
           } else {
             not_chosen_spots.emplace_back(k, fus[i]);
@@ -62,7 +65,7 @@ struct CandidateSpotVisitor : dfg::Visitor {
       spots = not_chosen_spots;
     }
 
-    std::random_shuffle(spots.begin(), spots.end());  
+    std::shuffle(spots.begin(), spots.end(), rng);
 
     int n = spots.size();
     if (n > max_candidates)
@@ -73,6 +76,7 @@ struct CandidateSpotVisitor : dfg::Visitor {
   }
 
   void Visit(SSDfgVecInput *input) override {
+    PROFILE_SCOPE(CandidateSpot);
     auto fabric = sched->ssModel()->subModel();
     auto vports = fabric->input_list();
     // Lets write size in units of bits
@@ -88,6 +92,7 @@ struct CandidateSpotVisitor : dfg::Visitor {
   }
 
   void Visit(SSDfgVecOutput *output) override {
+    PROFILE_SCOPE(CandidateSpot);
     auto fabric = sched->ssModel()->subModel();
     auto vports = fabric->output_list();
     // Lets write size in units of bits
@@ -102,12 +107,14 @@ struct CandidateSpotVisitor : dfg::Visitor {
     cnt[output->id()] = spots.size();
   }
 
-  CandidateSpotVisitor(Schedule *sched_, int max_candidates_) :
-    sched(sched_), max_candidates(max_candidates_), cnt(sched_->ssdfg()->nodes.size()),
+  CandidateSpotVisitor(Schedule *sched_, int max_candidates_, dsa::Rng &rng_) :
+    sched(sched_), max_candidates(max_candidates_), rng(rng_), cnt(sched_->ssdfg()->nodes.size()),
     candidates(sched_->ssdfg()->nodes.size()) {}
 
   Schedule *sched{nullptr};
   int max_candidates;
+  /*! \brief Which of the crowded spots are skipped, and the order of the spots. */
+  dsa::Rng &rng;
   std::vector<int> cnt;
   std::vector<std::vector<std::pair<int, ssnode*>>> candidates;
 };
@@ -4,75 +4,24 @@
 #include <vector>
 #include <map>
 
+#include "dsa/dfg/overlay.h"
 #include "dsa/dfg/ssdfg.h"
 #include "dsa/dfg/utils.h"
+#include "dsa/profile.h"
 
 namespace dsa {
 namespace dfg {
 namespace pass {
 
-inline void inject_noop_impl(SSDfg *dfg, int eid, SSDfgInst *inst) {
-  /* If inst is null:
-   * before: def -[eid]-> use
-   * after:  def -[new edge]-> noop -[eid]-> use
-   *
-   * If inst is not null:
-   * before: def -[eid]-> use
-   *          |
-   *          +---------> inst -> ...
-   *
-   * after:  def          use
-   *          |            ^
-   *          |            |
-   *          |          [eid]
-   *          |            |
-   *          +---------> inst -> ...
-   */
-  CHECK(eid < dfg->edges.size());
-  if (inst) {
-    auto &e0 = dfg->edges[eid];
-    // If we already have a noop, we need sanity check if it is a noop
-    CHECK(inst->inst() == dsa::SS_NONE && inst->ops().size() == 1)
-      << "The injected instruction should be a noop.";
-    auto &e1 = dfg->edges[inst->ops()[0].edges[0]];
-    // CHECK(e0.sid == e1.sid && e0.vid == e1.vid && e0.l == e1.l && e0.r == e1.r) <<
-    //   e0.name() << " " << e1.name();
-    CHECK(inst->values.size() == 1);
-  } else {
-    // Create a noop instruction.
-    dfg->emplace_back<SSDfgInst>(dfg, SS_NONE);
-    inst = &dfg->instructions.back();
-    // Create a edge from source to noop
-    dfg->edges.emplace_back(dfg, dfg->edges[eid].sid, dfg->edges[eid].vid, inst->id(),
-                            dfg->edges[eid].l, dfg->edges[eid].r);
-    std::vector<int> es{dfg->edges.back().id};
-    inst->ops().emplace_back(dfg, es, OperandType::data);
-  }
-  // Add this edge to inst's use.
-  inst->values[0].uses.push_back(eid);
-  // In both cases, we need remove the edge usage in the source.
-  bool found = false;
-  for (auto &value : dfg->edges[eid].def()->values) {
-    auto iter = std::find(value.uses.begin(), value.uses.end(), eid);
-    if (iter != value.uses.end()) {
-      value.uses.erase(iter);
-      found = true;
-    }
-  }
-  CHECK(found) << "The value used by this edge not found!";
-  // Change the edge source to the noop.
-  dfg->edges[eid].sid = inst->id();
-  dfg->edges[eid].vid = 0;
-}
-
 inline void
-inject_passthrus(SSDfg *dfg, Schedule *sched,
+inject_passthrus(DfgOverlay &dfg, Schedule *sched,
                  std::vector<int> &edge_length,
                  std::vector<std::pair<int, int>> &mapping,
                  std::vector<std::vector<int>> &edge_groups) {
+  auto *base = dfg.base();
   edge_length.resize(sched->edge_prop().size(), 0);
-  edge_groups.resize(dfg->edges.size());
-  mapping.resize(dfg->nodes.size(), {-1, -1});
+  edge_groups.resize(dfg.num_edges());
+  mapping.resize(dfg.num_nodes(), {-1, -1});
   using PassThruKey = std::tuple<int, int, int, int>;
   std::map<PassThruKey, int> replace;
   for (int i = 0, n = sched->edge_prop().size(); i < n; ++i) {
@@ -84,33 +33,30 @@ inject_passthrus(SSDfg *dfg, Schedule *sched,
         mapping[node->id()] = {loc.first, loc.second->id()};
       }
     };
-    f(dfg->edges[i].def());
-    f(dfg->edges[i].use());
+    f(base->edges[i].def());
+    f(base->edges[i].use());
     int distance = 1;
     for (int j = 1, m = ep.links.size(); j < m; ++j) {
       ++distance;
-      if (auto pass = dynamic_cast<ssfu*>(ep.links[j].second->orig())) {
-        PassThruKey key{ep.links[j].first, pass->id(),
-                        sched->ssdfg()->edges[i].sid, sched->ssdfg()->edges[i].vid};
+      if (auto pass = dynamic_cast<ssfu*>(sched->hw_link(ep.links[j].second)->orig())) {
+        PassThruKey key{ep.links[j].first, pass->id(), base->edges[i].sid, base->edges[i].vid};
         auto iter = replace.find(key);
         if (iter == replace.end()) {
-          inject_noop_impl(dfg, i, nullptr);
-          int iid = dfg->instructions.back().id();
+          int iid = dfg.InjectNoop(i);
           replace[key] = iid;
           if (iid >= mapping.size()) {
             mapping.resize(iid + 1);
             mapping[iid] = {ep.links[j].first, pass->id()};
           }
         } else {
-          auto inst = dynamic_cast<SSDfgInst*>(dfg->nodes[iter->second]);
-          CHECK(inst);
-          inject_noop_impl(dfg, i, inst);
+          dfg.InjectNoop(i, iter->second);
         }
-        LOG(EDGES) << dfg->edges.back().name() << " " << dfg->edges.back().id;
-        if (dfg->edges.back().id >= edge_length.size())
-          edge_length.resize(dfg->edges.back().id + 1);
-        edge_length[dfg->edges.back().id] = distance;
-        edge_groups[i].push_back(dfg->edges.back().id);
+        int last = dfg.num_edges() - 1;
+        LOG(EDGES) << dfg.edge_name(last) << " " << last;
+        if (last >= edge_length.size())
+          edge_length.resize(last + 1);
+        edge_length[last] = distance;
+        edge_groups[i].push_back(last);
         distance = 1;
       }
     }
@@ -120,18 +66,17 @@ inject_passthrus(SSDfg *dfg, Schedule *sched,
 }
 
 inline
-void dfg_impl(SSDfgNode *node, std::vector<bool> &visited,
-              std::vector<SSDfgNode*> &order) {
-  if (visited[node->id()]) {
+void dfg_impl(const DfgOverlay &dfg, int node, std::vector<bool> &visited,
+              std::vector<int> &order) {
+  if (visited[node]) {
     return;
   }
 
-  visited[node->id()] = true;
+  visited[node] = true;
 
-  for (auto &value : node->values) {
-    for (auto eid : value.uses) {
-      auto edge = &node->ssdfg()->edges[eid];
-      dfg_impl(edge->use(), visited, order);
+  for (int i = 0, n = dfg.num_values(node); i < n; ++i) {
+    for (auto eid : dfg.uses(node, i)) {
+      dfg_impl(dfg, dfg.dst(eid), visited, order);
     }
   }
 
@@ -139,20 +84,16 @@ void dfg_impl(SSDfgNode *node, std::vector<bool> &visited,
 }
 
 /* \brief Return the reversed topological order of the dataflow graph */
-inline std::vector<SSDfgNode*> reversed_topology(SSDfg *dfg) {
-  struct Rooter : Visitor {
-    Rooter(int n) : visited(n, false) {
-      res.reserve(n);
+inline std::vector<int> reversed_topology(const DfgOverlay &dfg) {
+  std::vector<bool> visited(dfg.num_nodes(), false);
+  std::vector<int> res;
+  res.reserve(dfg.num_nodes());
+  for (auto *node : dfg.base()->nodes) {
+    if (dynamic_cast<SSDfgVecInput*>(node)) {
+      dfg_impl(dfg, node->id(), visited, res);
     }
-    std::vector<bool> visited;
-    std::vector<SSDfgNode*> res;
-    void Visit(SSDfgVecInput *input) override {
-      dfg_impl(input, visited, res);
-    }
-  };
-  Rooter rooter(dfg->nodes.size());
-  dfg->Apply(&rooter);
-  return rooter.res;
+  }
+  return res;
 }
 
 struct Bounds {
@@ -165,36 +106,26 @@ struct Bounds {
   }
 };
 
-struct ResetBoundVisitor : Visitor {
-  ResetBoundVisitor(std::vector<Bounds> &b) : bounds(b) {}
-  void Visit(SSDfgInst *inst) {
-    bounds[inst->id()].min = 0;
-    bounds[inst->id()].max = INT_MAX - 10000;
-  }
-  void Visit(SSDfgVecOutput *output) {
-    bounds[output->id()].min = 0;
-    bounds[output->id()].max = INT_MAX - 10000;
-  }
-  void Visit(SSDfgVecInput *input) {
-    bounds[input->id()].min = bounds[input->id()].max = 0;
+inline void reset_bounds(const DfgOverlay &dfg, std::vector<Bounds> &bounds) {
+  for (int i = 0, n = dfg.num_nodes(); i < n; ++i) {
+    bounds[i].min = 0;
+    bounds[i].max = dynamic_cast<SSDfgVecInput*>(dfg.node(i)) ? 0 : INT_MAX - 10000;
   }
-  std::vector<Bounds> &bounds;
-};
+}
 
 const int min_expect = 2;
 const int max_expect = 8;
 
-void iterative_bounds(SSDfg *dfg, std::vector<SSDfgNode*> &non_temp,
-                      std::vector<int> &edge_length,
-                      std::vector<std::pair<int, int>> &mapping,
-                      SSModel *model, std::vector<Bounds> &bounds) {
+inline void iterative_bounds(const DfgOverlay &dfg, std::vector<int> &non_temp,
+                             std::vector<int> &edge_length,
+                             std::vector<std::pair<int, int>> &mapping,
+                             SSModel *model, std::vector<Bounds> &bounds) {
   bool changed = true;
   bool overflow = false;
   int iters = 0;
   int max_mis = 0;
-  bounds.resize(dfg->nodes.size());
-  ResetBoundVisitor rbv(bounds);
-  dfg->Apply(&rbv);
+  bounds.resize(dfg.num_nodes());
+  reset_bounds(dfg, bounds);
 
   while (changed || overflow) {
     changed = false;
@@ -203,46 +134,43 @@ void iterative_bounds(SSDfg *dfg, std::vector<SSDfgNode*> &non_temp,
     LOG(LAT_PASS) << "=================== " << iters << " ===================";
     if (overflow) {
       overflow = false;
-      dfg->Apply(&rbv);
+      reset_bounds(dfg, bounds);
       max_mis++;
     }
 
     // FORWARD PASS
     for (int i = non_temp.size() - 1; i >= 0; --i) {
-      SSDfgNode* node = non_temp[i];
-      auto& vp = bounds[node->id()];
-      int new_min = bounds[node->id()].min;
-      int new_max = bounds[node->id()].max;
+      int node = non_temp[i];
+      auto& vp = bounds[node];
+      int new_min = bounds[node].min;
+      int new_max = bounds[node].max;
 
-      for (auto &op : node->ops()) {
-        for (auto &eid : op.edges) {
-          auto edge = &dfg->edges[eid];
-          SSDfgNode* origNode = edge->def();
-          auto& orig_vp = bounds[origNode->id()];
+      for (auto eid : dfg.in_edges(node)) {
+        int origNode = dfg.src(eid);
+        auto& orig_vp = bounds[origNode];
 
-          int routing_latency = edge_length[eid];
-          int edge_lat = origNode->lat_of_inst() + routing_latency - 1;
+        int routing_latency = edge_length[eid];
+        int edge_lat = dfg.lat_of_inst(origNode) + routing_latency - 1;
 
-          int fu_idx = mapping[edge->uid].second;
-          auto max_ed = fu_idx != -1 ? model->subModel()->node_list()[fu_idx]->delay_fifo_depth() : 0;
+        int fu_idx = mapping[dfg.dst(eid)].second;
+        auto max_ed = fu_idx != -1 ? model->subModel()->node_list()[fu_idx]->delay_fifo_depth() : 0;
 
-          // cout << " -----------------" <<  edge->name() << ": " << edge_lat << "\n";
+        // cout << " -----------------" <<  edge->name() << ": " << edge_lat << "\n";
 
-          // This edge is routed
-          if (routing_latency != 0) {
-            // LOG(LAT_PASS) << edge->name();
-            // LOG(LAT_PASS) << orig_vp.min << ", " << orig_vp.max;
-            // LOG(LAT_PASS) << new_min << ", " << new_max;
-            // LOG(LAT_PASS) << edge_lat << " " << max_ed << " " << max_mis;
-            new_min = std::max(new_min, orig_vp.min + edge_lat);
-            new_max = std::min(new_max, orig_vp.max + edge_lat + max_ed + max_mis);
-          } else {
-            // This edge is not routed, so give worst case upper bound
-            new_min =
-                std::max(new_min, orig_vp.min + edge_lat + min_expect);
-            new_max = std::min(new_max, orig_vp.max + edge_lat + max_ed + max_mis +
-                                            max_expect);
-          }
+        // This edge is routed
+        if (routing_latency != 0) {
+          // LOG(LAT_PASS) << edge->name();
+          // LOG(LAT_PASS) << orig_vp.min << ", " << orig_vp.max;
+          // LOG(LAT_PASS) << new_min << ", " << new_max;
+          // LOG(LAT_PASS) << edge_lat << " " << max_ed << " " << max_mis;
+          new_min = std::max(new_min, orig_vp.min + edge_lat);
+          new_max = std::min(new_max, orig_vp.max + edge_lat + max_ed + max_mis);
+        } else {
+          // This edge is not routed, so give worst case upper bound
+          new_min =
+              std::max(new_min, orig_vp.min + edge_lat + min_expect);
+          new_max = std::min(new_max, orig_vp.max + edge_lat + max_ed + max_mis +
+                                          max_expect);
         }
       }
       changed |= new_min != vp.min;
@@ -261,21 +189,20 @@ void iterative_bounds(SSDfg *dfg, std::vector<SSDfgNode*> &non_temp,
 
     // BACKWARDS PASS
     for (int i = 0, n = non_temp.size(); i < n; ++i) {
-      SSDfgNode* node = non_temp[i];
-      auto& vp = bounds[node->id()];
+      int node = non_temp[i];
+      auto& vp = bounds[node];
       int new_min = vp.min;
       int new_max = vp.max;
 
-      for (auto &value : node->values) {
-        for (auto eid : value.uses) {
-          auto edge = &dfg->edges[eid];
-          SSDfgNode* useNode = edge->use();
-          auto& use_vp = bounds[useNode->id()];
+      for (int j = 0, m = dfg.num_values(node); j < m; ++j) {
+        for (auto eid : dfg.uses(node, j)) {
+          int useNode = dfg.dst(eid);
+          auto& use_vp = bounds[useNode];
 
           int routing_latency = edge_length[eid];
-          int edge_lat = routing_latency - 1 + node->lat_of_inst();
+          int edge_lat = routing_latency - 1 + dfg.lat_of_inst(node);
 
-          int fu_idx = mapping[edge->uid].second;
+          int fu_idx = mapping[dfg.dst(eid)].second;
           auto max_ed = fu_idx != -1 ? model->subModel()->node_list()[fu_idx]->delay_fifo_depth() : 0;
 
           if (routing_latency != 0) {
@@ -308,64 +235,61 @@ void iterative_bounds(SSDfg *dfg, std::vector<SSDfgNode*> &non_temp,
   }
 }
 
-void assign_latency(SSDfg *dfg,
-                    SSModel *model,
-                    std::vector<SSDfgNode*> &non_temp,
-                    std::vector<int> &edge_length,
-                    std::vector<std::pair<int, int>> &mapping,
-                    std::vector<Bounds> &bounds,
-                    std::vector<int> &latency,
-                    std::vector<int> &edge_violation,
-                    std::vector<int> &edge_delay) {
-  latency.resize(dfg->nodes.size(), 0);
-  edge_violation.resize(dfg->edges.size(), 0);
-  edge_delay.resize(dfg->edges.size(), 0);
+inline void assign_latency(const DfgOverlay &dfg,
+                           SSModel *model,
+                           std::vector<int> &non_temp,
+                           std::vector<int> &edge_length,
+                           std::vector<std::pair<int, int>> &mapping,
+                           std::vector<Bounds> &bounds,
+                           std::vector<int> &latency,
+                           std::vector<int> &edge_violation,
+                           std::vector<int> &edge_delay) {
+  latency.resize(dfg.num_nodes(), 0);
+  edge_violation.resize(dfg.num_edges(), 0);
+  edge_delay.resize(dfg.num_edges(), 0);
   for (int i = non_temp.size() - 1; i >= 0; --i) {
-    auto *node = non_temp[i];
-    auto& vp = bounds[node->id()];
+    int node = non_temp[i];
+    auto& vp = bounds[node];
     int target = vp.min;
-    LOG(LAT_PASS) << "process: " << node->name();
+    LOG(LAT_PASS) << "process: " << dfg.name(node);
 
     int max = 0;
     // int mis = 0;
-    for (auto &op : node->ops()) {
-      for (auto eid : op.edges) {
-        auto edge = &dfg->edges[eid];
-        SSDfgNode* origNode = edge->def();
+    for (auto eid : dfg.in_edges(node)) {
+      int origNode = dfg.src(eid);
 
-        int routing_latency = edge_length[eid];
-        // int max_edge_delay = _ssModel->maxEdgeDelay();
-        int fu_idx = mapping[edge->uid].second;
-        auto max_ed = fu_idx != -1 ? model->subModel()->node_list()[fu_idx]->delay_fifo_depth() : 0;
+      int routing_latency = edge_length[eid];
+      // int max_edge_delay = _ssModel->maxEdgeDelay();
+      int fu_idx = mapping[dfg.dst(eid)].second;
+      auto max_ed = fu_idx != -1 ? model->subModel()->node_list()[fu_idx]->delay_fifo_depth() : 0;
 
-        if (routing_latency == 0) {  // if its not scheduled yet, be more liberal
-          routing_latency = min_expect;
-          max_ed += max_expect;
-        }
+      if (routing_latency == 0) {  // if its not scheduled yet, be more liberal
+        routing_latency = min_expect;
+        max_ed += max_expect;
+      }
 
-        int lat = latency[origNode->id()] + routing_latency - 1;
+      int lat = latency[origNode] + routing_latency - 1;
 
-        int diff = std::max(std::min(max_ed, target - lat), 0);
-        // mis = std::max(mis,(target- lat) - diff);
-        edge_delay[eid] = diff;
+      int diff = std::max(std::min(max_ed, target - lat), 0);
+      // mis = std::max(mis,(target- lat) - diff);
+      edge_delay[eid] = diff;
 
-        int vio = std::max(0, (target - lat) - max_ed);
-        edge_violation[eid] = vio;
-        LOG(LAT_PASS) << edge->name();
-        LOG(LAT_PASS) << "src lat: " << latency[origNode->id()] << ", "
-                      << "edge lat: " <<  edge_length[eid] << ", "
-                      << "bounds: " << bounds[node->id()].ToString();
-        LOG(LAT_PASS) << "delay: " << diff << "  vio: " << vio;
+      int vio = std::max(0, (target - lat) - max_ed);
+      edge_violation[eid] = vio;
+      LOG(LAT_PASS) << dfg.edge_name(eid);
+      LOG(LAT_PASS) << "src lat: " << latency[origNode] << ", "
+                    << "edge lat: " <<  edge_length[eid] << ", "
+                    << "bounds: " << bounds[node].ToString();
+      LOG(LAT_PASS) << "delay: " << diff << "  vio: " << vio;
 
-        max = std::max(max, lat + diff);
-      }
+      max = std::max(max, lat + diff);
     }
-    latency[node->id()] = node->lat_of_inst() + max;
+    latency[node] = dfg.lat_of_inst(node) + max;
   }
 }
 
-inline void calc_mis_vio(SSDfg *dfg,
-                         std::vector<SSDfgNode*> &non_temp,
+inline void calc_mis_vio(const DfgOverlay &dfg,
+                         std::vector<int> &non_temp,
                          std::vector<int> &edge_latency,
                          std::vector<int> &edge_delay,
                          std::vector<int> &latency,
@@ -375,51 +299,46 @@ inline void calc_mis_vio(SSDfg *dfg,
                          std::vector<int> &group_mismatch,
                          std::vector<int> &node_violation) {
   max_lat = max_lat_mis = total_vio = 0;
-  group_mismatch.resize(dfg->num_groups());
-  node_violation.resize(dfg->nodes.size());
+  group_mismatch.resize(dfg.base()->num_groups());
+  node_violation.resize(dfg.num_nodes());
   std::fill(group_mismatch.begin(), group_mismatch.end(), 0);
   std::fill(node_violation.begin(), node_violation.end(), 0);
 
   for (int i = non_temp.size() - 1; i >= 0; --i) {
     int low_lat = MAX_SCHED_LAT, up_lat = 0;
-    auto node = non_temp[i];
-    for (auto &op : node->ops()) {
-      for (auto eid : op.edges) {
-        auto edge = &dfg->edges[eid];
-        SSDfgNode* origNode = edge->def();
-
-        // If routing latency is 0, then its okay to assume minimum
-        CHECK(eid >=0 && eid < edge_latency.size()) << eid << " " << edge_latency.size();
-        int routing_latency = edge_latency[eid];
-        if (routing_latency == 0) {
-          routing_latency = min_expect;
-        }
+    int node = non_temp[i];
+    for (auto eid : dfg.in_edges(node)) {
+      int origNode = dfg.src(eid);
+
+      // If routing latency is 0, then its okay to assume minimum
+      CHECK(eid >=0 && eid < edge_latency.size()) << eid << " " << edge_latency.size();
+      int routing_latency = edge_latency[eid];
+      if (routing_latency == 0) {
+        routing_latency = min_expect;
+      }
 
-        if (origNode != nullptr) {
-          int edge_lat = edge_delay[eid] + routing_latency - 1;
-          CHECK(edge_lat >= 0);
-          int lat = latency[origNode->id()] + edge_lat;
+      int edge_lat = edge_delay[eid] + routing_latency - 1;
+      CHECK(edge_lat >= 0);
+      int lat = latency[origNode] + edge_lat;
 
-          if (lat > up_lat) up_lat = lat;
-          if (lat < low_lat) low_lat = lat;
-        }
-      }
+      if (lat > up_lat) up_lat = lat;
+      if (lat < low_lat) low_lat = lat;
     }
     int diff = up_lat - low_lat;  // - _ssModel->maxEdgeDelay();
 
-    if (!node->is_temporal()) {
+    if (!dfg.is_temporal(node)) {
       if (diff > max_lat_mis) {
         max_lat_mis = diff;
       }
-      if (diff > group_mismatch[node->group_id()]) {
-        group_mismatch[node->group_id()] = diff;
+      if (diff > group_mismatch[dfg.group_id(node)]) {
+        group_mismatch[dfg.group_id(node)] = diff;
       }
       total_vio += std::max(0, diff);
-      node_violation[node->id()] = diff;
+      node_violation[node] = diff;
     }
 
-    int new_lat = node->lat_of_inst() + up_lat;
-    latency[node->id()] = new_lat;
+    int new_lat = dfg.lat_of_inst(node) + up_lat;
+    latency[node] = new_lat;
 
     if (max_lat < new_lat) max_lat = new_lat;
   }
@@ -429,48 +348,49 @@ inline SSDfg* IterativeLatency(Schedule *sched, int &max_lat,
                                int &max_lat_mis, int &total_vio,
                                std::vector<int> &group_mismatch,
                                bool is_export) {
-  SSDfg dfg_(*sched->ssdfg());
-  // Inject passthrough noops into the DFG.
+  PROFILE_SCOPE(IterativeLatency);
+  // Inject passthrough noops into a view of the DFG.
+  DfgOverlay dfg_(sched->ssdfg());
   std::vector<std::vector<int>> edge_groups;
   std::vector<int> edge_length;
   std::vector<std::pair<int, int>> mapping;
-  inject_passthrus(&dfg_, sched, edge_length, mapping, edge_groups);
+  inject_passthrus(dfg_, sched, edge_length, mapping, edge_groups);
   for (auto &edge : sched->ssdfg()->edges) {
     LOG(LAT_PASS) << edge.name();
     for (auto &lp : sched->edge_prop()[edge.id].links) {
-      LOG(LAT_PASS) << lp.first << " " << lp.second->name();
+      LOG(LAT_PASS) << lp.first << " " << sched->hw_link(lp.second)->name();
     }
   }
-  CHECK(edge_length.size() == dfg_.edges.size()) << edge_length.size() << " " << dfg_.edges.size();
+  CHECK(edge_length.size() == dfg_.num_edges()) << edge_length.size() << " " << dfg_.num_edges();
   // Sort the new DFG nodes in topological order.
-  auto ordered = reversed_topology(&dfg_);
-  std::vector<SSDfgNode*> non_temp;
+  auto ordered = reversed_topology(dfg_);
+  std::vector<int> non_temp;
   std::copy_if(ordered.begin(), ordered.end(), std::back_inserter(non_temp),
-               [](SSDfgNode* node) { return !node->is_temporal(); });
+               [&dfg_](int node) { return !dfg_.is_temporal(node); });
   for (auto elem : non_temp) {
-    LOG(LAT_PASS) << "topo: " << elem->name();
+    LOG(LAT_PASS) << "topo: " << dfg_.name(elem);
   }
   std::vector<Bounds> bounds;
   // Migrate legacy iterative bound here.
-  iterative_bounds(&dfg_, non_temp, edge_length, mapping, sched->ssModel(), bounds);
+  iterative_bounds(dfg_, non_temp, edge_length, mapping, sched->ssModel(), bounds);
 
   for (auto elem : non_temp) {
-    LOG(LAT_PASS) << elem->name() << "[" << bounds[elem->id()].min << ", "
-                  << bounds[elem->id()].max << "]";
+    LOG(LAT_PASS) << dfg_.name(elem) << "[" << bounds[elem].min << ", "
+                  << bounds[elem].max << "]";
   }
 
   // Migrate legacy latency pass here.
   std::vector<int> latency, edge_delay, edge_violation;
-  assign_latency(&dfg_, sched->ssModel(), non_temp, edge_length,
+  assign_latency(dfg_, sched->ssModel(), non_temp, edge_length,
                  mapping, bounds, latency, edge_violation, edge_delay);
 
-  for (auto node : dfg_.nodes) {
-    LOG(LAT_PASS) << node->name() << ": " << latency[node->id()];
+  for (int i = 0, n = dfg_.num_nodes(); i < n; ++i) {
+    LOG(LAT_PASS) << dfg_.name(i) << ": " << latency[i];
   }
 
   // Migrate legacy violation calculation here.
   std::vector<int> node_vio;
-  calc_mis_vio(&dfg_, non_temp, edge_length, edge_delay, latency,
+  calc_mis_vio(dfg_, non_temp, edge_length, edge_delay, latency,
                max_lat, max_lat_mis, total_vio, group_mismatch, node_vio);
   // Commit results to the schedule.
   for (auto elem : sched->ssdfg()->nodes) {
@@ -484,7 +404,7 @@ inline SSDfg* IterativeLatency(Schedule *sched, int &max_lat,
     sched->edge_prop()[elem.id].extra_lat = sched->edge_prop()[elem.id].vio = 0;
     LOG(LAT_PASS) << "edge: " << elem.name();
     for (auto id : edge_groups[elem.id]) {
-      LOG(LAT_PASS) << "member: " << dfg_.edges[id].name();
+      LOG(LAT_PASS) << "member: " << dfg_.edge_name(id);
       sched->edge_prop()[elem.id].extra_lat += edge_delay[id];
       sched->edge_prop()[elem.id].vio += edge_violation[id];
     }
@@ -494,7 +414,8 @@ inline SSDfg* IterativeLatency(Schedule *sched, int &max_lat,
                 << "latency: " << max_lat << " "
                 << "mis: " << max_lat_mis;
   if (is_export) {
-    SSDfg *res = new SSDfg(dfg_);
+    // Only the exported DFG needs the noops as real nodes.
+    SSDfg *res = dfg_.Materialize();
     for (auto &elem : res->edges) {
       elem.delay = edge_delay[elem.id];
     }
@@ -502,7 +423,6 @@ inline SSDfg* IterativeLatency(Schedule *sched, int &max_lat,
   }
   return nullptr;
 }
-
 }
 }
 }
\ No newline at end of file
@@ -11,6 +11,7 @@ ShortestPaths(SpatialFabric *fabric) {
   int n = fabric->node_list().size();
   std::vector<std::vector<int>> res(n, std::vector<int>(n, 1e6));
   for (auto elem : fabric->node_list()) {
+    if (!elem) continue;
     res[elem->id()][elem->id()] = 0;
     for (auto link : elem->out_links()) {
       res[elem->id()][link->dest()->id()] = 1;
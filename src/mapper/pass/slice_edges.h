@@ -1,21 +1,35 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
 #include "dsa/dfg/ssdfg.h"
 
 namespace dsa {
 namespace dfg {
 namespace pass {
 
-void split_edge(const std::vector<int> &v, SSDfg *dfg, int eid) {
+/*!
+ * \brief Split an edge into the slices of its value.
+ * \param v The slices, as the pairs of [l, r], in order.
+ * \param dfg The DFG the edge belongs to.
+ * \param eid The edge to split. It becomes the first slice, and the others are new edges
+ *        placed right after it in both the uses of the value and the consuming operand.
+ */
+inline void split_edge(const std::vector<int> &v, SSDfg *dfg, int eid) {
   std::vector<Edge> &edges = dfg->edges;
-  int l = edges[eid].l;
-  int r = edges[eid].r;
-  auto &uses = dfg->nodes[edges[eid].sid]->values[edges[eid].vid].uses;
+  // Copy the endpoints, since emplacing the new edges may move the edge.
+  int sid = edges[eid].sid;
+  int vid = edges[eid].vid;
+  int uid = edges[eid].uid;
+  auto &uses = dfg->nodes[sid]->values[vid].uses;
   auto use_idx = std::find(uses.begin(), uses.end(), eid) - uses.begin();
   CHECK(use_idx != uses.size());
 
   Operand *op = nullptr;
   int op_idx = -1;
   {
-    for (auto &elem : dfg->nodes[edges[eid].uid]->ops()) {
+    for (auto &elem : dfg->nodes[uid]->ops()) {
       auto iter = std::find(elem.edges.begin(), elem.edges.end(), eid);
       if (iter != elem.edges.end()) {
         op = &elem;
@@ -26,13 +40,12 @@ void split_edge(const std::vector<int> &v, SSDfg *dfg, int eid) {
     CHECK(op && op_idx != -1);
   }
 
-  auto &edge = edges[eid];
   for (int i = 0, n = v.size(); i < n; i += 2) {
     if (i == 0) {
-      edge.l = v[i];
-      edge.r = v[i + 1];
+      edges[eid].l = v[i];
+      edges[eid].r = v[i + 1];
     } else {
-      edges.emplace_back(dfg, edge.sid, edge.vid, edge.uid, v[i], v[i + 1]);
+      edges.emplace_back(dfg, sid, vid, uid, v[i], v[i + 1]);
       uses.insert(uses.begin() + use_idx, edges.back().id);
       op->edges.insert(op->edges.begin() + op_idx, edges.back().id);
     }
@@ -41,52 +54,55 @@ void split_edge(const std::vector<int> &v, SSDfg *dfg, int eid) {
   }
 }
 
+/*!
+ * \brief Slice the overlapped edges of each value, so that any two edges from a value
+ *        either cover the same bits or are disjoint. The boundaries of all the edges of
+ *        a value are sorted, and each edge is cut at the boundaries strictly inside it.
+ *        Only an edge overlapping another one can place a boundary inside it, so the
+ *        slices are the coarsest ones, and slicing a sliced DFG changes nothing.
+ */
 inline void SliceOverlappedEdges(SSDfg *dfg) {
   auto &edges = dfg->edges;
-  auto &nodes = dfg->nodes;
-  for (int i = 0, n = edges.size(); i < n; ++i) {
-    for (int j = i + 1; j < n; ++j) {
-      if (edges[i].sid == edges[j].sid && edges[j].vid == edges[j].vid) {
-        if (edges[i].r < edges[j].l || edges[j].r < edges[i].l) {
+  std::vector<int> bounds, v;
+  for (auto *node : dfg->nodes) {
+    for (auto &value : node->values) {
+      // A slice [l, r] starts a segment at l, and another one at r + 1.
+      bounds.clear();
+      for (auto eid : value.uses) {
+        if (edges[eid].l <= edges[eid].r) {
+          bounds.push_back(edges[eid].l);
+          bounds.push_back(edges[eid].r + 1);
+        }
+      }
+      std::sort(bounds.begin(), bounds.end());
+      bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+      if (bounds.size() <= 2) {
+        continue;
+      }
+      // split_edge inserts into the uses, so the edges to split are walked on a copy.
+      std::vector<int> uses(value.uses);
+      for (auto eid : uses) {
+        int l = edges[eid].l;
+        int r = edges[eid].r;
+        if (l > r) {
           continue;
         }
-        if (edges[i].l == edges[j].l && edges[i].r == edges[j].r) {
+        auto iter = std::upper_bound(bounds.begin(), bounds.end(), l);
+        if (iter == bounds.end() || *iter > r) {
           continue;
         }
-        std::vector<int> v;
-        int l = std::min(edges[i].l, edges[j].l);
-        int r = std::max(edges[i].r, edges[j].r);
+        v.clear();
         v.push_back(l);
+        for (; iter != bounds.end() && *iter <= r; ++iter) {
+          v.push_back(*iter - 1);
+          v.push_back(*iter);
+        }
         v.push_back(r);
-#define PUSH_POINT(v, mid, l, r, is_left) \
-  do {                                    \
-    if (l < mid && mid < r) {             \
-      if (is_left) {                      \
-        v.push_back(mid - 1);             \
-        v.push_back(mid);                 \
-      } else {                            \
-        v.push_back(mid);                 \
-        v.push_back(mid + 1);             \
-      }                                   \
-    }                                     \
-  } while (false)
-        PUSH_POINT(v, edges[i].l, l, r, true);
-        PUSH_POINT(v, edges[j].l, l, r, true);
-        PUSH_POINT(v, edges[i].r, l, r, false);
-        PUSH_POINT(v, edges[j].r, l, r, false);
-        std::sort(v.begin(), v.end());
-        auto tail = std::unique(v.begin(), v.end());
-        v.erase(tail, v.end());
-        LOG(SLICE) << l << ", " << r;
-        LOG(SLICE) << edges[i].name();
-        LOG(SLICE) << edges[j].name();
+        LOG(SLICE) << edges[eid].name();
         for (auto elem : v) {
           LOG(SLICE) << elem;
         }
-        CHECK(v.size() % 2 == 0) << v.size();
-        split_edge(v, dfg, i);
-        split_edge(v, dfg, j);
-#undef PUSH_POINT
+        split_edge(v, dfg, eid);
       }
     }
   }
@@ -96,7 +112,6 @@ inline void SliceOverlappedEdges(SSDfg *dfg) {
   }
 }
 
-
 }
 }
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 
 #include <assert.h>
+#include <sys/stat.h>
 
 #include <exception>
 #include <fstream>
@@ -16,9 +17,10 @@
 #include "dsa/dfg/visitor.h"
 #include "dsa/dfg/utils.h"
 #include "dsa/mapper/dse.h"
-#include "json.tab.h"
-#include "json.lex.h"
+#include "dsa/profile.h"
+#include "../utils/json_parsing.h"
 #include "../utils/model_parsing.h"
+#include "../utils/string_utils.h"
 #include "../utils/color_mapper.h"
 #include "../utils/vector_utils.h"
 
@@ -40,6 +42,20 @@ std::map<dsa::OpCode, int> Schedule::interpretConfigBits(int size, uint64_t* bit
 
 std::map<dsa::OpCode, int> Schedule::interpretConfigBitsCheat(char* s) {
   auto filename = std::string("sched/") + s;
+  // Prefer the binary dump of printConfigCheat, which is loaded without parsing, unless the
+  // json is dumped again after it, e.g. by a build which does not dump the binary.
+  auto binary = string_utils::String(filename).EndsWith(".dfg.json")
+                    ? filename.substr(0, filename.size() - 5) + ".bin"
+                    : filename + ".dfg.bin";
+  struct stat bin_st, json_st;
+  if (stat(binary.c_str(), &bin_st) == 0) {
+    auto mtime = [](const struct stat& st) {
+      return std::make_pair(st.st_mtim.tv_sec, st.st_mtim.tv_nsec);
+    };
+    if (stat(filename.c_str(), &json_st) != 0 || mtime(bin_st) >= mtime(json_st)) {
+      filename = binary;
+    }
+  }
   _ssDFG = dsa::dfg::Import(filename);
   struct Counter : dfg::Visitor {
     void Visit(SSDfgInst *inst) {
@@ -52,19 +68,30 @@ std::map<dsa::OpCode, int> Schedule::interpretConfigBitsCheat(char* s) {
 }
 
 void Schedule::LoadMappingInJson(const std::string& mapping_filename){
-  FILE *fjson = fopen(mapping_filename.c_str(), "r");
-  CHECK(fjson) << "Open " << mapping_filename << " failed";
-  JSONrestart(fjson);
-  struct params p;
-  JSONparse(&p);
-
-  auto &json = p.data;
+  auto json = json_parsing::Parse(mapping_filename);
   auto &instructions = *json->As<plain::Array>();
 
   SSDfg* dfg = ssdfg();
   SpatialFabric* fabric = ssModel()->subModel();
   for (int i = 0, n = instructions.size(); i < n; ++i) {
-    auto &obj = *instructions[i]->As<plain::Object>();
+    plain::Object obj;
+    if (auto tuple = instructions[i]->As<plain::Array>()) {
+      // The compact form, whose values are in the order of the keys below.
+      static const std::map<std::string, std::vector<std::string>> keys = {
+        {"assign_node", {"dfgnode", "adgnode", "adgslot"}},
+        {"assign_link", {"dfgedge", "adglink", "adgslot"}},
+        {"assign_delay", {"dfgedge", "delay"}},
+      };
+      obj["op"] = (*tuple)[0];
+      auto iter = keys.find(*(*tuple)[0]->As<std::string>());
+      CHECK(iter != keys.end()) << "Unknown mapping instruction " << *obj["op"]->As<std::string>();
+      CHECK(iter->second.size() + 1 == tuple->size());
+      for (int j = 0, m = iter->second.size(); j < m; ++j) {
+        obj[iter->second[j]] = (*tuple)[j + 1];
+      }
+    } else {
+      obj = *instructions[i]->As<plain::Object>();
+    }
     auto &op = *obj["op"]->As<std::string>();
     if (op == "assign_node") {
       auto dfgnode = *obj["dfgnode"]->As<int64_t>();
@@ -85,53 +112,70 @@ void Schedule::LoadMappingInJson(const std::string& mapping_filename){
     }
   }
 
-
+  // The functional units a route passes through are not dumped, but implied by the links.
+  for (auto& edge : dfg->edges) {
+    auto& links = links_of(&edge);
+    for (int i = 0, n = links.size(); i + 1 < n; ++i) {
+      sslink* link = hw_link(links[i].second);
+      if (dynamic_cast<ssfu*>(link->dest())) {
+        assign_edge_pt(&edge, {links[i].first, link->dest()});
+      }
+    }
+  }
 }
 
-void Schedule::DumpMappingInJson(const std::string& mapping_filename){
-  ofstream os(mapping_filename);
-  CHECK(os.good());
+bool Schedule::DumpMappingInJson(const std::string& mapping_filename, bool compact){
+  PROFILE_SCOPE(DumpJson);
+  JSONWriter w(mapping_filename, compact);
+  CHECK(w.good());
 
   SSDfg * ssDFG = ssdfg();
   std::vector<SSDfgNode*> &nodes = ssDFG->nodes;
   std::vector<dsa::dfg::Edge> &edges = ssDFG->edges;
-  plain::Array instructions;
+
+  // In the compact form, each instruction is a tuple of the values below in order.
+  auto instruction = [&w, compact](const char *op, std::initializer_list<std::pair<const char*, int>> args) {
+    if (compact) {
+      w.BeginArray().Value(op);
+      for (auto &arg : args) w.Value(arg.second);
+      w.EndArray();
+    } else {
+      w.BeginObject().Field("op", op);
+      for (auto &arg : args) w.Field(arg.first, arg.second);
+      w.EndObject();
+    }
+  };
+
+  w.BeginArray();
 
   for (int i = 0, n = nodes.size(); i < n; ++i) {
     auto loc = location_of(nodes[i]);
-    plain::Object mapping;
-    mapping["op"] = new json::String("assign_node");
-    mapping["dfgnode"] = new json::Int(nodes[i]->id());
-    mapping["adgnode"] = new json::Int(loc.second->id());
-    mapping["adgslot"] = new json::Int(loc.first);
-    instructions.push_back(new json::Object(mapping));
+    instruction("assign_node", {{"dfgnode", nodes[i]->id()},
+                                {"adgnode", loc.second->id()},
+                                {"adgslot", loc.first}});
   }
 
   for (int i = 0, n = edges.size(); i < n; ++i) {
     auto edge = &edges[i];
     auto &links = links_of(edge);
     for (auto link : links) {
-      plain::Object mapping;
-      mapping["op"] = new json::String("assign_link");
-      mapping["dfgedge"] = new json::Int(edges[i].id);
-      mapping["adglink"] = new json::Int(link.second->id());
-      mapping["adgslot"] = new json::Int(link.first);
-      instructions.push_back(new json::Object(mapping));
-      plain::Object latency;
-      latency["op"] = new json::String("assign_delay");
-      latency["dfgedge"] = new json::Int(edges[i].id);
-      latency["delay"] = new json::Int(edge_delay(&edges[i]));
-      instructions.push_back(new json::Object(latency));
+      instruction("assign_link", {{"dfgedge", edges[i].id},
+                                  {"adglink", link.second},
+                                  {"adgslot", link.first}});
+    }
+    // The delay belongs to the edge, so it is dumped once rather than once per link.
+    if (!links.empty()) {
+      instruction("assign_delay", {{"dfgedge", edges[i].id}, {"delay", edge_delay(edge)}});
     }
   }
 
-  json::Array array(instructions);
-  json::JSONPrinter printer(os);
-  array.Accept(&printer);
+  w.EndArray();
+  return w.Close();
 }
 
 // Write to a header file
-void Schedule::printConfigHeader(ostream& os, std::string cfg_name, bool use_cheat) {
+void Schedule::printConfigHeader(ostream& os, std::string cfg_name, bool use_cheat,
+                                 const std::string& sched_dir) {
   // Step 1: Write the vector port mapping
   // TODO(@Sihao): print out the real config bit stream
   os << "#ifndef "
@@ -151,7 +195,7 @@ void Schedule::printConfigHeader(ostream& os, std::string cfg_name, bool use_che
   os << "\n";
 
   if (use_cheat) {
-    printConfigCheat(os, cfg_name);
+    printConfigCheat(os, cfg_name, sched_dir);
   } else {
 
     // For each edge, find out the passthrough node
@@ -167,8 +211,8 @@ void Schedule::printConfigHeader(ostream& os, std::string cfg_name, bool use_che
       // loop for every link
       auto link_iter = ep.links.begin();
       while((++link_iter) != ep.links.end()){
-        sslink * in_link = (--link_iter) -> second;
-        sslink * out_link = (++link_iter) -> second;
+        sslink * in_link = hw_link((--link_iter) -> second);
+        sslink * out_link = hw_link((++link_iter) -> second);
         ssswitch * switch_node = dynamic_cast<ssswitch*>(in_link -> dest());
         ssfu * fu_node = dynamic_cast<ssfu*>(out_link -> dest());
         // config the switch
@@ -176,8 +220,8 @@ void Schedule::printConfigHeader(ostream& os, std::string cfg_name, bool use_che
         // TODO(@sihao): Support passthru.
         {
           os << "//   config " << switch_node -> name() << endl;
-          int in_idx = dsa::vector_utils::indexing(in_link, switch_node->in_links());
-          int out_idx = dsa::vector_utils::indexing(out_link, switch_node -> out_links());
+          int in_idx = dsa::vector_utils::indexing(in_link->id(), switch_node->in_links().ids());
+          int out_idx = dsa::vector_utils::indexing(out_link->id(), switch_node -> out_links().ids());
           switch_node->route_io(in_idx, out_idx);
           //os << "input size = " << switch_node -> in_links().size()
           //   << ", output size = " << switch_node -> out_links().size()<< endl;
@@ -194,7 +238,7 @@ void Schedule::printConfigHeader(ostream& os, std::string cfg_name, bool use_che
           //int vertex_idx = vertex_pair.second;
           int edge_of_vertex_idx = vector_utils::indexing(edge, operands[vertex->id()]);
           // which input port does this edge used
-          int input_port_idx = dsa::vector_utils::indexing(out_link, fu_node -> in_links());
+          int input_port_idx = dsa::vector_utils::indexing(out_link->id(), fu_node -> in_links().ids());
           CHECK(input_port_idx >= 0) << "not found input port";
           CHECK(edge_of_vertex_idx >= 0) << "This edge's destination is fu but not used?";
           {
@@ -219,6 +263,7 @@ void Schedule::printConfigHeader(ostream& os, std::string cfg_name, bool use_che
 
     // print out the config bits for every ssnode
     for(auto & node : ssModel() ->subModel()->node_list()){
+      if (!node) continue;
 
       uint64_t config_bits = node->get_config_bits();
       std::bitset<64> b_config_bit(config_bits);
@@ -261,11 +306,13 @@ void Schedule::printConfigHeader(ostream& os, std::string cfg_name, bool use_che
 
 }
 
-void Schedule::printConfigCheat(ostream& os, std::string cfg_name) {
-  std::string dfg_fname = "sched/" + cfg_name + ".dfg.json";
+void Schedule::printConfigCheat(ostream& os, std::string cfg_name,
+                                const std::string& sched_dir) {
+  std::string dfg_fname = sched_dir + cfg_name + ".dfg.json";
   // TODO(@were): Dump the DFG with noop injected.
   dsa::dfg::Export(ssdfg(), dfg_fname);
-  std::string sched_fname = "sched/" + cfg_name + ".sched.json";
+  dsa::dfg::ExportBinary(ssdfg(), sched_dir + cfg_name + ".dfg.bin");
+  std::string sched_fname = sched_dir + cfg_name + ".sched.json";
   DumpMappingInJson(sched_fname);
 
   os << "// CAUTION: This is a serialization-based version\n"
@@ -416,6 +463,7 @@ void Schedule::printSwitchGraphviz(std::ofstream& ofs, ssswitch* sw) {
 }
 
 void Schedule::printGraphviz(const char* name) {
+  PROFILE_SCOPE(DumpGraphviz);
   ofstream ofs(name);
   if (!ofs.good()) {
     std::cerr << name << " not opened!" << std::endl;
@@ -433,7 +481,9 @@ void Schedule::printGraphviz(const char* name) {
 
   for (auto* elem : sub->fu_list()) printNodeGraphviz(ofs, elem);
 
-  for (ssnode* node : sub->node_list()) printMelGraphviz(ofs, node);
+  for (ssnode* node : sub->node_list()) {
+    if (node) printMelGraphviz(ofs, node);
+  }
 
   ofs << "}\n\n";
 }
@@ -457,6 +507,7 @@ void Schedule::stat_printOutputLatency() {
 #include "./pass/iterative_latency.h"
 
 bool Schedule::fixLatency(int& max_lat, int& max_lat_mis) {
+  PROFILE_SCOPE(FixLatency);
   for (auto& i : _edgeProp) {
     i.extra_lat = 0;
   }
@@ -722,7 +773,7 @@ void Schedule::calcNodeLatency(SSDfgNode* node, int& max_lat, int& max_lat_mis)
   if (max_lat < new_lat) max_lat = new_lat;
 }
 
-void Schedule::validate() {
+bool Schedule::consistent() {
   // Invariant: All paths should start at the source, and end at the
   // destination
   for (dsa::dfg::Edge &edge : _ssDFG->edges) {
@@ -735,22 +786,28 @@ void Schedule::validate() {
     int i = 0;
     sslink* prev_link = nullptr;
     for (auto& linkp : links) {
-      sslink* link = linkp.second;
-      if (i == 0) {
-        CHECK(link->orig() == def_node);
+      sslink* link = hw_link(linkp.second);
+      if (i == 0 && link->orig() != def_node) {
+        return false;
       }
-      if (i > 0) {
-        CHECK(prev_link->dest() == link->orig());
+      if (i > 0 && prev_link->dest() != link->orig()) {
+        return false;
       }
-      if (i + 1 < (int) links.size()) {
-        CHECK(dynamic_cast<ssvport*>(link->dest()) == 0);
+      if (i + 1 < (int) links.size() && dynamic_cast<ssvport*>(link->dest())) {
+        return false;
       }
       ++i;
       prev_link = link;
     }
-    CHECK(prev_link);
-    CHECK(prev_link->dest() == use_node);
+    if (prev_link->dest() != use_node) {
+      return false;
+    }
   }
+  return true;
+}
+
+void Schedule::validate() {
+  CHECK(consistent()) << "A route does not connect its definition to its use";
 }
 
 // Calculate the exact latency by traversing the schedule
@@ -916,13 +973,14 @@ void Schedule::calcLatency(int& max_lat, int& max_lat_mis, bool warnMismatch) {
 }
 
 void Schedule::get_overprov(int& ovr, int& agg_ovr, int& max_util) {
+  PROFILE_SCOPE(Overprov);
   ovr = 0;
   agg_ovr = 0;
   max_util = 0;
 
   for (auto v : _vertexProp) {
-    if (v.node) {
-      const auto& np = _nodeProp[v.node->id()];
+    if (v.node_id != -1) {
+      const auto& np = _nodeProp[v.node_id];
 
       // Calculate aggregate overage
       for (int i = 0; i < 8; ++i) {
@@ -942,7 +1000,7 @@ void Schedule::get_overprov(int& ovr, int& agg_ovr, int& max_util) {
         int unique_io = vector_utils::count_unique(io);
 
         int cur_util = cnt + slot.passthrus.size() + unique_io;
-        int cur_ovr = cur_util - v.node->max_util();
+        int cur_ovr = cur_util - hw_node(v.node_id)->max_util();
         agg_ovr += std::max(cur_ovr, 0);
         ovr = max(ovr, cur_ovr);
         max_util = std::max(cur_util, max_util);
@@ -951,6 +1009,7 @@ void Schedule::get_overprov(int& ovr, int& agg_ovr, int& max_util) {
   }
 
   for (auto& n : _ssModel->subModel()->node_list()) {
+    if (!n) continue;
     for (auto& elem : n->out_links()) {
       get_link_overprov(elem, ovr, agg_ovr, max_util);
     }
@@ -1063,11 +1122,19 @@ void Schedule::normalize() {
   reversed_topo = dsa::dfg::pass::ReversedTopology(dfg);
   needs_dynamic = dsa::dfg::pass::PropagateControl(reversed_topo);
   auto redundancy = dsa::dfg::pass::CollectRedundancy(dfg);
-  distances = dsa::arch::pass::ShortestPaths(model->subModel());
+  if (model->distances) {
+    distances = model->distances;
+  } else {
+    distances = std::make_shared<const std::vector<std::vector<int>>>(
+        dsa::arch::pass::ShortestPaths(model->subModel()));
+  }
   operands = std::get<0>(redundancy);
   users = std::get<1>(redundancy);
   group_throughput = dsa::dfg::pass::GroupThroughput(dfg, reversed_topo);
-  dsa::mapper::CandidateSpotVisitor cpv(this, 50);
+  // The counts are an estimation for the order of mapping. They are drawn from a stream
+  // of their own, so that building a schedule does not perturb the search.
+  dsa::Rng rng;
+  dsa::mapper::CandidateSpotVisitor cpv(this, 50, rng);
   dfg->Apply(&cpv);
   candidate_cnt = cpv.cnt;
 }
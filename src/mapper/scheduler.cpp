@@ -1,8 +1,11 @@
 #include <signal.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
+#include <cerrno>
+
 #include <fstream>
 #include <list>
 #include <sstream>
@@ -10,6 +13,7 @@
 
 #include "dsa/mapper/scheduler.h"
 #include "dsa/mapper/scheduler_sa.h"
+#include "dsa/mapper/warm_start.h"
 #include "dsa/arch/visitor.h"
 #include "dsa/dfg/visitor.h"
 
@@ -105,13 +109,25 @@ std::string basedir(const std::string& filename) {
   return filename.substr(0, lastindex);
 }
 
-Schedule* Scheduler::invoke(SSModel* model, SSDfg* dfg, bool print_bits) {
+void make_directories(const std::string& s) {
+  for (size_t i = 1; i <= s.size(); ++i) {
+    if (i != s.size() && s[i] != '/') continue;
+    std::string prefix = s.substr(0, i);
+    if (mkdir(prefix.c_str(), 0755) != 0) {
+      CHECK(errno == EEXIST) << "Cannot create " << prefix << ": " << strerror(errno);
+    }
+  }
+}
+
+Schedule* Scheduler::invoke(SSModel* model, SSDfg* dfg, bool print_bits,
+                            const std::string& out_dir) {
   bool succeed_sched = false;
   Schedule* sched = nullptr;
 
   string dfg_base =
       basename(dfg->filename);  // the name without preceeding dirs or file extension
-  string pdg_dir = basedir(dfg->filename);  // preceeding directories only
+  // preceeding directories only, unless the outputs are redirected
+  string pdg_dir = out_dir.empty() ? basedir(dfg->filename) : out_dir;
   if (pdg_dir[pdg_dir.length() - 1] != '\\' || pdg_dir[pdg_dir.length() - 1] != '/') {
     pdg_dir += "/";
   }
@@ -119,11 +135,18 @@ Schedule* Scheduler::invoke(SSModel* model, SSDfg* dfg, bool print_bits) {
   string iter_dir = pdg_dir + "viz/iter/";
   string verif_dir = pdg_dir + "verif/";
   string sched_dir = pdg_dir + "sched/";  // Directory for cheating on the scheduler
+  string cheat_dir = out_dir.empty() ? "sched/" : sched_dir;  // Where the cheat is dumped
+  _viz_dir = viz_dir;
 
-  ENFORCED_SYSTEM(("mkdir -p " + viz_dir).c_str());
-  ENFORCED_SYSTEM(("mkdir -p " + iter_dir).c_str());
-  ENFORCED_SYSTEM(("mkdir -p " + verif_dir).c_str());
-  ENFORCED_SYSTEM(("mkdir -p " + sched_dir).c_str());
+  if (artifacts != ArtifactPolicy::None) {
+    make_directories(viz_dir);
+    make_directories(verif_dir);
+  }
+  if (artifacts == ArtifactPolicy::All) {
+    make_directories(iter_dir);
+  }
+  make_directories(sched_dir);
+  make_directories(cheat_dir);
 
   std::string model_filename = model->filename;
   int lastindex = model_filename.find_last_of(".");
@@ -142,8 +165,44 @@ Schedule* Scheduler::invoke(SSModel* model, SSDfg* dfg, bool print_bits) {
     sigIntHandler.sa_flags = 0;
     sigaction(SIGINT, &sigIntHandler, NULL);
 
-    
-    succeed_sched = schedule_timed(dfg, sched);
+    std::string cache_key;
+    if (cache) {
+      cache_key = cache->Key(dfg->filename, model->filename);
+      sched = new Schedule(model, dfg);
+      succeed_sched = cache->Load(cache_key, sched);
+      if (succeed_sched) {
+        std::cout << "Mapping cache hit: " << cache_key << std::endl;
+      } else {
+        delete sched;
+        sched = nullptr;
+      }
+    }
+
+    bool cached = succeed_sched;
+
+    // The mapping to start from is absent in the first build.
+    if (!succeed_sched && !warm_start.empty() && std::ifstream(warm_start).good()) {
+      sched = new Schedule(model, dfg);
+      auto stats = dsa::mapper::WarmStart(sched, warm_start);
+      std::cout << "Warm start: " << stats.nodes_matched << "/" << dfg->nodes.size()
+                << " nodes matched, " << stats.nodes_placed << " placed, "
+                << stats.edges_routed << "/" << dfg->edges.size() << " edges routed"
+                << std::endl;
+      // The seeded schedule may need no repair at all.
+      if (sched->is_complete<SSDfgNode*>()) {
+        int lat = 0, latmis = 0, ovr = 0, agg_ovr = 0, max_util = 0;
+        sched->get_overprov(ovr, agg_ovr, max_util);
+        sched->fixLatency(lat, latmis);
+        succeed_sched = latmis == 0 && ovr == 0;
+      }
+    }
+
+    if (!succeed_sched) {
+      succeed_sched = schedule_timed(dfg, sched);
+    }
+    if (succeed_sched && cache && !cached) {
+      cache->Store(cache_key, sched);
+    }
 
     int lat = 0, latmis = 0;
     if (succeed_sched) {
@@ -174,22 +233,27 @@ Schedule* Scheduler::invoke(SSModel* model, SSDfg* dfg, bool print_bits) {
         cout << "Scheduling Failed!\n";
       }
       sched->stat_printOutputLatency();
-      dsa::mapper::pass::print_graphviz("viz/final.dot", dfg, sched);
+      if (artifacts != ArtifactPolicy::None) {
+        dsa::mapper::pass::print_graphviz(viz_dir + "final.dot", dfg, sched);
+      }
     }
 
-    dsa::mapper::pass::print_graphviz(viz_dir + dfg_base + ".dot", dfg);
+    if (artifacts != ArtifactPolicy::None) {
+      dsa::mapper::pass::print_graphviz(viz_dir + dfg_base + ".dot", dfg);
 
-    std::string sched_viz = viz_dir + dfg_base + "." + model_base + ".gv";
-    sched->printGraphviz(sched_viz.c_str());
+      std::string sched_viz = viz_dir + dfg_base + "." + model_base + ".gv";
+      sched->printGraphviz(sched_viz.c_str());
 
-    std::string verif_header = verif_dir + dfg_base + ".configbits";
-    std::ofstream vsh(verif_header);
-    CHECK(vsh.good());
-    sched->printConfigVerif(vsh);
+      std::string verif_header = verif_dir + dfg_base + ".configbits";
+      std::ofstream vsh(verif_header);
+      CHECK(vsh.good());
+      sched->printConfigVerif(vsh);
+    }
   }
 
   lastindex = dfg->filename.find_last_of(".");
-  string pdg_rawname = dfg->filename.substr(0, lastindex);
+  string pdg_rawname =
+      out_dir.empty() ? dfg->filename.substr(0, lastindex) : pdg_dir + dfg_base;
 
   if (!succeed_sched || sched == nullptr) {
     cout << "Cannot be scheduled, try a smaller DFG!\n\n";
@@ -203,7 +267,7 @@ Schedule* Scheduler::invoke(SSModel* model, SSDfg* dfg, bool print_bits) {
   std::string config_header = pdg_rawname + ".dfg.h";
   std::ofstream osh(config_header);
   CHECK(osh.good());
-  sched->printConfigHeader(osh, dfg_base);
+  sched->printConfigHeader(osh, dfg_base, true, cheat_dir);
   if (verbose) {
     std::cout << "Performance: " << sched->estimated_performance() << std::endl;
   }
@@ -212,7 +276,7 @@ Schedule* Scheduler::invoke(SSModel* model, SSDfg* dfg, bool print_bits) {
     std::string config_header_bits = pdg_rawname + ".dfg.bits.h";
     std::ofstream oshb(config_header_bits);
     CHECK(oshb.good());
-    sched->printConfigHeader(oshb, dfg_base, true);
+    sched->printConfigHeader(oshb, dfg_base, true, cheat_dir);
   }
 
   return sched;  // just to calm HEAPCHECK
@@ -4,14 +4,17 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <fstream>
 #include <list>
+#include <memory>
 #include <unordered_map>
 
 #include "dsa/debug.h"
 #include "dsa/dfg/visitor.h"
 #include "dsa/mapper/scheduler.h"
 #include "dsa/mapper/scheduler_sa.h"
+#include "dsa/profile.h"
 
 using namespace dsa;
 using namespace std;
@@ -51,6 +54,7 @@ void SchedulerSimulatedAnnealing::initialize(SSDfg* ssDFG, Schedule*& sched) {
 }
 
 std::pair<int, int> SchedulerSimulatedAnnealing::obj(Schedule*& sched, SchedStats& s) {
+  PROFILE_SCOPE(Objective);
   int num_left = sched->num_left();
   bool succeed_sched = (num_left == 0);
 
@@ -76,10 +80,10 @@ bool SchedulerSimulatedAnnealing::length_creep(Schedule* sched, dsa::dfg::Edge*
 
     if (links.empty()) continue;
 
-    int rand_link_no = rand() % links.size();
+    int rand_link_no = rng.Below(links.size());
     auto it = links.begin();
     for (int i = 0; i < rand_link_no; ++i) ++it;
-    std::pair<int, sslink*> rand_link = *it;
+    std::pair<int, sslink*> rand_link(it->first, sched->hw_link(it->second));
 
     auto& edge_list = sched->edge_list(rand_link.first, rand_link.second);
 
@@ -111,7 +115,7 @@ bool SchedulerSimulatedAnnealing::length_creep(Schedule* sched, dsa::dfg::Edge*
           auto from_it = links.begin();
           for (int i = 0; i < rand_link_no + 1; ++i) ++from_it;
           for (int i = 0; i < inserted; ++i) {
-            std::pair<int, sslink*> from_link = *from_it;
+            std::pair<int, sslink*> from_link(from_it->first, sched->hw_link(from_it->second));
             auto &alt_links = sched->links_of(alt_edge);
             auto alt_it = alt_links.begin() + rand_link_no + 1 + i;
             sched->assign_edgelink(alt_edge, from_link.first, from_link.second, alt_it);
@@ -162,7 +166,7 @@ std::pair<int, int> SchedulerSimulatedAnnealing::obj_creep(Schedule*& sched,
       if (v->is_temporal()) continue;
       // int node_vio = sched->vioOf(v);
 
-      int r = rand() % 4;
+      int r = rng.Below(4);
       if (r != 0) continue;
 
       for (auto &op : v->ops()) {
@@ -171,7 +175,7 @@ std::pair<int, int> SchedulerSimulatedAnnealing::obj_creep(Schedule*& sched,
           int vio = sched->vioOf(e);
           if (vio > 0) {
             LOG(CREEP) << e->name() << ": " << vio;
-            vio = rand() % vio;
+            vio = rng.Below(vio);
             bool changed = false;
             changed |= length_creep(sched, e, vio, undo_routing);
             if (changed) obj(sched, s);
@@ -255,7 +259,10 @@ bool SchedulerSimulatedAnnealing::schedule(SSDfg* ssDFG, Schedule*& sched) {
   int max_iters_no_improvement = _ssModel->subModel()->node_list().size() * 50;
 
   Schedule* cur_sched = new Schedule(getSSModel(), ssDFG);
-  *cur_sched = *sched;
+  {
+    PROFILE_SCOPE(ScheduleCopy);
+    *cur_sched = *sched;
+  }
 
   std::pair<int, int> best_score = make_pair(0, 0);
   bool best_succeeded = false;
@@ -268,6 +275,26 @@ bool SchedulerSimulatedAnnealing::schedule(SSDfg* ssDFG, Schedule*& sched) {
 
   int presize = ssDFG->type_filter<SSDfgInst>().size();
 
+  // The snapshots refer to the DFG and the model, so they should be written before either
+  // changes after returning.
+  struct DrainOnExit {
+    ArtifactWriter& writer;
+    ~DrainOnExit() { writer.Drain(); }
+  } drain_on_exit{_artifact_writer};
+  auto dump_snapshot = [this](Schedule* s, const std::string& filename) {
+    PROFILE_SCOPE(ScheduleCopy);
+    auto snapshot = std::make_shared<Schedule>(*s);
+    _artifact_writer.Submit(filename, [snapshot, filename]() {
+      snapshot->printGraphviz(filename.c_str());
+    });
+  };
+
+  if (telemetry) {
+    telemetry->Emit(dsa::telemetry::Record("sa-begin")
+                    .Field("dfg", ssDFG->filename)
+                    .Field("model", _ssModel->filename));
+  }
+
   int iter = 0;
   int fail_to_route = 0;
   for (iter = 0; iter < max_iters; ++iter) {
@@ -278,7 +305,9 @@ bool SchedulerSimulatedAnnealing::schedule(SSDfg* ssDFG, Schedule*& sched) {
     bool print_stat = (iter & (256 - 1)) == 0;
 
     // if we don't improve for some time, lets reset
-    if (iter - last_improvement_iter > 1024) {
+    bool reset = iter - last_improvement_iter > 1024;
+    if (reset) {
+      PROFILE_SCOPE(ScheduleCopy);
       *cur_sched = *sched;
     }
 
@@ -292,6 +321,15 @@ bool SchedulerSimulatedAnnealing::schedule(SSDfg* ssDFG, Schedule*& sched) {
         return false;
       }
       LOG(ROUTING) << "Problem with Topology -- Mapping Impossible";
+      if (telemetry) {
+        telemetry->Emit(dsa::telemetry::Record("sa")
+                        .Field("iter", iter)
+                        .Field("time", total_msec() / 1000.0)
+                        .Field("routes", routing_times)
+                        .Field("reset", reset)
+                        .Field("accept", false)
+                        .Field("improve", false));
+      }
       continue;
     }
 
@@ -303,11 +341,12 @@ bool SchedulerSimulatedAnnealing::schedule(SSDfg* ssDFG, Schedule*& sched) {
     std::pair<int, int> score = obj(cur_sched, s);
 
     int succeed_timing = (s.latmis == 0) && (s.ovr == 0);
+    TRACE(MAPPING, "iter left obj", iter, cur_sched->num_left(), -score.second);
 
     if (verbose && ((score > best_score) || print_stat)) {
-      stringstream ss;
-      ss << "viz/iter/" << iter << ".gv";
-      cur_sched->printGraphviz(ss.str().c_str());
+      if (artifacts == ArtifactPolicy::All) {
+        dump_snapshot(cur_sched, _viz_dir + "iter/" + std::to_string(iter) + ".gv");
+      }
 
       for (auto &elem : ssDFG->type_filter<SSDfgVecInput>()) {
         std::cout << cur_sched->vecPortOf(&elem) << " ";
@@ -340,11 +379,32 @@ bool SchedulerSimulatedAnnealing::schedule(SSDfg* ssDFG, Schedule*& sched) {
       }
     }
 
-    if (score > best_score) {
-      sched->printGraphviz("viz/cur-best.gv");
+    if (telemetry) {
+      telemetry->Emit(dsa::telemetry::Record("sa")
+                      .Field("iter", iter)
+                      .Field("time", total_msec() / 1000.0)
+                      .Field("num_left", (int) cur_sched->num_left())
+                      .Field("lat", s.lat)
+                      .Field("latmis", s.latmis)
+                      .Field("ovr", s.ovr)
+                      .Field("agg_ovr", s.agg_ovr)
+                      .Field("max_util", s.max_util)
+                      .Field("obj", -score.second)
+                      .Field("routes", routing_times)
+                      .Field("reset", reset)
+                      .Field("accept", true)
+                      .Field("improve", score > best_score));
+    }
 
+    if (score > best_score) {
       best_score = score;
-      *sched = *cur_sched;  // shallow copy of sched should work?
+      {
+        PROFILE_SCOPE(ScheduleCopy);
+        *sched = *cur_sched;  // shallow copy of sched should work?
+      }
+      if (artifacts == ArtifactPolicy::All) {
+        dump_snapshot(sched, _viz_dir + "cur-best.gv");
+      }
 
       best_mapped = succeed_sched;
       best_succeeded = succeed_timing;
@@ -355,7 +415,7 @@ bool SchedulerSimulatedAnnealing::schedule(SSDfg* ssDFG, Schedule*& sched) {
         std::string mapping_base = mapping_file.substr(0, mapping_file.find_last_of("."));
         mapping_file_str << mapping_base << "-iter-" << iter <<".json";
         std::string mapping_file_iter = mapping_file_str.str();
-        sched -> DumpMappingInJson(mapping_file_iter);
+        sched -> DumpMappingInJson(mapping_file_iter, compact_json);
       }
     }
 
@@ -400,7 +460,7 @@ struct CandidateFinder : dfg::Visitor {
 int SchedulerSimulatedAnnealing::map_to_completion(SSDfg* ssDFG, Schedule* sched) {
   auto nodes = sched->ssdfg()->nodes;
   int n = nodes.size();
-  dsa::mapper::CandidateSpotVisitor cpv(sched, 50);
+  dsa::mapper::CandidateSpotVisitor cpv(sched, 50, rng);
 
   std::sort(nodes.begin(), nodes.end(), [sched](SSDfgNode* a, SSDfgNode* b) {
     return sched->candidate_cnt[a->id()] < sched->candidate_cnt[b->id()];
@@ -409,11 +469,11 @@ int SchedulerSimulatedAnnealing::map_to_completion(SSDfg* ssDFG, Schedule* sched
   int from = 0;
   for (int i = 1; i < n; ++i) {
     if (sched->candidate_cnt[nodes[i - 1]->id()] != sched->candidate_cnt[nodes[i]->id()]) {
-      std::random_shuffle(nodes.begin() + from, nodes.begin() + i);
+      std::shuffle(nodes.begin() + from, nodes.begin() + i, rng);
       from = i;
     }
   }
-  std::random_shuffle(nodes.begin() + from, nodes.begin() + n);
+  std::shuffle(nodes.begin() + from, nodes.begin() + n, rng);
 
   for (int i = 0; i < n; ++i) {
     LOG(CAND) << nodes[i]->name() << ": " << sched->candidate_cnt[nodes[i]->id()];
@@ -429,12 +489,13 @@ int SchedulerSimulatedAnnealing::map_to_completion(SSDfg* ssDFG, Schedule* sched
         if (candidates.empty()) {
           std::cerr << ssDFG->filename << ": ";
           std::cerr << "Cannot map " << node->name() << std::endl;
+          TRACE(CAND, "no candidate for node", node->id());
           break;
         }
         int best_candidate = try_candidates(candidates, sched, node);
         if (best_candidate == -1) {
           unmap_some(ssDFG, sched);
-          std::random_shuffle(nodes.begin(), nodes.end());
+          std::shuffle(nodes.begin(), nodes.end(), rng);
           break;
         }
       }
@@ -445,25 +506,28 @@ int SchedulerSimulatedAnnealing::map_to_completion(SSDfg* ssDFG, Schedule* sched
 }
 
 void SchedulerSimulatedAnnealing::unmap_some(SSDfg* ssDFG, Schedule* sched) {
-  int r = rand() % 1000;  // upper limit defines ratio of input/output scheduling
+  PROFILE_SCOPE(UnmapSome);
+  int r = rng.Below(1000);  // upper limit defines ratio of input/output scheduling
   int num_to_unmap = (r < 5) ? 10 : (r < 250 ? 4 : 2);
+  TRACE(MAP, "unmap mapped", num_to_unmap, sched->num_mapped<SSDfgNode*>());
 
   struct Unmapper : dfg::Visitor {
     Schedule *sched;
+    dsa::Rng &rng;
     int total, to_do;
 
-    Unmapper(Schedule *sched_, int to_do_) :
-      sched(sched_), total(sched->num_mapped<SSDfgNode*>()), to_do(to_do_) {}
+    Unmapper(Schedule *sched_, dsa::Rng &rng_, int to_do_) :
+      sched(sched_), rng(rng_), total(sched->num_mapped<SSDfgNode*>()), to_do(to_do_) {}
 
     void Visit(SSDfgNode *node) override {
-      if (sched->is_scheduled(node) && rand() % total < to_do) {
+      if (sched->is_scheduled(node) && rng.Below(total) < to_do) {
         sched->unassign_dfgnode(node);
         --total;
       }
     }
   };
 
-  Unmapper u(sched, num_to_unmap);
+  Unmapper u(sched, rng, num_to_unmap);
 
   if (sched->num_mapped<SSDfgNode*>())
     ssDFG->Apply(&u);
@@ -479,6 +543,7 @@ int SchedulerSimulatedAnnealing::routing_cost(dsa::dfg::Edge* edge, int from_slo
                                               int next_slot, sslink* link,
                                               Schedule* sched,
                                               const pair<int, ssnode*>& dest) {
+  PROFILE_SCOPE(RoutingCost);
   SSDfgNode* def_dfgnode = edge->def();
   SSDfgNode* use_dfgnode = edge->use();
 
@@ -540,7 +605,7 @@ int SchedulerSimulatedAnnealing::routing_cost(dsa::dfg::Edge* edge, int from_slo
 }
 
 void insert_edge(std::pair<int, sslink*> link, Schedule* sched, dsa::dfg::Edge* edge,
-                 std::vector<std::pair<int, sslink*>>::iterator it,
+                 std::vector<std::pair<int, int>>::iterator it,
                  std::pair<int, ssnode*> dest, std::pair<int, ssnode*> x) {
   sched->assign_edgelink(edge, link.first, link.second, it);
 
@@ -554,7 +619,8 @@ void insert_edge(std::pair<int, sslink*> link, Schedule* sched, dsa::dfg::Edge*
 int SchedulerSimulatedAnnealing::route(
     Schedule* sched, dsa::dfg::Edge* edge, std::pair<int, dsa::ssnode*> source,
     std::pair<int, dsa::ssnode*> dest,
-    std::vector<std::pair<int, sslink*>>::iterator* ins_it, int max_path_lengthen) {
+    std::vector<std::pair<int, int>>::iterator* ins_it, int max_path_lengthen) {
+  PROFILE_SCOPE(Route);
   // if (!sched->ssModel()->subModel()->connected[source.second->id()][dest.second->id()]) {
   //  return 0;
   //}
@@ -576,21 +642,24 @@ int SchedulerSimulatedAnnealing::route(
   CHECK(path_lengthen || sched->link_count(edge) == 0)
     << "Edge: " << edge->name() << " is already routed!";
 
-  // Distance, random priority, slot, node
-  set<std::tuple<int, int, int, ssnode*>> openset;
+  // Distance, random priority, slot, node id
+  // Ties are broken by node id rather than by address, so that routing on a cloned
+  // fabric behaves exactly the same as routing on the original one.
+  set<std::tuple<int, int, int, int>> openset;
+  auto& node_list = sched->ssModel()->subModel()->node_list();
 
   if (!path_lengthen) source.first = edge->def()->slot_for_use(edge, source.first);
   dest.first = edge->use()->slot_for_op(edge, dest.first);
 
   int new_rand_prio = 0;                                 // just pick zero
   source.second->set_done(source.first, new_rand_prio);  // remeber for deleting
-  openset.emplace(0, new_rand_prio, source.first, source.second);
+  openset.emplace(0, new_rand_prio, source.first, source.second->id());
   source.second->update_dist(source.first, 0, 0, nullptr);
 
   while (!openset.empty()) {
     int cur_dist = std::get<0>(*openset.begin());
     int slot = std::get<2>(*openset.begin());
-    ssnode* node = std::get<3>(*openset.begin());
+    ssnode* node = node_list[std::get<3>(*openset.begin())];
 
     openset.erase(openset.begin());
 
@@ -638,12 +707,12 @@ int SchedulerSimulatedAnnealing::route(
           if (next_dist != -1) {
             int next_rand_prio = next->done(next_slot);
             auto iter =
-                openset.find(std::make_tuple(next_dist, next_rand_prio, next_slot, next));
+                openset.find(std::make_tuple(next_dist, next_rand_prio, next_slot, next->id()));
             if (iter != openset.end()) openset.erase(iter);
           }
-          int new_rand_prio = rand() % 16;
+          int new_rand_prio = rng.Below(16);
           next->set_done(next_slot, new_rand_prio);  // remeber for later for deleting
-          openset.emplace(new_dist, new_rand_prio, next_slot, next);
+          openset.emplace(new_dist, new_rand_prio, next_slot, next->id());
           next->update_dist(next_slot, new_dist, slot, next_link);
         }
       }
@@ -685,7 +754,8 @@ int SchedulerSimulatedAnnealing::route(
   // code can't gaurantee that.
   if (alt_edge) {
     auto& alt_links = sched->links_of(alt_edge);
-    for (auto alt_link : alt_links) {
+    for (auto elem : alt_links) {
+      std::pair<int, sslink*> alt_link(elem.first, sched->hw_link(elem.second));
       x = std::make_pair(alt_link.first, alt_link.second->orig());
       insert_edge(alt_link, sched, edge, sched->links_of(edge).begin() + idx, dest, x);
       idx++;
@@ -699,6 +769,7 @@ int SchedulerSimulatedAnnealing::route(
 
 bool SchedulerSimulatedAnnealing::scheduleHere(Schedule* sched, SSDfgNode* node,
                                                pair<int, dsa::ssnode*> here) {
+  PROFILE_SCOPE(ScheduleHere);
   std::vector<dsa::dfg::Edge*> to_revert;
 
 #define process(edge_, node_, src, dest)                              \
@@ -714,6 +785,8 @@ bool SchedulerSimulatedAnnealing::scheduleHere(Schedule* sched, SSDfgNode* node,
         auto loc = sched->location_of(node);                          \
         if (!route(sched, edge, src, dest, nullptr, 0)) {             \
           LOG(ROUTE) << "Cannot route " << edge->name() << "\n";      \
+          TRACE(ROUTE, "unrouted edge at", edge->id, loc.second->id(), \
+                here.second->id());                                   \
           for (auto revert : to_revert) sched->unassign_edge(revert); \
           for (int j = 0; j < i; ++j) sched->unassign_edge(edges[j]); \
           return false;                                               \
@@ -747,7 +820,7 @@ int SchedulerSimulatedAnnealing::try_candidates(
 
   pair<int, int> bestScore = std::make_pair(INT_MIN, INT_MIN);
   int best_candidate = -1;
-  bool find_best = rand() % 128;
+  bool find_best = rng.Below(128);
 
   if (candidates.empty()) return 0;
 
@@ -766,13 +839,14 @@ int SchedulerSimulatedAnnealing::try_candidates(
   for (size_t i = 0; i < candidates.size(); ++i) {
     idx.push_back(i);
   }
+  auto& distances = *sched->distances;
   for (size_t i = 0; i < candidates.size(); ++i) {
     int sum = 0;
     for (auto elem : src) {
-      sum += sched->distances[elem][candidates[i].second->id()];
+      sum += distances[elem][candidates[i].second->id()];
     }
     for (auto elem : dst) {
-      sum += sched->distances[candidates[i].second->id()][elem];
+      sum += distances[candidates[i].second->id()][elem];
     }
     keys.push_back(sum);
   }
@@ -817,6 +891,7 @@ int SchedulerSimulatedAnnealing::try_candidates(
     }
   }
 
+  TRACE(MAP, "node candidate of", node->id(), best_candidate, candidates.size());
   if (best_candidate != -1) {
     best_path.apply(sched);
     sched->assign_node(node, candidates[best_candidate]);
@@ -834,10 +909,10 @@ void CandidateRoute::apply(Schedule *sched) {
     sched->unassign_edge(edge_prop.first);  // for partial routes
     LOG(PASSTHRU) << edge_prop.first->name();
     for (auto elem : edge_prop.second.thrus) {
-      sched->assign_edge_pt(edge_prop.first, elem);
+      sched->assign_edge_pt(edge_prop.first, {elem.first, sched->hw_node(elem.second)});
     }
     for (auto elem : edge_prop.second.links) {
-      sched->assign_edgelink(edge_prop.first, elem.first, elem.second);
+      sched->assign_edgelink(edge_prop.first, elem.first, sched->hw_link(elem.second));
     }
   }
 }
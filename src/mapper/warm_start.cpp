@@ -0,0 +1,225 @@
+#include "dsa/mapper/warm_start.h"
+
+#include <fstream>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "dsa/dfg/ssdfg.h"
+#include "dsa/dfg/utils.h"
+#include "../utils/string_utils.h"
+
+namespace dsa {
+namespace mapper {
+
+namespace {
+
+/*! \brief The operand, and the index in the operand, an edge is connected to. */
+std::pair<int, int> OperandOf(dsa::dfg::Edge* edge) {
+  auto& ops = edge->use()->ops();
+  for (int i = 0, n = ops.size(); i < n; ++i) {
+    for (int j = 0, m = ops[i].edges.size(); j < m; ++j) {
+      if (ops[i].edges[j] == edge->id) return {i, j};
+    }
+  }
+  CHECK(false) << edge->name() << " is not an operand of its user";
+  throw;
+}
+
+/*! \brief The edge connected to the same operand of a node as the given edge. */
+dsa::dfg::Edge* SameOperand(SSDfgNode* node, std::pair<int, int> operand) {
+  auto& ops = node->ops();
+  if (operand.first >= (int)ops.size()) return nullptr;
+  auto& edges = ops[operand.first].edges;
+  if (operand.second >= (int)edges.size()) return nullptr;
+  return &node->ssdfg()->edges[edges[operand.second]];
+}
+
+bool SameValue(dsa::dfg::Edge* a, dsa::dfg::Edge* b) {
+  return a->vid == b->vid && a->l == b->l && a->r == b->r;
+}
+
+/*! \brief Matches the nodes of the new DFG to the nodes of the old DFG. */
+struct Matcher {
+  SSDfg *dfg, *old;
+  /*! \brief The old node of each new node, and vice versa. */
+  std::vector<int> to_old, to_new;
+
+  Matcher(SSDfg* dfg_, SSDfg* old_)
+      : dfg(dfg_), old(old_), to_old(dfg_->nodes.size(), -1), to_new(old_->nodes.size(), -1) {}
+
+  void Match(int nid, int oid) {
+    to_old[nid] = oid;
+    to_new[oid] = nid;
+  }
+
+  void MatchPorts() {
+    std::map<std::pair<int, std::string>, int> ports;
+    for (auto node : old->nodes) {
+      if (node->type() != SSDfgNode::V_INST) {
+        ports[{node->type(), node->name()}] = node->id();
+      }
+    }
+    for (auto node : dfg->nodes) {
+      if (node->type() == SSDfgNode::V_INST) continue;
+      auto iter = ports.find({node->type(), node->name()});
+      if (iter != ports.end()) {
+        Match(node->id(), iter->second);
+      }
+    }
+  }
+
+  /*! \brief If an unmatched old node is the same kind of instruction. */
+  bool SameInst(SSDfgInst* inst, SSDfgNode* node) {
+    auto old_inst = dynamic_cast<SSDfgInst*>(node);
+    return old_inst && to_new[old_inst->id()] == -1 && old_inst->inst() == inst->inst() &&
+           old_inst->ops().size() == inst->ops().size() &&
+           old_inst->values.size() == inst->values.size();
+  }
+
+  /*! \brief Match an instruction whose operands all come from the matched producers. */
+  bool Forward(SSDfgInst* inst) {
+    for (auto node : old->nodes) {
+      if (!SameInst(inst, node)) continue;
+      bool same = true;
+      for (int i = 0, n = inst->ops().size(); i < n && same; ++i) {
+        auto &a = inst->ops()[i], &b = node->ops()[i];
+        if (a.is_imm() || b.is_imm()) {
+          same = a.is_imm() && b.is_imm() && a.imm == b.imm;
+          continue;
+        }
+        same = a.edges.size() == b.edges.size();
+        for (int j = 0, m = a.edges.size(); j < m && same; ++j) {
+          auto ea = &dfg->edges[a.edges[j]], eb = &old->edges[b.edges[j]];
+          same = to_old[ea->sid] == eb->sid && SameValue(ea, eb);
+        }
+      }
+      if (same) {
+        Match(inst->id(), node->id());
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /*! \brief Match an instruction which feeds an operand of a matched consumer. */
+  bool Backward(SSDfgInst* inst) {
+    for (auto& value : inst->values) {
+      for (int eid : value.uses) {
+        auto edge = &dfg->edges[eid];
+        if (to_old[edge->uid] == -1) continue;
+        auto old_edge = SameOperand(old->nodes[to_old[edge->uid]], OperandOf(edge));
+        if (old_edge && SameValue(edge, old_edge) && SameInst(inst, old_edge->def())) {
+          Match(inst->id(), old_edge->sid);
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  void Run() {
+    MatchPorts();
+    for (bool changed = true; changed;) {
+      changed = false;
+      for (auto& inst : dfg->instructions) {
+        if (to_old[inst.id()] == -1) {
+          changed |= Forward(&inst) || Backward(&inst);
+        }
+      }
+    }
+  }
+};
+
+/*! \brief If a node can be placed on the spot in the schedule. */
+bool Placeable(Schedule* sched, SSDfgNode* node, std::pair<int, ssnode*> loc) {
+  if (auto inst = dynamic_cast<SSDfgInst*>(node)) {
+    auto fu = dynamic_cast<ssfu*>(loc.second);
+    if (!fu || !fu->fu_type_.Capable(inst->inst()) ||
+        fu->out_links().size() < inst->values.size()) {
+      return false;
+    }
+    if (inst->is_temporal()) {
+      return fu->is_shared() && (int)sched->dfg_nodes_of(0, fu).size() < fu->max_util();
+    }
+    int num_slots = inst->bitwidth() / 8;
+    if (loc.first + num_slots > sched->num_slots(fu)) return false;
+    for (int i = loc.first; i < loc.first + num_slots; ++i) {
+      if (!sched->dfg_nodes_of(i, fu).empty()) return false;
+    }
+    return true;
+  }
+  auto vec = dynamic_cast<SSDfgVec*>(node);
+  auto vport = dynamic_cast<ssvport*>(loc.second);
+  if (!vec || !vport || (int)vport->bitwidth_capability() < vec->phys_bitwidth() ||
+      !sched->dfg_nodes_of(0, vport).empty()) {
+    return false;
+  }
+  // An input port has no incoming links.
+  return vport->in_links().empty() == (node->type() == SSDfgNode::V_INPUT);
+}
+
+}  // namespace
+
+WarmStartStats WarmStart(Schedule* sched, const std::string& mapping_filename) {
+  // The DFG dumped along with the mapping.
+  std::string base = mapping_filename.substr(0, mapping_filename.find_last_of("."));
+  if (string_utils::String(base).EndsWith(".sched")) {
+    base = base.substr(0, base.size() - 6);
+  }
+  std::string dfg_filename = base + ".dfg.bin";
+  if (!std::ifstream(dfg_filename).good()) {
+    dfg_filename = base + ".dfg.json";
+  }
+  CHECK(std::ifstream(dfg_filename).good())
+      << "Cannot find the DFG of " << mapping_filename << ", expect " << base
+      << ".dfg.bin or .dfg.json";
+
+  std::unique_ptr<SSDfg> old_dfg(dsa::dfg::Import(dfg_filename));
+  Schedule old_sched(sched->ssModel(), old_dfg.get());
+  old_sched.LoadMappingInJson(mapping_filename);
+
+  SSDfg* dfg = sched->ssdfg();
+  Matcher matcher(dfg, old_dfg.get());
+  matcher.Run();
+
+  WarmStartStats stats;
+  for (auto node : dfg->nodes) {
+    int oid = matcher.to_old[node->id()];
+    if (oid == -1) continue;
+    ++stats.nodes_matched;
+    auto old_node = old_dfg->nodes[oid];
+    if (!old_sched.is_scheduled(old_node)) continue;
+    auto loc = old_sched.location_of(old_node);
+    if (Placeable(sched, node, loc)) {
+      sched->assign_node(node, loc);
+      ++stats.nodes_placed;
+    }
+  }
+
+  for (auto& edge : dfg->edges) {
+    if (!sched->is_scheduled(edge.def()) || !sched->is_scheduled(edge.use())) continue;
+    auto old_use = old_dfg->nodes[matcher.to_old[edge.uid]];
+    auto old_edge = SameOperand(old_use, OperandOf(&edge));
+    if (!old_edge || old_edge->sid != matcher.to_old[edge.sid] || !SameValue(&edge, old_edge)) {
+      continue;
+    }
+    auto& links = old_sched.links_of(old_edge);
+    if (links.empty()) continue;
+    for (int i = 0, n = links.size(); i < n; ++i) {
+      sslink* link = old_sched.hw_link(links[i].second);
+      sched->assign_edgelink(&edge, links[i].first, link);
+      if (i + 1 < n && dynamic_cast<ssfu*>(link->dest())) {
+        sched->assign_edge_pt(&edge, {links[i].first, link->dest()});
+      }
+    }
+    sched->set_edge_delay(old_sched.edge_delay(old_edge), &edge);
+    ++stats.edges_routed;
+  }
+
+  return stats;
+}
+
+}  // namespace mapper
+}  // namespace dsa
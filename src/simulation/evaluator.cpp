@@ -0,0 +1,288 @@
+#include "dsa/simulation/evaluator.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "dsa/debug.h"
+#include "dsa/dfg/ssdfg.h"
+
+namespace dsa {
+namespace simulation {
+
+Evaluator::Evaluator(SSDfg* dfg, int group, int batch)
+    : dfg(dfg), _batch(batch), value_regs(dfg->nodes.size()), back_array(4, false) {
+  CHECK(group >= 0 && group < dfg->num_groups()) << "No sub-DFG " << group;
+  CHECK(!dfg->group_prop(group).is_temporal)
+      << "A temporal sub-DFG cannot be evaluated in a straight line";
+  CHECK(batch > 0);
+
+  // Count the unresolved producers of each node, to sort the sub-DFG topologically.
+  int n = dfg->nodes.size();
+  std::vector<int> pending(n, 0);
+  std::vector<int> ready;
+  for (auto* node : dfg->nodes) {
+    if (node->group_id() != group) continue;
+    for (auto& operand : node->ops()) {
+      for (auto eid : operand.edges) {
+        CHECK(dfg->edges[eid].def()->group_id() == group)
+            << dfg->edges[eid].name() << " crosses the sub-DFGs";
+      }
+      pending[node->id()] += operand.edges.size();
+    }
+    if (!pending[node->id()]) {
+      ready.push_back(node->id());
+    }
+  }
+
+  for (size_t i = 0; i < ready.size(); ++i) {
+    auto* node = dfg->nodes[ready[i]];
+    auto& values = value_regs[node->id()];
+    switch (node->type()) {
+      case SSDfgNode::V_INPUT: {
+        _inputs.push_back(static_cast<SSDfgVecInput*>(node));
+        for (size_t j = 0; j < node->values.size(); ++j) {
+          values.push_back(NewRegister());
+        }
+        input_regs.push_back(values);
+        break;
+      }
+      case SSDfgNode::V_INST: {
+        auto* inst = static_cast<SSDfgInst*>(node);
+        CHECK(!inst->predicate.needs_ctrl_dep() && !inst->self_predicate.needs_ctrl_dep())
+            << inst->name() << " backpressures its operands, which needs SSDfg::forward";
+        CHECK(inst->ops().size() <= 4 && inst->values.size() <= 4);
+        Step step;
+        step.inst = inst;
+        step.arity = inst->ops().size();
+        for (int j = 0; j < step.arity; ++j) {
+          auto& operand = inst->ops()[j];
+          step.ops[j] = Lower(operand);
+          step.ctrl[j] = !operand.is_imm() && operand.type != dsa::dfg::OperandType::data;
+        }
+        step.num_values = inst->values.size();
+        for (int j = 0; j < step.num_values; ++j) {
+          values.push_back(NewRegister());
+        }
+        step.dst = values.empty() ? -1 : values[0];
+        step.batched = inst->bitwidth() == 64 && step.num_values == 1 &&
+                       dsa::has_batch_kernel(inst->inst());
+        tape.push_back(step);
+        break;
+      }
+      case SSDfgNode::V_OUTPUT: {
+        _outputs.push_back(static_cast<SSDfgVecOutput*>(node));
+        std::vector<int> operands;
+        for (auto& operand : node->ops()) {
+          operands.push_back(Lower(operand));
+        }
+        output_regs.push_back(operands);
+        break;
+      }
+      default: CHECK(false) << "Unknown node type!";
+    }
+    for (auto& value : node->values) {
+      for (auto eid : value.uses) {
+        int uid = dfg->edges[eid].uid;
+        if (!--pending[uid]) {
+          ready.push_back(uid);
+        }
+      }
+    }
+  }
+
+  for (auto* node : dfg->nodes) {
+    CHECK(node->group_id() != group || !pending[node->id()])
+        << node->name() << " is in a cycle, which cannot be evaluated in a straight line";
+  }
+
+  regs.resize((size_t) num_regs * _batch, 0);
+  masks.resize((size_t) num_regs * _batch, 1);
+  for (auto& elem : imms) {
+    std::fill(column(elem.first), column(elem.first) + _batch, elem.second);
+  }
+
+  LOG(EVAL) << "Sub-DFG " << group << ": " << tape.size() << " steps, " << num_regs
+            << " registers";
+}
+
+int Evaluator::NewRegister() { return num_regs++; }
+
+int Evaluator::Lower(dfg::Operand& operand) {
+  if (operand.is_imm()) {
+    int reg = NewRegister();
+    imms.emplace_back(reg, operand.imm);
+    return reg;
+  }
+  CHECK(!operand.edges.empty());
+  // An operand of a whole value reads the register of the value directly.
+  if (operand.edges.size() == 1) {
+    auto& edge = dfg->edges[operand.edges[0]];
+    if (edge.l == 0 && edge.r == 63) {
+      return value_regs[edge.sid][edge.vid];
+    }
+  }
+  Step step;
+  step.begin = slices.size();
+  for (auto eid : operand.edges) {
+    auto& edge = dfg->edges[eid];
+    slices.push_back({value_regs[edge.sid][edge.vid], edge.l, edge.r});
+  }
+  step.end = slices.size();
+  step.dst = NewRegister();
+  tape.push_back(step);
+  return step.dst;
+}
+
+void Evaluator::Run(int n) {
+  CHECK(n >= 0 && n <= _batch) << "The batch holds at most " << _batch << " lanes";
+  for (auto& step : tape) {
+    if (!step.inst) {
+      Gather(step, n);
+    } else if (step.batched) {
+      ExecuteBatched(step, n);
+    } else {
+      Execute(step, n);
+    }
+  }
+}
+
+void Evaluator::Reset() {
+  for (auto& step : tape) {
+    std::fill(step.reg, step.reg + 8, 0);
+  }
+}
+
+void Evaluator::Gather(const Step& step, int n) {
+  uint64_t* dst = column(step.dst);
+  uint8_t* valid = mask(step.dst);
+  std::fill(dst, dst + n, 0);
+  std::fill(valid, valid + n, 1);
+  // The same concatenation as the operand buffers, where the first edge is the lowest bits.
+  for (int j = step.end - 1; j >= step.begin; --j) {
+    auto& slice = slices[j];
+    int bitwidth = slice.r - slice.l + 1;
+    uint64_t full = ~0ull >> (64 - bitwidth);
+    const uint64_t* src = column(slice.reg);
+    const uint8_t* src_valid = mask(slice.reg);
+    for (int k = 0; k < n; ++k) {
+      uint64_t shifted = bitwidth == 64 ? 0 : dst[k] << bitwidth;
+      dst[k] = shifted | ((src[k] >> slice.l) & full);
+      valid[k] &= src_valid[k];
+    }
+  }
+}
+
+void Evaluator::ExecuteBatched(Step& step, int n) {
+  auto* inst = step.inst;
+  const uint64_t* ops[4];
+  uint64_t* dst = column(step.dst);
+  uint8_t* valid = mask(step.dst);
+  std::fill(valid, valid + n, 1);
+  for (int i = 0; i < step.arity; ++i) {
+    ops[i] = column(step.ops[i]);
+    const uint8_t* op_valid = mask(step.ops[i]);
+    for (int k = 0; k < n; ++k) {
+      valid[k] &= op_valid[k];
+    }
+  }
+  // The invalid lanes are computed as well, and then masked out.
+  dsa::execute64_batch(inst->inst(), ops, step.arity, dst, n, step.reg);
+
+  bool has_ctrl = inst->self_predicate.bits() != 0;
+  for (int i = 0; i < step.arity; ++i) {
+    has_ctrl |= step.ctrl[i];
+  }
+  if (!has_ctrl) {
+    return;
+  }
+  for (int k = 0; k < n; ++k) {
+    if (!valid[k]) continue;
+    bool discard = false, reset = false, pred = true;
+    for (int i = 0; i < step.arity; ++i) {
+      if (step.ctrl[i]) {
+        inst->predicate.test(ops[i][k], back_array, discard, pred, reset);
+      }
+    }
+    if (pred) {
+      inst->self_predicate.test(dst[k], back_array, discard, pred, reset);
+    }
+    valid[k] = pred && !discard;
+  }
+}
+
+void Evaluator::Execute(Step& step, int n) {
+  auto* inst = step.inst;
+  const uint64_t* ops[4];
+  const uint8_t* op_valid[4];
+  for (int i = 0; i < step.arity; ++i) {
+    ops[i] = column(step.ops[i]);
+    op_valid[i] = mask(step.ops[i]);
+  }
+  uint64_t* dst[4];
+  uint8_t* valid[4];
+  for (int j = 0; j < step.num_values; ++j) {
+    dst[j] = column(step.dst + j);
+    valid[j] = mask(step.dst + j);
+  }
+
+  // The lanes go in the stream order, so that the states flow from one lane to the next.
+  // Each lane follows SSDfgInst::forward.
+  for (int k = 0; k < n; ++k) {
+    bool invalid = false, discard = false, reset = false, pred = true;
+    for (int i = 0; i < step.arity; ++i) {
+      if (!op_valid[i][k]) {
+        invalid = true;
+      } else if (step.ctrl[i]) {
+        inst->predicate.test(ops[i][k], back_array, discard, pred, reset);
+      }
+    }
+    invalid |= !pred;
+
+    uint64_t outputs[4] = {0, 0, 0, 0};
+    if (!invalid) {
+      bool back[4] = {false, false, false, false};
+
+#define EXECUTE(bw)                                                                 \
+  case bw: {                                                                        \
+    uint##bw##_t input[4], res[4] = {0, 0, 0, 0};                                   \
+    for (int i = 0; i < step.arity; ++i) {                                          \
+      input[i] = ops[i][k];                                                         \
+    }                                                                               \
+    res[0] = dsa::execute##bw(inst->inst(), input, step.arity, res,                 \
+                              (uint##bw##_t*) step.reg, discard, back);             \
+    for (int j = 0; j < step.num_values; ++j) {                                     \
+      outputs[j] = res[j];                                                          \
+    }                                                                               \
+    break;                                                                          \
+  }
+
+      switch (inst->bitwidth()) {
+        EXECUTE(64)
+        EXECUTE(32)
+        EXECUTE(16)
+        EXECUTE(8)
+        default: CHECK(false) << "Weird bitwidth: " << inst->bitwidth();
+      }
+
+#undef EXECUTE
+
+      for (int i = 0; i < step.arity; ++i) {
+        CHECK(!back[i]) << inst->name() << " holds its operand " << i
+                        << ", which cannot be evaluated in a straight line";
+      }
+      inst->self_predicate.test(outputs[0], back_array, discard, pred, reset);
+    }
+    if (reset) {
+      std::fill(step.reg, step.reg + 8, 0);
+    }
+    invalid |= discard;
+
+    for (int j = 0; j < step.num_values; ++j) {
+      dst[j][k] = outputs[j];
+      valid[j][k] = !invalid;
+    }
+  }
+}
+
+}  // namespace simulation
+}  // namespace dsa
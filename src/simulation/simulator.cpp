@@ -1,7 +1,423 @@
-#include "dsa/simulation/data.h"
+#include "dsa/simulation/simulator.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "dsa/debug.h"
+#include "dsa/dfg/ssdfg.h"
+#include "dsa/mapper/schedule.h"
 
 namespace dsa {
-namespace runtime {
+namespace simulation {
+
+namespace {
+
+/*! \brief The entries of the operand buffer at the consumer end of each channel. */
+const int kOperandBuffer = 2;
+
+uint64_t Execute(SSDfgInst* inst, std::vector<uint64_t>& inputs, std::vector<uint64_t>& outputs,
+                 uint64_t* reg, bool& discard, std::vector<bool>& back_array) {
+  int n = inputs.size();
+  CHECK(n <= 4 && outputs.size() <= 4);
+
+  // The operands and results are narrowed into stack buffers, so that firing an
+  // instruction allocates nothing.
+#define EXECUTE(bw)                                                                     \
+  case bw: {                                                                            \
+    uint##bw##_t input[4], res[4] = {0, 0, 0, 0};                                       \
+    bool back[4] = {false, false, false, false};                                        \
+    for (int i = 0; i < n; ++i) {                                                       \
+      input[i] = inputs[i];                                                             \
+      back[i] = back_array[i];                                                          \
+    }                                                                                   \
+    uint64_t output = dsa::execute##bw(inst->inst(), input, n, res,                     \
+                                       (uint##bw##_t*) reg, discard, back);             \
+    res[0] = output;                                                                    \
+    for (int i = 0; i < n; ++i) {                                                       \
+      back_array[i] = back[i];                                                          \
+    }                                                                                   \
+    for (int i = 0, m = outputs.size(); i < m; ++i) {                                   \
+      outputs[i] = res[i];                                                              \
+    }                                                                                   \
+    return output;                                                                      \
+  }
+
+  switch (inst->bitwidth()) {
+    EXECUTE(64)
+    EXECUTE(32)
+    EXECUTE(16)
+    EXECUTE(8)
+  }
+
+#undef EXECUTE
+
+  CHECK(false) << "Weird bitwidth: " << inst->bitwidth();
+  throw;
+}
+
+}  // namespace
+
+const char* StallName(Stall s) {
+  static const char* names[] = {"operand", "backpressure", "throughput", "sharing"};
+  return names[(int) s];
+}
+
+void Stats::Dump(std::ostream& os) const {
+  os << "Simulated Cycles: " << cycles << std::endl;
+  for (int i = 0, n = issued.size(); i < n; ++i) {
+    os << "Group " << i << ": " << issued[i] << " insts issued, " << produced[i]
+       << " vectors produced, IPC: " << ipc(i) << ", stalls:";
+    for (int j = 0; j < (int) Stall::Total; ++j) {
+      os << " " << StallName((Stall) j) << "=" << stalls[i][j];
+    }
+    os << std::endl;
+  }
+}
+
+void Simulator::Channel::push(const Data& d) {
+  CHECK(!full());
+  buffer[(head + size++) % buffer.size()] = d;
+}
+
+void Simulator::Channel::pop() {
+  CHECK(size);
+  head = (head + 1) % buffer.size();
+  --size;
+}
+
+Simulator::Simulator(Schedule* sched) : sched(sched), dfg(sched->ssdfg()) {
+  int n = dfg->nodes.size();
+  states.resize(n);
+  fu_free.assign(sched->ssModel()->subModel()->node_list().size(), 0);
+  _stats.issued.assign(dfg->num_groups(), 0);
+  _stats.produced.assign(dfg->num_groups(), 0);
+  _stats.stalls.assign(dfg->num_groups(), std::vector<int64_t>((int) Stall::Total, 0));
+
+  for (int i = 0; i < n; ++i) {
+    auto* node = dfg->nodes[i];
+    CHECK(node->id() == i);
+    auto& st = states[i];
+    auto* hw = sched->locationOf(node);
+    CHECK(hw) << node->name() << " is not mapped!";
+    st.hw = hw->id();
+    st.operands.resize(node->ops().size());
+    for (int j = 0, m = node->ops().size(); j < m; ++j) {
+      st.operands[j] = node->ops()[j].edges;
+    }
+    st.values.resize(node->values.size());
+    for (int j = 0, m = node->values.size(); j < m; ++j) {
+      st.values[j] = node->values[j].uses;
+    }
+    if (node->type() == SSDfgNode::V_INST) {
+      st.reg.assign(8, 0);
+    }
+  }
+
+  channels.resize(dfg->edges.size());
+  for (auto& edge : dfg->edges) {
+    auto& ch = channels[edge.id];
+    // The delay FIFOs on the route bound the extra latency can be inserted.
+    int delay = std::min(sched->edge_delay(&edge), sched->max_edge_delay(&edge));
+    ch.latency = sched->links_of(&edge).size() + delay;
+    ch.l = edge.l;
+    ch.r = edge.r;
+    ch.producer = edge.sid;
+    ch.consumer = edge.uid;
+    // Enough to keep the producer pipeline, the route, and the delay FIFO busy.
+    int capacity = edge.def()->lat_of_inst() + ch.latency + kOperandBuffer;
+    ch.buffer.assign(capacity, Data(0, 0, false));
+  }
+
+  // An instruction is free-running if all its operands are, and the input ports are not.
+  // The cycles which do not go through an input port stay free-running.
+  for (auto& inst : dfg->type_filter<SSDfgInst>()) {
+    states[inst.id()].free_running = true;
+  }
+  for (bool changed = true; changed;) {
+    changed = false;
+    for (auto& inst : dfg->type_filter<SSDfgInst>()) {
+      auto& st = states[inst.id()];
+      for (auto& operand : st.operands) {
+        for (auto cid : operand) {
+          if (st.free_running && !states[channels[cid].producer].free_running) {
+            st.free_running = false;
+            changed = true;
+          }
+        }
+      }
+    }
+  }
+  for (auto& ch : channels) {
+    ch.live = !states[ch.producer].free_running;
+  }
+
+  // Instructions with only immediate operands have no upstream to wake them up.
+  for (auto& inst : dfg->type_filter<SSDfgInst>()) {
+    Wake(0, inst.id());
+  }
+}
+
+void Simulator::Push(SSDfgVecInput* port, const std::vector<uint64_t>& data, bool valid) {
+  CHECK(data.size() == port->values.size())
+    << port->name() << " expects " << port->values.size() << " words";
+  auto& st = states[port->id()];
+  st.queue.emplace_back(data, std::vector<bool>(data.size(), valid));
+  Wake(st.last_eval == now ? now + 1 : now, port->id());
+  // The free-running nodes stopped when the previous data was consumed.
+  if (!pending++) {
+    for (int i = 0, n = states.size(); i < n; ++i) {
+      if (states[i].free_running) {
+        Wake(states[i].last_eval == now ? now + 1 : now, i);
+      }
+    }
+  }
+}
+
+bool Simulator::Pop(SSDfgVecOutput* port, std::vector<uint64_t>& data,
+                    std::vector<bool>& valid) {
+  auto& queue = states[port->id()].queue;
+  if (queue.empty()) {
+    return false;
+  }
+  data = std::move(queue.front().first);
+  valid = std::move(queue.front().second);
+  queue.pop_front();
+  return true;
+}
+
+uint64_t Simulator::Run(uint64_t max_cycles) {
+  while (!events.empty() && events.top().first < max_cycles) {
+    auto event = events.top();
+    events.pop();
+    now = event.first;
+    auto& st = states[event.second];
+    if (st.last_eval == now) {
+      continue;
+    }
+    st.last_eval = now;
+    Evaluate(event.second);
+    _stats.cycles = now;
+  }
+  return now;
+}
 
+void Simulator::Wake(uint64_t cycle, int nid) {
+  events.emplace(cycle, nid);
 }
-}
\ No newline at end of file
+
+void Simulator::Stalled(int nid, Stall s) {
+  LOG(SIM) << now << ": " << dfg->nodes[nid]->name() << " stalled by " << StallName(s);
+  ++_stats.stalls[dfg->nodes[nid]->group_id()][(int) s];
+}
+
+void Simulator::Evaluate(int nid) {
+  switch (dfg->nodes[nid]->type()) {
+    case SSDfgNode::V_INST: FireInst(nid); break;
+    case SSDfgNode::V_INPUT: FireInput(nid); break;
+    case SSDfgNode::V_OUTPUT: FireOutput(nid); break;
+    default: CHECK(false) << "Unknown node type!";
+  }
+}
+
+bool Simulator::OperandsReady(int nid) {
+  for (auto& operand : states[nid].operands) {
+    for (auto cid : operand) {
+      auto& ch = channels[cid];
+      // An empty channel wakes up the consumer when a token is pushed.
+      if (!ch.size) {
+        return false;
+      }
+      if (ch.front().available_at > now) {
+        Wake(ch.front().available_at, nid);
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool Simulator::ValuesWritable(int nid, int begin, int end) {
+  auto& st = states[nid];
+  for (int i = begin; i < end; ++i) {
+    for (auto cid : st.values[i]) {
+      // A full channel wakes up the producer when a token is popped.
+      if (channels[cid].full()) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+uint64_t Simulator::Poll(int nid, int i, bool& valid) {
+  auto& operand = states[nid].operands[i];
+  uint64_t res = 0;
+  valid = true;
+  for (int j = operand.size() - 1; j >= 0; --j) {
+    auto& ch = channels[operand[j]];
+    int bitwidth = ch.r - ch.l + 1;
+    uint64_t full = ~0ull >> (64 - bitwidth);
+    uint64_t shifted = bitwidth == 64 ? 0 : res << bitwidth;
+    res = shifted | ((ch.front().value >> ch.l) & full);
+    valid &= ch.front().valid;
+  }
+  return res;
+}
+
+void Simulator::Consume(int nid, int i) {
+  for (auto cid : states[nid].operands[i]) {
+    auto& ch = channels[cid];
+    ch.pop();
+    pending -= ch.live;
+    Wake(now + 1, ch.producer);
+  }
+}
+
+void Simulator::Produce(int nid, int i, uint64_t value, bool valid, int lat) {
+  for (auto cid : states[nid].values[i]) {
+    auto& ch = channels[cid];
+    uint64_t available_at = now + std::max(1, lat + ch.latency);
+    ch.push(Data(available_at, value, valid));
+    pending += ch.live;
+    Wake(available_at, ch.consumer);
+  }
+}
+
+bool Simulator::FireInst(int nid) {
+  auto* inst = static_cast<SSDfgInst*>(dfg->nodes[nid]);
+  auto& st = states[nid];
+
+  // Nothing is left for its results to be combined with.
+  if (st.free_running && !pending) {
+    return false;
+  }
+
+  uint64_t thr = inst_thr(inst->inst());
+  if (st.fired && now - st.last_fire < thr) {
+    Stalled(nid, Stall::Throughput);
+    Wake(st.last_fire + thr, nid);
+    return false;
+  }
+  if (!OperandsReady(nid)) {
+    Stalled(nid, Stall::Operand);
+    return false;
+  }
+  if (!ValuesWritable(nid, 0, st.values.size())) {
+    Stalled(nid, Stall::Backpressure);
+    return false;
+  }
+  // The instructions mapped to a temporal FU share its single issue slot.
+  if (inst->is_temporal() && fu_free[st.hw] > now) {
+    Stalled(nid, Stall::Sharing);
+    Wake(fu_free[st.hw], nid);
+    return false;
+  }
+
+  int n = st.operands.size();
+  CHECK(n <= 3);
+  back_array.assign(n, false);
+  inputs.assign(n, 0);
+  outputs.assign(st.values.size(), 0);
+
+  bool invalid = false, discard = false, reset = false, pred = true;
+  for (int i = 0; i < n; ++i) {
+    auto& operand = inst->ops()[i];
+    if (operand.is_imm()) {
+      inputs[i] = operand.imm;
+      continue;
+    }
+    bool valid;
+    inputs[i] = Poll(nid, i, valid);
+    if (!valid) {
+      invalid = true;
+    } else if (operand.type != dsa::dfg::OperandType::data) {
+      inst->predicate.test(inputs[i], back_array, discard, pred, reset);
+    }
+  }
+  invalid |= !pred;
+
+  if (!invalid) {
+    ++_stats.issued[inst->group_id()];
+    uint64_t output = Execute(inst, inputs, outputs, &st.reg[0], discard, back_array);
+    inst->self_predicate.test(output, back_array, discard, pred, reset);
+  }
+  if (reset) {
+    std::fill(st.reg.begin(), st.reg.end(), 0);
+  }
+
+  for (int i = 0; i < n; ++i) {
+    if (!back_array[i] && !inst->ops()[i].is_imm()) {
+      Consume(nid, i);
+    }
+  }
+
+  invalid |= discard;
+  if (!invalid || !discard_invalid) {
+    for (int i = 0, m = st.values.size(); i < m; ++i) {
+      Produce(nid, i, outputs[i], !invalid, inst->lat_of_inst());
+    }
+  }
+
+  LOG(SIM) << now << ": " << inst->name() << " fired" << (invalid ? " invalid" : "");
+
+  st.fired = true;
+  st.last_fire = now;
+  if (inst->is_temporal()) {
+    fu_free[st.hw] = now + 1;
+  }
+  // Try again, in case more operands are already waiting.
+  Wake(now + thr, nid);
+  return true;
+}
+
+bool Simulator::FireInput(int nid) {
+  auto& st = states[nid];
+  if (st.queue.empty()) {
+    return false;
+  }
+  auto& data = st.queue.front();
+  int n = st.values.size();
+  // A temporal port issues one value per cycle.
+  int begin = dfg->nodes[nid]->is_temporal() ? st.current : 0;
+  int end = dfg->nodes[nid]->is_temporal() ? st.current + 1 : n;
+  if (!ValuesWritable(nid, begin, end)) {
+    Stalled(nid, Stall::Backpressure);
+    return false;
+  }
+  for (int i = begin; i < end; ++i) {
+    Produce(nid, i, data.first[i], data.second[i], 0);
+  }
+  st.current = end % n;
+  if (st.current == 0) {
+    st.queue.pop_front();
+    --pending;
+  }
+  if (!st.queue.empty()) {
+    Wake(now + 1, nid);
+  }
+  return true;
+}
+
+bool Simulator::FireOutput(int nid) {
+  auto& st = states[nid];
+  if (!OperandsReady(nid)) {
+    return false;
+  }
+  int n = st.operands.size();
+  std::vector<uint64_t> data(n);
+  std::vector<bool> valid(n);
+  for (int i = 0; i < n; ++i) {
+    bool v;
+    data[i] = Poll(nid, i, v);
+    valid[i] = v;
+    Consume(nid, i);
+  }
+  // The host drains the output ports, so they never backpressure.
+  st.queue.emplace_back(std::move(data), std::move(valid));
+  ++_stats.produced[dfg->nodes[nid]->group_id()];
+  Wake(now + 1, nid);
+  return true;
+}
+
+}  // namespace simulation
+}  // namespace dsa
@@ -1,39 +1,43 @@
 #pragma once
 
-#include <map>
-#include <tuple>
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
 
 #include "dsa/dfg/ssdfg.h"
 
 namespace cm {
 
-inline int ColorOf(dsa::dfg::Value *val, bool reset = false) {
+/*!
+ * \brief The color of a value in the visualization. The base color of a node is hashed
+ *        from its id, so that a dump neither draws from the random numbers of the search
+ *        nor shares a table with the other threads, and the colors are stable across dumps.
+ */
+inline int ColorOf(dsa::dfg::Value *val) {
   SSDfgNode* node = val->node();
   if (static_cast<int>(node->ops().size()) == 1 &&
       node->ops()[0].edges.size() == 1) {
     auto res = val->parent->edges[node->ops()[0].edges[0]].val();
     return ColorOf(res);
   }
-  static std::map<SSDfgNode*, std::tuple<int, int, int>> colorMap;
-  if (colorMap.count(node) == 0 || reset) {
-    int x = 0, y = 0, z = 0;
-    float lum = 0;
-    while (lum < 0.36f || lum > 0.95f) {  // prevent dark colors
-      //  || abs(x-y) + abs(y-z) + abs(z-x) < 100
-      x = rand() % 256;
-      y = rand() % 256;
-      z = rand() % 256;
-      lum = sqrt(x * x * 0.241f + y * y * 0.691f + z * z * 0.068f) / 255.0f;
-      // lum = (x*0.299f+y*0.587f+z*0.114f)/255.0f;
-    }
-    colorMap[node] = {x, y, z};
+  uint64_t state = node->id();
+  int x = 0, y = 0, z = 0;
+  float lum = 0;
+  while (lum < 0.36f || lum > 0.95f) {  // prevent dark colors
+    // splitmix64
+    uint64_t h = (state += 0x9e3779b97f4a7c15ull);
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ull;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+    h ^= h >> 31;
+    x = h & 255;
+    y = (h >> 8) & 255;
+    z = (h >> 16) & 255;
+    lum = sqrt(x * x * 0.241f + y * y * 0.691f + z * z * 0.068f) / 255.0f;
   }
-  auto rgb = colorMap[node];
-  int r = std::max(std::get<0>(rgb) - val->index * 15, 0);
-  int g = std::max(std::get<1>(rgb) - val->index * 10, 0);
-  int b = std::max(std::get<2>(rgb) - val->index * 20, 0);
+  int r = std::max(x - val->index * 15, 0);
+  int g = std::max(y - val->index * 10, 0);
+  int b = std::max(z - val->index * 20, 0);
   return r | (g << 8) | (b << 16);
 }
 
-}
\ No newline at end of file
+}
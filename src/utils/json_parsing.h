@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdio>
+#include <mutex>
+#include <string>
+
+#include "dsa/debug.h"
+#include "json.lex.h"
+#include "json.tab.h"
+
+namespace dsa {
+namespace json_parsing {
+
+/*!
+ * \brief Parse a JSON file into a tree. The scanner and the parser of the json-parser
+ *        module keep their states in globals, so the parses are serialized by a lock,
+ *        while the interpretation of the tree is free to run in parallel.
+ * \param filename The file to parse.
+ * \return The root of the tree, which the caller deletes.
+ */
+inline json::BaseNode* Parse(const std::string& filename) {
+  static std::mutex lock;
+  FILE* fjson = fopen(filename.c_str(), "r");
+  CHECK(fjson) << "Cannot open " << filename;
+  struct params p;
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    JSONrestart(fjson);
+    JSONparse(&p);
+  }
+  fclose(fjson);
+  return p.data;
+}
+
+}  // namespace json_parsing
+}  // namespace dsa
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <string>
+
+#include "dsa/debug.h"
+
+namespace dsa {
+namespace mapped_file {
+
+/*! \brief Where a table is in a binary file, and how many entries it has. */
+struct Section {
+  uint64_t offset, size;
+};
+
+/*! \brief A read-only memory mapping of a whole file, for the binary formats. */
+struct MappedFile {
+  const char* data{nullptr};
+  size_t size{0};
+
+  MappedFile(const std::string& filename) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    CHECK(fd != -1) << "Could Not Open: " << filename;
+    struct stat st;
+    CHECK(fstat(fd, &st) == 0) << "Could Not Stat: " << filename;
+    size = st.st_size;
+    CHECK(size) << filename << " is empty";
+    void* ptr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    CHECK(ptr != MAP_FAILED) << "Could Not Map: " << filename;
+    data = static_cast<const char*>(ptr);
+  }
+
+  ~MappedFile() { munmap(const_cast<char*>(data), size); }
+
+  /*! \brief The entries of a table, which should be 8-byte aligned and within the file. */
+  template <typename T>
+  const T* Table(const Section& section) const {
+    CHECK(section.offset % 8 == 0 && section.offset + section.size * sizeof(T) <= size)
+        << "Corrupted binary section";
+    return reinterpret_cast<const T*>(data + section.offset);
+  }
+};
+
+}  // namespace mapped_file
+}  // namespace dsa
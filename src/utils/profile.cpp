@@ -0,0 +1,152 @@
+#include "dsa/profile.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace dsa {
+namespace profile {
+
+thread_local AllocCounter allocations;
+
+bool enabled = false;
+
+namespace {
+
+/*!
+ * \brief The samples are bucketed by their leading 3 bits after the most significant one,
+ *        so a percentile is within 1/8 of the exact one.
+ */
+const int kSubBits = 3;
+const int kBuckets = (64 - kSubBits + 1) << kSubBits;
+
+int Bucket(uint64_t x) {
+  if (x < (1 << kSubBits)) return x;
+  int msb = 63 - __builtin_clzll(x);
+  int sub = (x >> (msb - kSubBits)) & ((1 << kSubBits) - 1);
+  return ((msb - kSubBits + 1) << kSubBits) + sub;
+}
+
+/*! \brief The middle of the values in a bucket. */
+double BucketValue(int bucket) {
+  if (bucket < (1 << kSubBits)) return bucket;
+  int shift = (bucket >> kSubBits) - 1;
+  uint64_t lo = (uint64_t) ((1 << kSubBits) + (bucket & ((1 << kSubBits) - 1))) << shift;
+  return lo + ((uint64_t) 1 << shift) / 2.0;
+}
+
+struct PhaseStats {
+  uint64_t count{0}, cycles{0}, allocs{0}, bytes{0};
+  uint64_t hist[kBuckets]{};
+};
+
+struct ThreadStats {
+  PhaseStats phases[(int) Phase::NumPhases];
+};
+
+const char* kPhaseNames[] = {
+    "route",        "routing_cost", "obj",           "get_overprov",
+    "fixLatency",   "IterLatency",  "CandidateSpot", "scheduleHere",
+    "unmap_some",   "sched copy",   "Graphviz dump", "JSON dump",
+};
+
+std::mutex lock;
+/*! \brief The counters of each thread. They outlive the threads to be reported. */
+std::vector<ThreadStats*> threads;
+/*! \brief When the profiler is enabled, to convert the cycles to time. */
+uint64_t start_cycles;
+std::chrono::steady_clock::time_point start_time;
+
+ThreadStats* Local() {
+  thread_local ThreadStats* local = nullptr;
+  if (!local) {
+    local = new ThreadStats();
+    std::lock_guard<std::mutex> guard(lock);
+    threads.push_back(local);
+  }
+  return local;
+}
+
+}  // namespace
+
+void Enable() {
+#ifndef DSA_PROFILE
+  std::cerr << "The profiler is not built in. Configure with -DDSA_PROFILE=ON." << std::endl;
+#else
+  start_cycles = Cycles();
+  start_time = std::chrono::steady_clock::now();
+  enabled = true;
+#endif
+}
+
+void Record(Phase phase, uint64_t cycles, uint64_t allocs, uint64_t bytes) {
+  auto& stats = Local()->phases[(int) phase];
+  ++stats.count;
+  stats.cycles += cycles;
+  stats.allocs += allocs;
+  stats.bytes += bytes;
+  ++stats.hist[Bucket(cycles)];
+}
+
+void Report(std::ostream& os) {
+  if (!enabled) return;
+  double nsec = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start_time)
+                    .count();
+  double ns_per_cycle = nsec / std::max<uint64_t>(Cycles() - start_cycles, 1);
+
+  std::vector<PhaseStats> total((int) Phase::NumPhases);
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    for (auto* thread : threads) {
+      for (int i = 0; i < (int) Phase::NumPhases; ++i) {
+        auto& src = thread->phases[i];
+        total[i].count += src.count;
+        total[i].cycles += src.cycles;
+        total[i].allocs += src.allocs;
+        total[i].bytes += src.bytes;
+        for (int j = 0; j < kBuckets; ++j) {
+          total[i].hist[j] += src.hist[j];
+        }
+      }
+    }
+  }
+
+  char buffer[256];
+  snprintf(buffer, sizeof buffer, "%-18s %10s %12s %10s %10s %12s %12s\n", "phase", "calls",
+           "total(ms)", "mean(us)", "p99(us)", "allocs", "alloc(KB)");
+  os << buffer;
+  for (int i = 0; i < (int) Phase::NumPhases; ++i) {
+    auto& stats = total[i];
+    if (!stats.count) continue;
+    uint64_t rank = (stats.count * 99 + 99) / 100, seen = 0;
+    int p99 = 0;
+    for (; p99 < kBuckets && (seen += stats.hist[p99]) < rank; ++p99)
+      ;
+    double total_ns = stats.cycles * ns_per_cycle;
+    snprintf(buffer, sizeof buffer, "%-18s %10lu %12.3f %10.3f %10.3f %12lu %12.1f\n",
+             kPhaseNames[i], stats.count, total_ns / 1e6, total_ns / stats.count / 1e3,
+             BucketValue(p99) * ns_per_cycle / 1e3, stats.allocs, stats.bytes / 1024.0);
+    os << buffer;
+  }
+}
+
+}  // namespace profile
+}  // namespace dsa
+
+#ifdef DSA_PROFILE
+// Count the allocations of each thread for the scopes. The array forms forward to these.
+void* operator new(size_t size) {
+  ++dsa::profile::allocations.count;
+  dsa::profile::allocations.bytes += size;
+  if (void* res = malloc(size ? size : 1)) return res;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { free(ptr); }
+
+void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+#endif
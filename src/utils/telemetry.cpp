@@ -0,0 +1,76 @@
+#include "dsa/telemetry.h"
+
+#include "dsa/debug.h"
+
+namespace dsa {
+namespace telemetry {
+
+Record& Record::Field(const char* key, const char* x) {
+  std::string value = "\"";
+  for (; *x; ++x) {
+    if (*x == '"' || *x == '\\') {
+      value += '\\';
+      value += *x;
+    } else if ((unsigned char)*x < 0x20) {
+      char buf[8];
+      value.append(buf, snprintf(buf, sizeof buf, "\\u%04x", *x));
+    } else {
+      value += *x;
+    }
+  }
+  value += '"';
+  return Raw(key, value.data(), value.size());
+}
+
+Record& Record::Raw(const char* key, const char* value, int n) {
+  if (line.size() > 1) line += ',';
+  line += '"';
+  line += key;
+  line += "\":";
+  line.append(value, n);
+  return *this;
+}
+
+Sink::Sink(const std::string& filename) : _file(fopen(filename.c_str(), "w")) {
+  CHECK(_file) << "Cannot open " << filename;
+  _writer = std::thread(&Sink::Writer, this);
+}
+
+Sink::~Sink() {
+  {
+    std::lock_guard<std::mutex> guard(_lock);
+    _closing = true;
+  }
+  _cv.notify_one();
+  _writer.join();
+  fclose(_file);
+}
+
+void Sink::Emit(Record& record) {
+  record.line += "}\n";
+  {
+    std::lock_guard<std::mutex> guard(_lock);
+    _pending.push_back(std::move(record.line));
+  }
+  _cv.notify_one();
+}
+
+void Sink::Writer() {
+  std::vector<std::string> batch;
+  std::unique_lock<std::mutex> guard(_lock);
+  while (true) {
+    _cv.wait(guard, [this]() { return _closing || !_pending.empty(); });
+    if (_pending.empty()) break;
+    batch.swap(_pending);
+    guard.unlock();
+    for (auto& line : batch) {
+      fwrite(line.data(), 1, line.size(), _file);
+    }
+    fflush(_file);
+    batch.clear();
+    guard.lock();
+  }
+}
+
+}  // namespace telemetry
+}  // namespace dsa